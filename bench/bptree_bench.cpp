@@ -0,0 +1,1211 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <unordered_set>
+#include <vector>
+#include "bptree/basic_bptree.hpp"
+#include "bptree/concurrent_bptree.hpp"
+#include "bptree/heap_file.hpp"
+#include "bptree/mapped_table.hpp"
+#include "bptree/sharded_bptree.hpp"
+#include "bptree/simd_search.hpp"
+#include "bptree/versioned_bptree.hpp"
+#include "bptree/wal.hpp"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+/*
+	Microbenchmark of BasicBPTree<int64_t, uint64_t>: every workload runs once per tree size and
+	fanout (maxIntChildLimit = maxLeafNodeLimit = fanout) and reports throughput plus per-operation
+	latency percentiles as one JSON document, on stdout or in --out. Nothing outside the standard
+	library is needed.
+
+	Every operation is timed on its own with steady_clock, so the latencies include one clock read
+	(timer_overhead_ns in the output). ops_per_sec is taken over the whole timed loop.
+
+	wal_commit is about the write-ahead log rather than the tree: it runs once per --writers count,
+	each writer thread committing demo-sized insert records to a log in --wal-dir, and reports the
+	#of group commit syncs next to the latencies.
+
+	concurrent_read (95% lookups, 5% upserts) and concurrent_mixed (50% lookups, 25% inserts, 25%
+	deletes over twice the key range, so the tree keeps its size) run once per --threads count on
+	ConcurrentBPTree and, as the baseline, on a BasicBPTree behind one mutex ("tree" in the output).
+	The ops are split evenly over the threads, ops_per_sec is the aggregate.
+
+	Every single-threaded tree workload also reports the node memory it left behind (bytes_reserved
+	by the node slabs, bytes_in_use by live nodes, leaf_nodes), node_visits (zero when built with
+	BPTREE_TRACING=0) and destroy_ns, the time the tree took to free it. insert_seq shows the
+	append fast path there: full leaves and about one node visit per insert.
+
+	multi_get and multi_insert are lookup and insert_random handed to the tree --batch keys per
+	call, so one op is one batch (items_per_op keys) and keys/s is ops_per_sec * items_per_op.
+
+	url_insert and url_lookup use std::string keys, synthetic URLs (Zipfian hosts, paths from a
+	fixed vocabulary, some query ids), on a tree with the default std::less ("compressed":
+	prefix-compressed leaves, truncated separators) and on one whose comparator opts out of both
+	("plain"). heap_bytes is what the tree holds on the heap, strings included (glibc only).
+
+	value_lookup runs once per --value-sizes entry: size keys with values of that many bytes, kept
+	in a MappedTable ("mapped": the lookup returns a view into the mapped file) and, as the
+	baseline, the way the demo keeps its tuples ("heap": RecordIds into a HeapFile with its default
+	64 pool frames, the lookup copies the record out). Both files go to --wal-dir.
+
+	snapshot_open saves a tree of size keys to --wal-dir and times open() on the image (open_ns)
+	against rebuilding the tree through insert (rebuild_ns) and bulkLoad (bulk_load_ns); the ops
+	are lookups on the freshly opened tree, so they include first touches of the mapping.
+
+	versioned_scan times writer ops that each move one key (remove a present key, insert an
+	absent one) while a second thread scans the whole tree over and over, on VersionedBPTree
+	snapshots ("versioned") and on ConcurrentBPTree ("olc"). The tree only ever holds size or
+	size-1 keys; inconsistent_scans counted any other #of keys, so saw no single point in time.
+
+	filter_lookup is lookup with 70% of the probes for absent keys, on a tree without ("plain")
+	and with ("bloom") a --bloom-bits Bloom filter; it reports the filter's bytes, the lookups it
+	answered alone and its false positives per million absent keys (false_positive_ppm).
+
+	range_delete empties a tree of size keys oldest first, --range-keys keys at a time: one
+	removeRange per window ("range") against one removeKey per key of it ("per_key"). One op is
+	one window, keys/s is ops_per_sec * items_per_op.
+
+	delete_deferred is delete on a tree with UnderflowPolicy::STRICT ("strict") and on one with
+	DEFERRED ("deferred"), each op a removeKey. Both report the node bytes_in_use right after the
+	deletes and the borrows and merges they ran; the deferred tree then runs compact() untimed by
+	the ops and reports compact_ns, the leaves it joined and bytes_in_use_compacted.
+
+	parallel_build builds a tree of size keys from pairs in random order, one op per build of
+	items_per_op keys, with parallelBulkLoad once per --threads count ("parallel"). Next to the
+	first count it runs the single-threaded baselines: std::sort then bulkLoad ("sort_bulk_load")
+	and one insert per pair ("insert").
+
+	sharded_insert runs once per --threads count: every thread inserts odd keys, absent from the
+	even keys the trees start with, into a ShardedBPTree of one shard per thread whose fences
+	bulkLoad set ("sharded"), into one that starts with every key in its first shard and is
+	evened out by rebalance() before the timed ops ("sharded_rebalanced", rebalance_ns and
+	moved_keys), and into ConcurrentBPTree ("olc") and one mutex around a BasicBPTree
+	("global_mutex").
+*/
+
+using namespace std;
+using namespace bptree;
+
+namespace {
+
+using Key = int64_t;
+using Value = uint64_t;
+using Tree = BasicBPTree<Key, Value>;
+using SharedTree = ConcurrentBPTree<Key, Value>;
+using VersionedTree = VersionedBPTree<Key, Value>;
+
+// Same order as std::less, but not std::less, so the tree leaves the string keys uncompressed
+struct PlainStringLess {
+    bool operator()(const string& a, const string& b) const { return a < b; }
+};
+using UrlTree = BasicBPTree<string, Value>;
+using PlainUrlTree = BasicBPTree<string, Value, PlainStringLess>;
+using Clock = chrono::steady_clock;
+
+#ifndef BPTREE_BENCH_BUILD_TYPE
+#define BPTREE_BENCH_BUILD_TYPE ""
+#endif
+
+const char* const WORKLOADS[] = {"lookup",          "insert_seq",       "insert_random", "insert_zipf",
+                                 "delete",          "scan",             "wal_commit",    "concurrent_read",
+                                 "concurrent_mixed", "multi_get",       "multi_insert",  "url_insert",
+                                 "url_lookup",      "value_lookup",     "snapshot_open", "versioned_scan",
+                                 "filter_lookup",   "range_delete",     "delete_deferred",
+                                 "parallel_build",  "sharded_insert"};
+
+struct Options {
+    vector<size_t> sizes{10000, 100000, 1000000};
+    vector<int> fanouts{16, 64, 256};
+    vector<string> workloads{begin(WORKLOADS), end(WORKLOADS)};
+    size_t ops = 1000000;     // lookups per run; scans run ops/10, deletes at most half the tree
+    size_t scanLength = 100;  // keys per scan
+    double fillFactor = 0.7;  // leaves of the prebuilt trees, about what random inserts leave behind
+    double zipfTheta = 0.99;
+    uint64_t seed = 42;
+    vector<int> writers{1, 8, 64};  // wal_commit threads
+    size_t walOps = 6400;           // commits per wal_commit run, split over the writers
+    vector<int> threads{1, 2, 4, 8, 16, 32, 64};  // concurrent_*, parallel_build and sharded_insert threads
+    size_t batch = 256;                           // keys per multi_get / multi_insert call
+    vector<size_t> valueSizes{100, 4096};         // value_lookup value bytes
+    int bloomBits = 10;                           // filter_lookup bits per key
+    size_t rangeKeys = 10000;                     // keys per range_delete window
+    string walDir = ".";
+    string out;
+};
+
+struct Result {
+    string workload;
+    size_t size;
+    int fanout;   // 0 for runs without a tree
+    int writers;  // threads of a wal_commit run
+    int threads;  // threads of a concurrent_*, parallel_build or sharded_insert run
+    string tree;  // which tree a concurrent_* run used
+    size_t ops;
+    size_t itemsPerOp;
+    double seconds;
+    double meanNs;
+    uint64_t p50, p99, p999, maxNs;
+    vector<pair<string, uint64_t>> counters;  // workload specific extras
+};
+
+uint64_t sink = 0;  // results of the timed calls end up here, so none of them is optimized away
+
+class Zipfian {
+    /*
+		Ranks 0..n-1 with P(rank) ~ 1/(rank+1)^theta, drawn in O(1) after an O(n) setup (Gray et al.,
+		"Quickly Generating Billion-Record Synthetic Databases", as used by YCSB). Rank 0 is hottest;
+		callers scatter ranks over the key space themselves.
+	*/
+   public:
+    Zipfian(size_t n, double theta) : n(n), theta(theta) {
+        double zeta2 = zeta(2);
+        zetan = zeta(n);
+        alpha = 1.0 / (1.0 - theta);
+        eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+
+    template <typename Rng>
+    size_t operator()(Rng& rng) {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + pow(0.5, theta)) return 1;
+        return min(n - 1, static_cast<size_t>(n * pow(eta * u - eta + 1.0, alpha)));
+    }
+
+   private:
+    size_t n;
+    double theta, zetan, alpha, eta;
+
+    double zeta(size_t count) const {
+        double sum = 0;
+        for (size_t i = 1; i <= count; i++) sum += 1.0 / pow(static_cast<double>(i), theta);
+        return sum;
+    }
+};
+
+uint64_t elapsedNs(Clock::time_point start) {
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+void summarize(vector<uint64_t>& latency, Result& result) {
+    const size_t ops = latency.size();
+    result.ops = ops;
+    if (ops == 0) return;
+    result.meanNs = accumulate(latency.begin(), latency.end(), 0.0) / ops;
+    sort(latency.begin(), latency.end());
+    auto rank = [&](double q) { return latency[min(ops - 1, static_cast<size_t>(q * ops))]; };
+    result.p50 = rank(0.50);
+    result.p99 = rank(0.99);
+    result.p999 = rank(0.999);
+    result.maxNs = latency.back();
+}
+
+template <typename Op>
+Result measure(const string& workload, size_t size, int fanout, size_t ops, size_t itemsPerOp, Op&& op) {
+    vector<uint64_t> latency(ops);
+    Clock::time_point begin = Clock::now();
+    for (size_t i = 0; i < ops; i++) {
+        Clock::time_point start = Clock::now();
+        op(i);
+        latency[i] = elapsedNs(start);
+    }
+
+    Result result{workload, size, fanout, 0, 0, "", ops, itemsPerOp, 0, 0, 0, 0, 0, 0, {}};
+    result.seconds = chrono::duration<double>(Clock::now() - begin).count();
+    summarize(latency, result);
+    return result;
+}
+
+// The tree holds the even keys 0, 2, .., 2(size-1), so odd keys are known misses
+void fill(Tree& tree, size_t size, double fillFactor) {
+    vector<pair<Key, Value>> pairs(size);
+    for (size_t i = 0; i < size; i++) pairs[i] = {static_cast<Key>(2 * i), i};
+    tree.bulkLoad(pairs.begin(), pairs.end(), fillFactor);
+}
+
+vector<Key> shuffledKeys(size_t size, mt19937_64& rng) {
+    vector<Key> keys(size);
+    for (size_t i = 0; i < size; i++) keys[i] = static_cast<Key>(2 * i);
+    shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+Result runOn(Tree& tree, const string& workload, size_t size, int fanout, const Options& options, mt19937_64& rng) {
+    if (workload == "lookup") {
+        fill(tree, size, options.fillFactor);
+        vector<Key> probes(options.ops);
+        for (Key& key : probes) key = static_cast<Key>(2 * (rng() % size));
+        return measure(workload, size, fanout, probes.size(), 1, [&](size_t i) { sink += *tree.find(probes[i]); });
+    }
+    if (workload == "insert_seq" || workload == "insert_random") {
+        vector<Key> keys = shuffledKeys(size, rng);
+        if (workload == "insert_seq") sort(keys.begin(), keys.end());
+        return measure(workload, size, fanout, keys.size(), 1, [&](size_t i) { tree.insert(keys[i], i); });
+    }
+    if (workload == "insert_zipf") {
+        // size upserts into an empty tree: hot keys turn into updates, the tail grows the tree
+        vector<Key> scatter = shuffledKeys(size, rng);
+        Zipfian zipf(size, options.zipfTheta);
+        vector<Key> keys(size);
+        for (Key& key : keys) key = scatter[zipf(rng)];
+        return measure(workload, size, fanout, keys.size(), 1, [&](size_t i) {
+            Value* value = tree.find(keys[i]);
+            if (value != NULL)
+                *value = i;
+            else
+                tree.insert(keys[i], i);
+        });
+    }
+    if (workload == "delete") {
+        // Half of the keys in random order, the tree stays between size/2 and size
+        fill(tree, size, options.fillFactor);
+        vector<Key> keys = shuffledKeys(size, rng);
+        keys.resize(min(options.ops, size / 2));
+        return measure(workload, size, fanout, keys.size(), 1, [&](size_t i) { sink += tree.removeKey(keys[i]); });
+    }
+    if (workload == "scan") {
+        fill(tree, size, options.fillFactor);
+        const size_t span = min(options.scanLength, size);
+        vector<Key> starts(max<size_t>(options.ops / 10, 1));
+        for (Key& key : starts) key = static_cast<Key>(2 * (rng() % (size - span + 1)));
+        return measure(workload, size, fanout, starts.size(), span, [&](size_t i) {
+            for (auto entry : tree.scan(starts[i], starts[i] + static_cast<Key>(2 * span))) sink += entry.second;
+        });
+    }
+    if (workload == "multi_get") {
+        // The probes of lookup, options.batch of them per call
+        fill(tree, size, options.fillFactor);
+        vector<Key> probes(options.ops);
+        for (Key& key : probes) key = static_cast<Key>(2 * (rng() % size));
+        const size_t batch = options.batch;
+        vector<Value*> found(batch);
+        return measure(workload, size, fanout, (probes.size() + batch - 1) / batch, batch, [&](size_t i) {
+            const size_t first = i * batch, n = min(batch, probes.size() - first);
+            tree.multiGet(probes.data() + first, n, found.data());
+            for (size_t j = 0; j < n; j++) sink += *found[j];
+        });
+    }
+    if (workload == "multi_insert") {
+        // The keys of insert_random, options.batch of them per call
+        vector<Key> keys = shuffledKeys(size, rng);
+        vector<pair<Key, Value>> pairs(size);
+        for (size_t i = 0; i < size; i++) pairs[i] = {keys[i], i};
+        const size_t batch = options.batch;
+        return measure(workload, size, fanout, (pairs.size() + batch - 1) / batch, batch, [&](size_t i) {
+            const size_t first = i * batch;
+            tree.multiInsert(pairs.data() + first, min(batch, pairs.size() - first));
+        });
+    }
+    throw invalid_argument("unknown workload: " + workload);
+}
+
+Result run(const string& workload, size_t size, int fanout, const Options& options, mt19937_64& rng) {
+    // Node memory as the run leaves it, and what handing all of it back costs
+    auto tree = make_unique<Tree>(fanout, fanout);
+    Result result = runOn(*tree, workload, size, fanout, options, rng);
+    MemoryStats memory = tree->getMemoryStats();
+    const uint64_t nodeVisits = tree->getStats().nodeVisits;
+    Clock::time_point start = Clock::now();
+    tree.reset();
+    result.counters = {{"bytes_reserved", memory.bytesReserved},
+                       {"bytes_in_use", memory.bytesInUse},
+                       {"leaf_nodes", memory.leafNodes},
+                       {"node_visits", nodeVisits},
+                       {"destroy_ns", elapsedNs(start)}};
+    return result;
+}
+
+Result runWal(int writers, const Options& options) {
+    /*
+		Every writer commits its share of insert records of the demo's shape (an int key and a short
+		tuple) and waits for each to be durable, so commits only get cheaper by sharing syncs.
+	*/
+    const string path = options.walDir + "/bptree_bench.wal";
+    std::remove(path.c_str());
+    const size_t perWriter = max<size_t>(options.walOps / writers, 1);
+    vector<vector<uint64_t>> latency(writers, vector<uint64_t>(perWriter));
+
+    Result result{"wal_commit", 0, 0, writers, 0, "", 0, 1, 0, 0, 0, 0, 0, 0, {}};
+    {
+        WriteAheadLog log(path);
+        vector<thread> threads;
+        Clock::time_point begin = Clock::now();
+        for (int w = 0; w < writers; w++)
+            threads.emplace_back([&, w] {
+                string payload = "\0\0\0\0Student_0000 21 88";
+                for (size_t i = 0; i < perWriter; i++) {
+                    int key = static_cast<int>(w * perWriter + i);
+                    payload.replace(0, sizeof(key), reinterpret_cast<const char*>(&key), sizeof(key));
+                    Clock::time_point start = Clock::now();
+                    log.commit(1, payload);
+                    latency[w][i] = elapsedNs(start);
+                }
+            });
+        for (thread& t : threads) t.join();
+        result.seconds = chrono::duration<double>(Clock::now() - begin).count();
+
+        LogStats stats = log.getStats();
+        result.counters = {{"syncs", stats.syncs}, {"bytes", stats.bytes}};
+    }
+    std::remove(path.c_str());
+
+    vector<uint64_t> all;
+    for (const vector<uint64_t>& mine : latency) all.insert(all.end(), mine.begin(), mine.end());
+    summarize(all, result);
+    return result;
+}
+
+// What one thread of a concurrent_* run does next
+struct MixedOp {
+    enum Kind : uint8_t { FIND, INSERT, REMOVE } kind;
+    Key key;
+};
+
+// The same operations on one tree shared by every thread, either latch-free readers or one big lock
+struct OlcAccess {
+    SharedTree& tree;
+    uint64_t apply(const MixedOp& op) {
+        switch (op.kind) {
+            case MixedOp::FIND: return tree.find(op.key).value_or(0);
+            case MixedOp::INSERT: return tree.insert(op.key, static_cast<Value>(op.key));
+            case MixedOp::REMOVE: return tree.removeKey(op.key);
+        }
+        return 0;
+    }
+};
+
+struct MutexAccess {
+    Tree& tree;
+    mutex& lock;
+    uint64_t apply(const MixedOp& op) {
+        lock_guard<mutex> guard(lock);
+        switch (op.kind) {
+            case MixedOp::FIND: {
+                Value* value = tree.find(op.key);
+                return value != NULL ? *value : 0;
+            }
+            case MixedOp::INSERT: {
+                Value* value = tree.find(op.key);
+                if (value != NULL) {
+                    *value = static_cast<Value>(op.key);
+                    return 0;
+                }
+                tree.insert(op.key, static_cast<Value>(op.key));
+                return 1;
+            }
+            case MixedOp::REMOVE: return tree.removeKey(op.key);
+        }
+        return 0;
+    }
+};
+
+struct ShardedAccess {
+    ShardedBPTree<Key, Value>& tree;
+    uint64_t apply(const MixedOp& op) {
+        switch (op.kind) {
+            case MixedOp::FIND: return tree.find(op.key).value_or(0);
+            case MixedOp::INSERT: return tree.insert(op.key, static_cast<Value>(op.key));
+            case MixedOp::REMOVE: return tree.removeKey(op.key);
+        }
+        return 0;
+    }
+};
+
+template <typename Access>
+Result runThreaded(const string& workload, size_t size, int fanout, const string& treeName, int threads, Access access,
+                   const Options& options, mt19937_64& rng) {
+    /*
+		Keys are drawn from [0, 2*size) so lookups hit about half the time. The ops of every thread
+		are drawn up front, the timed loop only runs them.
+	*/
+    const bool readHeavy = workload == "concurrent_read";
+    const size_t perThread = max<size_t>(options.ops / threads, 1);
+    vector<vector<MixedOp>> ops(threads, vector<MixedOp>(perThread));
+    for (vector<MixedOp>& mine : ops)
+        for (MixedOp& op : mine) {
+            unsigned roll = static_cast<unsigned>(rng() % 100);
+            op.key = static_cast<Key>(rng() % (2 * size));
+            if (workload == "sharded_insert")
+                op = {MixedOp::INSERT, static_cast<Key>(op.key | 1)};
+            else if (readHeavy)
+                op.kind = roll < 95 ? MixedOp::FIND : MixedOp::INSERT;
+            else
+                op.kind = roll < 50 ? MixedOp::FIND : roll < 75 ? MixedOp::INSERT : MixedOp::REMOVE;
+        }
+
+    vector<vector<uint64_t>> latency(threads, vector<uint64_t>(perThread));
+    vector<uint64_t> sums(threads);
+    vector<thread> workers;
+    Clock::time_point begin = Clock::now();
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&, t, access]() mutable {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < perThread; i++) {
+                Clock::time_point start = Clock::now();
+                sum += access.apply(ops[t][i]);
+                latency[t][i] = elapsedNs(start);
+            }
+            sums[t] = sum;
+        });
+    for (thread& worker : workers) worker.join();
+
+    Result result{workload, size, fanout, 0, threads, treeName, 0, 1, 0, 0, 0, 0, 0, 0, {}};
+    result.seconds = chrono::duration<double>(Clock::now() - begin).count();
+    for (uint64_t sum : sums) sink += sum;
+    vector<uint64_t> all;
+    for (const vector<uint64_t>& mine : latency) all.insert(all.end(), mine.begin(), mine.end());
+    summarize(all, result);
+    return result;
+}
+
+vector<Result> runConcurrent(const string& workload, size_t size, int fanout, int threads, const Options& options) {
+    // Both trees get the even keys in the same random order, so they start out equally full
+    vector<Result> results;
+    {
+        mt19937_64 rng(options.seed);
+        SharedTree tree(fanout, fanout);
+        for (Key key : shuffledKeys(size, rng)) tree.insert(key, static_cast<Value>(key));
+        results.push_back(runThreaded(workload, size, fanout, "olc", threads, OlcAccess{tree}, options, rng));
+        ConcurrentStats stats = tree.getStats();
+        results.back().counters = {{"restarts", stats.restarts},
+                                   {"retired_nodes", stats.retiredNodes},
+                                   {"retired_backlog", stats.retiredBacklog}};
+    }
+    {
+        mt19937_64 rng(options.seed);
+        Tree tree(fanout, fanout);
+        mutex lock;
+        for (Key key : shuffledKeys(size, rng)) tree.insert(key, static_cast<Value>(key));
+        results.push_back(runThreaded(workload, size, fanout, "global_mutex", threads, MutexAccess{tree, lock}, options, rng));
+    }
+    return results;
+}
+
+vector<Result> runSharded(const string& workload, size_t size, int fanout, int threads, const Options& options) {
+    // Every tree starts with fill()'s even keys, the insert ops are the same odd keys for all of them
+    vector<Result> results;
+    vector<pair<Key, Value>> pairs(size);
+    for (size_t i = 0; i < size; i++) pairs[i] = {static_cast<Key>(2 * i), static_cast<Value>(2 * i)};
+    {
+        mt19937_64 rng(options.seed);
+        ShardedBPTree<Key, Value> tree(vector<Key>(threads - 1), fanout, fanout);
+        tree.bulkLoad(pairs.begin(), pairs.end(), options.fillFactor);
+        results.push_back(runThreaded(workload, size, fanout, "sharded", threads, ShardedAccess{tree}, options, rng));
+        results.back().counters = {{"reroutes", tree.getStats().reroutes}};
+    }
+    {
+        // Every fence past the last key: the first shard holds them all until rebalance() spreads them out
+        mt19937_64 rng(options.seed);
+        ShardedBPTree<Key, Value> tree(vector<Key>(threads - 1, static_cast<Key>(2 * size)), fanout, fanout);
+        for (const pair<Key, Value>& entry : pairs) tree.insert(entry.first, entry.second);
+        Clock::time_point start = Clock::now();
+        for (int round = 0; round < 4 * threads && tree.rebalance() > 0; round++) {
+        }
+        const uint64_t rebalanceNs = elapsedNs(start);
+        results.push_back(runThreaded(workload, size, fanout, "sharded_rebalanced", threads, ShardedAccess{tree}, options, rng));
+        results.back().counters = {{"rebalance_ns", rebalanceNs}, {"moved_keys", tree.getStats().movedKeys}};
+    }
+    {
+        mt19937_64 rng(options.seed);
+        SharedTree tree(fanout, fanout);
+        for (const pair<Key, Value>& entry : pairs) tree.insert(entry.first, entry.second);
+        results.push_back(runThreaded(workload, size, fanout, "olc", threads, OlcAccess{tree}, options, rng));
+    }
+    {
+        mt19937_64 rng(options.seed);
+        Tree tree(fanout, fanout);
+        mutex lock;
+        fill(tree, size, options.fillFactor);
+        results.push_back(runThreaded(workload, size, fanout, "global_mutex", threads, MutexAccess{tree, lock}, options, rng));
+    }
+    return results;
+}
+
+// What the scanner thread of a versioned_scan run saw
+struct ScanTally {
+    uint64_t scans = 0;
+    uint64_t rows = 0;
+    uint64_t inconsistent = 0;  // scans that counted neither size nor size-1 keys
+    uint64_t maxBacklog = 0;    // most retired nodes waiting to be freed at the end of a scan
+    uint64_t checksum = 0;
+};
+
+template <typename MovingTree, typename ScanOnce>
+Result runScanned(const string& workload, size_t size, int fanout, const string& treeName, MovingTree& tree,
+                  ScanOnce&& scanOnce, mt19937_64& rng, const Options& options) {
+    /*
+		The tree holds the even keys. Each op removes a key that is present and then inserts one
+		that is absent, so the tree holds size keys between two ops and size-1 within one; the
+		moves are drawn up front. The scanner runs until the last op is done, on whatever core it
+		gets.
+	*/
+    vector<Key> present = shuffledKeys(size, rng);
+    for (Key key : present) tree.insert(key, static_cast<Value>(key));
+    vector<Key> absent(size);
+    for (size_t i = 0; i < size; i++) absent[i] = static_cast<Key>(2 * i + 1);
+    vector<pair<Key, Key>> moves(options.ops);
+    for (pair<Key, Key>& move : moves) {
+        Key& from = present[rng() % size];
+        Key& to = absent[rng() % size];
+        move = {from, to};
+        swap(from, to);
+    }
+
+    atomic<bool> done{false};
+    ScanTally tally;
+    thread scanner([&]() {
+        while (!done.load(memory_order_relaxed)) scanOnce(tally);
+    });
+    Result result = measure(workload, size, fanout, moves.size(), 2, [&](size_t i) {
+        sink += tree.removeKey(moves[i].first);
+        sink += tree.insert(moves[i].second, static_cast<Value>(moves[i].second));
+    });
+    done = true;
+    scanner.join();
+
+    result.tree = treeName;
+    sink += tally.checksum;
+    result.counters = {{"scans", tally.scans},
+                       {"scanned_rows", tally.rows},
+                       {"inconsistent_scans", tally.inconsistent},
+                       {"max_retired_backlog", tally.maxBacklog}};
+    return result;
+}
+
+vector<Result> runVersioned(const string& workload, size_t size, int fanout, const Options& options) {
+    // The same moves on both trees, scanned from a snapshot and latch-free
+    vector<Result> results;
+    const Key hi = static_cast<Key>(2 * size);
+    {
+        mt19937_64 rng(options.seed);
+        VersionedTree tree(fanout, fanout);
+        auto scanOnce = [&tree, size, hi](ScanTally& tally) {
+            VersionedTree::Snapshot snapshot = tree.snapshot();
+            uint64_t rows = 0;
+            snapshot.scan(0, hi, [&](const Key&, const Value& value) {
+                rows++;
+                tally.checksum += value;
+            });
+            tally.maxBacklog = max(tally.maxBacklog, tree.getStats().retiredBacklog);
+            tally.scans++;
+            tally.rows += rows;
+            tally.inconsistent += rows != size && rows + 1 != size;
+        };
+        results.push_back(runScanned(workload, size, fanout, "versioned", tree, scanOnce, rng, options));
+        results.back().counters.push_back({"copied_nodes", tree.getStats().copiedNodes});
+    }
+    {
+        mt19937_64 rng(options.seed);
+        SharedTree tree(fanout, fanout);
+        auto scanOnce = [&tree, size, hi](ScanTally& tally) {
+            uint64_t rows = 0;
+            tree.scan(0, hi, [&](const Key&, const Value& value) {
+                rows++;
+                tally.checksum += value;
+            });
+            tally.maxBacklog = max(tally.maxBacklog, tree.getStats().retiredBacklog);
+            tally.scans++;
+            tally.rows += rows;
+            tally.inconsistent += rows != size && rows + 1 != size;
+        };
+        results.push_back(runScanned(workload, size, fanout, "olc", tree, scanOnce, rng, options));
+    }
+    return results;
+}
+
+vector<string> urlKeys(size_t size, mt19937_64& rng) {
+    /*
+		size distinct URLs: https://www.<word>.<tld>/ with the host drawn Zipfian from 2000, then
+		one to four path segments out of 500 words, a third of them with a numeric query id. Long
+		shared prefixes and short distinguishing tails, like a crawl frontier or an access log.
+	*/
+    const char* const syllables[] = {"ka", "lo", "mi", "ne", "ru", "sa", "to", "vi", "xe", "zu", "bra", "cho", "dre", "fli"};
+    const char* const tlds[] = {"com", "org", "net", "de", "io"};
+    auto word = [&](size_t parts) {
+        string w;
+        for (size_t i = 0; i < parts; i++) w += syllables[rng() % std::size(syllables)];
+        return w;
+    };
+    vector<string> hosts(2000), vocabulary(500);
+    for (string& host : hosts) host = "https://www." + word(2 + rng() % 3) + "." + tlds[rng() % std::size(tlds)] + "/";
+    for (string& segment : vocabulary) segment = word(1 + rng() % 4);
+
+    Zipfian hostRank(hosts.size(), 0.99);
+    unordered_set<string> seen;
+    vector<string> urls;
+    urls.reserve(size);
+    while (urls.size() < size) {
+        string url = hosts[hostRank(rng)];
+        for (size_t segments = 1 + rng() % 4; segments > 0; segments--) url += vocabulary[rng() % vocabulary.size()] + "/";
+        if (rng() % 3 == 0) url += "?id=" + to_string(rng() % 1000000);
+        if (seen.insert(url).second) urls.push_back(move(url));
+    }
+    return urls;
+}
+
+size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+template <typename StringTree>
+Result runUrl(const string& workload, size_t size, int fanout, const string& treeName, const vector<string>& urls,
+              const Options& options, mt19937_64& rng) {
+    const size_t heapBefore = heapInUse();
+    auto tree = make_unique<StringTree>(fanout, fanout);
+    Result result;
+    if (workload == "url_insert") {
+        result = measure(workload, size, fanout, urls.size(), 1, [&](size_t i) { tree->insert(urls[i], i); });
+    } else {
+        for (size_t i = 0; i < urls.size(); i++) tree->insert(urls[i], i);
+        vector<size_t> probes(options.ops);
+        for (size_t& probe : probes) probe = rng() % urls.size();
+        result = measure(workload, size, fanout, probes.size(), 1, [&](size_t i) { sink += *tree->find(urls[probes[i]]); });
+    }
+    result.tree = treeName;
+    MemoryStats memory = tree->getMemoryStats();
+    result.counters = {{"heap_bytes", heapInUse() - heapBefore}, {"node_bytes_in_use", memory.bytesInUse}};
+    return result;
+}
+
+vector<Result> runUrls(const string& workload, size_t size, int fanout, const Options& options) {
+    // Both trees get the same URLs in the same order and look up the same ones
+    vector<Result> results;
+    mt19937_64 rng(options.seed);
+    const vector<string> urls = urlKeys(size, rng);
+    {
+        mt19937_64 probeRng(options.seed);
+        results.push_back(runUrl<UrlTree>(workload, size, fanout, "compressed", urls, options, probeRng));
+    }
+    {
+        mt19937_64 probeRng(options.seed);
+        results.push_back(runUrl<PlainUrlTree>(workload, size, fanout, "plain", urls, options, probeRng));
+    }
+    return results;
+}
+
+vector<Result> runValues(const string& workload, size_t size, int fanout, size_t valueBytes, const Options& options) {
+    // The same values under the same keys in both stores, looked up at the same random keys
+    vector<Result> results;
+    mt19937_64 rng(options.seed);
+    vector<Key> probes(options.ops);
+    for (Key& probe : probes) probe = static_cast<Key>(2 * (rng() % size));
+    auto valueOf = [valueBytes](size_t i) {
+        string value(valueBytes, 'v');
+        value.replace(0, min(valueBytes, sizeof(i)), reinterpret_cast<const char*>(&i), min(valueBytes, sizeof(i)));
+        return value;
+    };
+    // Touches the value at both ends, a lookup that only fetched the pointer would be cheating
+    auto use = [](string_view value) { return value.size() + static_cast<unsigned char>(value.back()); };
+
+    const string path = options.walDir + "/bptree_bench.values";
+    {
+        MappedTable<Key> table(path, fanout, fanout);
+        for (size_t i = 0; i < size; i++) table.put(static_cast<Key>(2 * i), valueOf(i));
+        Result result = measure(workload, size, fanout, probes.size(), 1,
+                                [&](size_t i) { sink += use(*table.lookup(probes[i])); });
+        result.tree = "mapped";
+        result.counters = {{"value_bytes", valueBytes}, {"file_bytes", table.getStore().getDataBytes()}};
+        results.push_back(result);
+    }
+    std::remove(path.c_str());
+    {
+        // The smallest page size that holds one value, as HeapFile records never span pages
+        size_t pageSize = DEFAULT_PAGE_SIZE;
+        while (pageSize - 64 < valueBytes) pageSize *= 2;
+        HeapFile heap(path, 64, EvictionPolicy::CLOCK, pageSize);
+        BasicBPTree<Key, RecordId> index(fanout, fanout);
+        for (size_t i = 0; i < size; i++) index.insert(static_cast<Key>(2 * i), heap.insert(valueOf(i)));
+        heap.getPool().resetStats();
+        Result result = measure(workload, size, fanout, probes.size(), 1,
+                                [&](size_t i) { sink += use(*heap.read(*index.find(probes[i]))); });
+        result.tree = "heap";
+        result.counters = {{"value_bytes", valueBytes},
+                           {"file_bytes", static_cast<uint64_t>(heap.getFile().getPageCount()) * pageSize},
+                           {"pool_misses", heap.getPool().getStats().misses}};
+        results.push_back(result);
+    }
+    std::remove(path.c_str());
+    return results;
+}
+
+Result runSnapshot(const string& workload, size_t size, int fanout, const Options& options, mt19937_64& rng) {
+    const string path = options.walDir + "/bptree_bench.snapshot";
+    vector<Key> keys = shuffledKeys(size, rng);
+
+    Clock::time_point start = Clock::now();
+    auto built = make_unique<Tree>(fanout, fanout);
+    for (size_t i = 0; i < keys.size(); i++) built->insert(keys[i], i);
+    const uint64_t rebuildNs = elapsedNs(start);
+
+    start = Clock::now();
+    Tree loaded(fanout, fanout);
+    fill(loaded, size, options.fillFactor);
+    const uint64_t bulkLoadNs = elapsedNs(start);
+
+    start = Clock::now();
+    built->save(path);
+    const uint64_t saveNs = elapsedNs(start);
+    built.reset();
+
+    start = Clock::now();
+    Tree opened;
+    opened.open(path);
+    const uint64_t openNs = elapsedNs(start);
+    Result result = measure(workload, size, fanout, options.ops, 1, [&](size_t i) { sink += *opened.find(keys[i % size]); });
+    result.counters = {{"open_ns", openNs},
+                       {"rebuild_ns", rebuildNs},
+                       {"bulk_load_ns", bulkLoadNs},
+                       {"save_ns", saveNs},
+                       {"image_bytes", opened.getMemoryStats().bytesMapped}};
+    std::remove(path.c_str());
+    return result;
+}
+
+vector<Result> runFiltered(const string& workload, size_t size, int fanout, const Options& options) {
+    // The same probes on both trees: 30% present (even) keys, 70% absent (odd) ones
+    vector<Result> results;
+    for (bool bloom : {false, true}) {
+        mt19937_64 rng(options.seed);
+        Tree tree(fanout, fanout);
+        fill(tree, size, options.fillFactor);
+        if (bloom) tree.enableFilter(options.bloomBits);
+        vector<Key> probes(options.ops);
+        size_t absent = 0;
+        for (Key& key : probes) {
+            bool hit = rng() % 100 < 30;
+            key = static_cast<Key>(2 * (rng() % size) + (hit ? 0 : 1));
+            absent += !hit;
+        }
+        Result result = measure(workload, size, fanout, probes.size(), 1, [&](size_t i) {
+            const Value* value = tree.find(probes[i]);
+            sink += value != NULL ? *value : 1;
+        });
+        result.tree = bloom ? "bloom" : "plain";
+        FilterStats filter = tree.getFilterStats();
+        result.counters = {{"filter_bytes", filter.bytes},
+                           {"rejected", filter.rejected},
+                           {"false_positive_ppm", absent > 0 ? filter.falsePositives * 1000000 / absent : 0}};
+        results.push_back(result);
+    }
+    return results;
+}
+
+vector<Result> runRangeDeletes(const string& workload, size_t size, int fanout, const Options& options) {
+    // Window i is the keys [2 * i * span, 2 * (i + 1) * span) of fill()'s even keys
+    vector<Result> results;
+    const size_t span = min(options.rangeKeys, size);
+    const size_t windows = (size + span - 1) / span;
+    for (bool ranged : {true, false}) {
+        Tree tree(fanout, fanout);
+        fill(tree, size, options.fillFactor);
+        Result result = measure(workload, size, fanout, windows, span, [&](size_t i) {
+            const Key lo = static_cast<Key>(2 * i * span), hi = static_cast<Key>(2 * (i + 1) * span);
+            if (ranged) {
+                sink += tree.removeRange(lo, hi);
+                return;
+            }
+            for (Key key = lo; key < hi; key += 2) sink += tree.removeKey(key);
+        });
+        result.tree = ranged ? "range" : "per_key";
+        results.push_back(result);
+    }
+    return results;
+}
+
+vector<Result> runDeferred(const string& workload, size_t size, int fanout, const Options& options) {
+    // The deletes of delete: half of the keys in random order, the same ones on both trees
+    vector<Result> results;
+    for (UnderflowPolicy policy : {UnderflowPolicy::STRICT, UnderflowPolicy::DEFERRED}) {
+        mt19937_64 rng(options.seed);
+        Tree tree(fanout, fanout);
+        fill(tree, size, options.fillFactor);
+        tree.setUnderflowPolicy(policy);
+        tree.resetStats();
+        vector<Key> keys = shuffledKeys(size, rng);
+        keys.resize(min(options.ops, size / 2));
+        Result result = measure(workload, size, fanout, keys.size(), 1, [&](size_t i) { sink += tree.removeKey(keys[i]); });
+        result.tree = policy == UnderflowPolicy::STRICT ? "strict" : "deferred";
+        const TreeStats& stats = tree.getStats();
+        result.counters = {{"bytes_in_use", tree.getMemoryStats().bytesInUse},
+                           {"borrows", stats.leafBorrows + stats.internalBorrows},
+                           {"merges", stats.leafMerges + stats.internalMerges}};
+        if (policy == UnderflowPolicy::DEFERRED) {
+            Clock::time_point start = Clock::now();
+            size_t joined = tree.compact();
+            result.counters.push_back({"compact_ns", elapsedNs(start)});
+            result.counters.push_back({"compacted_leaves", joined});
+            result.counters.push_back({"bytes_in_use_compacted", tree.getMemoryStats().bytesInUse});
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+vector<Result> runParallelBuild(const string& workload, size_t size, int fanout, int threads, const Options& options) {
+    // The tree of fill(), from the same shuffled pairs every time; the copy each build sorts is made untimed
+    mt19937_64 rng(options.seed);
+    vector<Key> keys = shuffledKeys(size, rng);
+    vector<pair<Key, Value>> shuffled(size);
+    for (size_t i = 0; i < size; i++) shuffled[i] = {keys[i], static_cast<Value>(keys[i] / 2)};
+
+    vector<Result> results;
+    vector<string> trees{"parallel"};
+    if (threads == options.threads.front()) trees.insert(trees.end(), {"sort_bulk_load", "insert"});
+    for (const string& name : trees) {
+        vector<pair<Key, Value>> pairs = shuffled;
+        Tree tree(fanout, fanout);
+        Result result = measure(workload, size, fanout, 1, size, [&](size_t) {
+            if (name == "parallel") {
+                tree.parallelBulkLoad(pairs.begin(), pairs.end(), options.fillFactor, static_cast<unsigned>(threads));
+            } else if (name == "sort_bulk_load") {
+                sort(pairs.begin(), pairs.end());
+                tree.bulkLoad(pairs.begin(), pairs.end(), options.fillFactor);
+            } else {
+                for (const pair<Key, Value>& entry : pairs) tree.insert(entry.first, entry.second);
+            }
+        });
+        result.tree = name;
+        result.threads = name == "parallel" ? threads : 1;
+        result.counters = {{"bytes_in_use", tree.getMemoryStats().bytesInUse}};
+        results.push_back(result);
+    }
+    return results;
+}
+
+double timerOverheadNs() {
+    const int reads = 1000000;
+    Clock::time_point begin = Clock::now();
+    for (int i = 0; i < reads; i++) sink += static_cast<uint64_t>(Clock::now().time_since_epoch().count() & 1);
+    return chrono::duration<double, nano>(Clock::now() - begin).count() / reads;
+}
+
+const char* isaName(simd::Isa isa) {
+    switch (isa) {
+        case simd::Isa::AVX2: return "avx2";
+        case simd::Isa::SSE42: return "sse4.2";
+        case simd::Isa::SCALAR: return "scalar";
+    }
+    return "scalar";
+}
+
+void writeJson(ostream& out, const Options& options, double overheadNs, const vector<Result>& results) {
+    auto list = [&](const auto& values) {
+        string joined;
+        for (const auto& value : values) joined += (joined.empty() ? "" : ", ") + to_string(value);
+        return "[" + joined + "]";
+    };
+
+    out << "{\n";
+    out << "  \"benchmark\": \"bptree_bench\",\n";
+    out << "  \"config\": {\n";
+    out << "    \"build_type\": \"" << BPTREE_BENCH_BUILD_TYPE << "\",\n";
+    out << "    \"tracing\": " << (TRACING ? "true" : "false") << ",\n";
+    out << "    \"simd\": \"" << isaName(simd::activeIsa()) << "\",\n";
+    out << "    \"key_bytes\": " << sizeof(Key) << ",\n";
+    out << "    \"value_bytes\": " << sizeof(Value) << ",\n";
+    out << "    \"sizes\": " << list(options.sizes) << ",\n";
+    out << "    \"fanouts\": " << list(options.fanouts) << ",\n";
+    out << "    \"ops\": " << options.ops << ",\n";
+    out << "    \"scan_length\": " << options.scanLength << ",\n";
+    out << "    \"fill_factor\": " << options.fillFactor << ",\n";
+    out << "    \"zipf_theta\": " << options.zipfTheta << ",\n";
+    out << "    \"seed\": " << options.seed << ",\n";
+    out << "    \"writers\": " << list(options.writers) << ",\n";
+    out << "    \"wal_ops\": " << options.walOps << ",\n";
+    out << "    \"wal_dir\": \"" << options.walDir << "\",\n";
+    out << "    \"threads\": " << list(options.threads) << ",\n";
+    out << "    \"batch\": " << options.batch << ",\n";
+    out << "    \"value_sizes\": " << list(options.valueSizes) << ",\n";
+    out << "    \"bloom_bits\": " << options.bloomBits << ",\n";
+    out << "    \"range_keys\": " << options.rangeKeys << ",\n";
+    out << "    \"hardware_threads\": " << thread::hardware_concurrency() << ",\n";
+    out << "    \"timer_overhead_ns\": " << overheadNs << "\n";
+    out << "  },\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        double opsPerSec = r.seconds > 0 ? r.ops / r.seconds : 0;
+        out << "    {\"workload\": \"" << r.workload << "\"";
+        if (r.fanout > 0) out << ", \"size\": " << r.size << ", \"fanout\": " << r.fanout;
+        if (r.writers > 0) out << ", \"writers\": " << r.writers;
+        if (r.threads > 0) out << ", \"threads\": " << r.threads;
+        if (!r.tree.empty()) out << ", \"tree\": \"" << r.tree << "\"";
+        out << ", \"ops\": " << r.ops << ", \"items_per_op\": " << r.itemsPerOp << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_sec\": " << static_cast<uint64_t>(opsPerSec);
+        for (const auto& counter : r.counters) out << ", \"" << counter.first << "\": " << counter.second;
+        out << ", \"latency_ns\": {\"mean\": " << static_cast<uint64_t>(r.meanNs) << ", \"p50\": " << r.p50
+            << ", \"p99\": " << r.p99 << ", \"p999\": " << r.p999 << ", \"max\": " << r.maxNs << "}}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n";
+    out << "  \"checksum\": " << sink << "\n";
+    out << "}\n";
+}
+
+template <typename T>
+vector<T> parseList(const string& text) {
+    vector<T> values;
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ',')) {
+        if (item.empty()) continue;
+        T value;
+        stringstream(item) >> value;
+        values.push_back(value);
+    }
+    return values;
+}
+
+void usage() {
+    cerr << "usage: bptree_bench [--sizes N,..] [--fanouts F,..] [--workloads W,..] [--ops N]\n"
+            "                    [--scan-length N] [--fill F] [--zipf-theta T] [--seed S] [--out FILE]\n"
+            "                    [--writers N,..] [--wal-ops N] [--wal-dir DIR] [--threads N,..] [--batch N]\n"
+            "                    [--value-sizes N,..] [--bloom-bits N] [--range-keys N] [--quick]\n"
+            "workloads: lookup insert_seq insert_random insert_zipf delete scan wal_commit\n"
+            "           concurrent_read concurrent_mixed multi_get multi_insert url_insert url_lookup\n"
+            "           value_lookup snapshot_open versioned_scan filter_lookup range_delete\n"
+            "           delete_deferred parallel_build sharded_insert\n";
+}
+
+bool parse(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--quick") {
+            options.sizes = {1000, 10000};
+            options.fanouts = {16, 64};
+            options.ops = 20000;
+            options.writers = {1, 8};
+            options.walOps = 640;
+            options.threads = {1, 4};
+            continue;
+        }
+        if (arg == "--help" || i + 1 == argc) return false;
+        string value = argv[++i];
+        if (arg == "--sizes") options.sizes = parseList<size_t>(value);
+        else if (arg == "--fanouts") options.fanouts = parseList<int>(value);
+        else if (arg == "--workloads") options.workloads = parseList<string>(value);
+        else if (arg == "--ops") options.ops = stoull(value);
+        else if (arg == "--scan-length") options.scanLength = stoull(value);
+        else if (arg == "--fill") options.fillFactor = stod(value);
+        else if (arg == "--zipf-theta") options.zipfTheta = stod(value);
+        else if (arg == "--seed") options.seed = stoull(value);
+        else if (arg == "--writers") options.writers = parseList<int>(value);
+        else if (arg == "--wal-ops") options.walOps = stoull(value);
+        else if (arg == "--wal-dir") options.walDir = value;
+        else if (arg == "--threads") options.threads = parseList<int>(value);
+        else if (arg == "--batch") options.batch = stoull(value);
+        else if (arg == "--value-sizes") options.valueSizes = parseList<size_t>(value);
+        else if (arg == "--bloom-bits") options.bloomBits = stoi(value);
+        else if (arg == "--range-keys") options.rangeKeys = stoull(value);
+        else if (arg == "--out") options.out = value;
+        else return false;
+    }
+
+    for (const string& workload : options.workloads)
+        if (find(begin(WORKLOADS), end(WORKLOADS), workload) == end(WORKLOADS)) {
+            cerr << "unknown workload: " << workload << "\n";
+            return false;
+        }
+    for (int fanout : options.fanouts)
+        if (fanout < 3) {
+            cerr << "fanouts must be at least 3\n";
+            return false;
+        }
+    for (size_t size : options.sizes)
+        if (size < 2) {
+            cerr << "sizes must be at least 2\n";
+            return false;
+        }
+    for (int writers : options.writers)
+        if (writers < 1) {
+            cerr << "writers must be at least 1\n";
+            return false;
+        }
+    for (int threads : options.threads)
+        if (threads < 1) {
+            cerr << "threads must be at least 1\n";
+            return false;
+        }
+    for (size_t valueBytes : options.valueSizes)
+        if (valueBytes < 1) {
+            cerr << "value sizes must be at least 1\n";
+            return false;
+        }
+    return !options.sizes.empty() && !options.fanouts.empty() && options.batch > 0 && options.bloomBits > 0 && options.rangeKeys > 0 && options.zipfTheta > 0 && options.zipfTheta < 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    double overheadNs = timerOverheadNs();
+    vector<Result> results;
+    for (const string& workload : options.workloads) {
+        if (workload == "wal_commit") {
+            for (int writers : options.writers) {
+                results.push_back(runWal(writers, options));
+                const Result& r = results.back();
+                cerr << workload << " writers=" << writers << ": " << static_cast<uint64_t>(r.ops / r.seconds)
+                     << " commits/s, " << r.counters[0].second << " syncs, p99 " << r.p99 << " ns\n";
+            }
+            continue;
+        }
+        if (workload == "concurrent_read" || workload == "concurrent_mixed") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (int threads : options.threads)
+                        for (const Result& r : runConcurrent(workload, size, fanout, threads, options)) {
+                            results.push_back(r);
+                            cerr << workload << " size=" << size << " fanout=" << fanout << " threads=" << threads
+                                 << " " << r.tree << ": " << static_cast<uint64_t>(r.seconds > 0 ? r.ops / r.seconds : 0)
+                                 << " ops/s, p99 " << r.p99 << " ns\n";
+                        }
+            continue;
+        }
+        if (workload == "sharded_insert") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (int threads : options.threads)
+                        for (const Result& r : runSharded(workload, size, fanout, threads, options)) {
+                            results.push_back(r);
+                            cerr << workload << " size=" << size << " fanout=" << fanout << " threads=" << threads
+                                 << " " << r.tree << ": " << static_cast<uint64_t>(r.seconds > 0 ? r.ops / r.seconds : 0)
+                                 << " ops/s, p99 " << r.p99 << " ns\n";
+                        }
+            continue;
+        }
+        if (workload == "parallel_build") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (int threads : options.threads)
+                        for (const Result& r : runParallelBuild(workload, size, fanout, threads, options)) {
+                            results.push_back(r);
+                            cerr << workload << " size=" << size << " fanout=" << fanout << " threads=" << r.threads
+                                 << " " << r.tree << ": "
+                                 << static_cast<uint64_t>(r.seconds > 0 ? r.ops * r.itemsPerOp / r.seconds : 0)
+                                 << " keys/s\n";
+                        }
+            continue;
+        }
+        if (workload == "delete_deferred") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (const Result& r : runDeferred(workload, size, fanout, options)) {
+                        results.push_back(r);
+                        cerr << workload << " size=" << size << " fanout=" << fanout << " " << r.tree << ": "
+                             << static_cast<uint64_t>(r.seconds > 0 ? r.ops / r.seconds : 0) << " ops/s, p99 " << r.p99
+                             << " ns, " << r.counters[0].second << " bytes in use\n";
+                    }
+            continue;
+        }
+        if (workload == "range_delete") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (const Result& r : runRangeDeletes(workload, size, fanout, options)) {
+                        results.push_back(r);
+                        cerr << workload << " size=" << size << " fanout=" << fanout << " " << r.tree << ": "
+                             << static_cast<uint64_t>(r.seconds > 0 ? r.ops * r.itemsPerOp / r.seconds : 0)
+                             << " keys/s, p99 " << r.p99 << " ns per window\n";
+                    }
+            continue;
+        }
+        if (workload == "filter_lookup") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (const Result& r : runFiltered(workload, size, fanout, options)) {
+                        results.push_back(r);
+                        cerr << workload << " size=" << size << " fanout=" << fanout << " " << r.tree << ": "
+                             << static_cast<uint64_t>(r.seconds > 0 ? r.ops / r.seconds : 0) << " ops/s, p99 " << r.p99
+                             << " ns, filter " << r.counters[0].second << " bytes\n";
+                    }
+            continue;
+        }
+        if (workload == "versioned_scan") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (const Result& r : runVersioned(workload, size, fanout, options)) {
+                        results.push_back(r);
+                        cerr << workload << " size=" << size << " fanout=" << fanout << " " << r.tree << ": "
+                             << static_cast<uint64_t>(r.seconds > 0 ? r.ops / r.seconds : 0) << " moves/s, p99 " << r.p99
+                             << " ns, " << r.counters[0].second << " scans, " << r.counters[2].second
+                             << " inconsistent\n";
+                    }
+            continue;
+        }
+        if (workload == "url_insert" || workload == "url_lookup") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (const Result& r : runUrls(workload, size, fanout, options)) {
+                        results.push_back(r);
+                        cerr << workload << " size=" << size << " fanout=" << fanout << " " << r.tree << ": "
+                             << static_cast<uint64_t>(r.seconds > 0 ? r.ops / r.seconds : 0) << " ops/s, p99 " << r.p99
+                             << " ns, heap " << r.counters[0].second << " bytes\n";
+                    }
+            continue;
+        }
+        if (workload == "value_lookup") {
+            for (size_t size : options.sizes)
+                for (int fanout : options.fanouts)
+                    for (size_t valueBytes : options.valueSizes)
+                        for (const Result& r : runValues(workload, size, fanout, valueBytes, options)) {
+                            results.push_back(r);
+                            cerr << workload << " size=" << size << " fanout=" << fanout << " value=" << valueBytes
+                                 << " " << r.tree << ": " << static_cast<uint64_t>(r.seconds > 0 ? r.ops / r.seconds : 0)
+                                 << " ops/s, p99 " << r.p99 << " ns\n";
+                        }
+            continue;
+        }
+        for (size_t size : options.sizes)
+            for (int fanout : options.fanouts) {
+                mt19937_64 rng(options.seed);  // every run sees the same keys whatever ran before
+                results.push_back(workload == "snapshot_open" ? runSnapshot(workload, size, fanout, options, rng)
+                                                              : run(workload, size, fanout, options, rng));
+                const Result& r = results.back();
+                cerr << workload << " size=" << size << " fanout=" << fanout << ": "
+                     << static_cast<uint64_t>(r.seconds > 0 ? r.ops / r.seconds : 0) << " ops/s, p99 " << r.p99
+                     << " ns\n";
+            }
+    }
+
+    if (options.out.empty()) {
+        writeJson(cout, options, overheadNs, results);
+    } else {
+        ofstream out(options.out);
+        writeJson(out, options, overheadNs, results);
+        if (!out) {
+            cerr << "could not write " << options.out << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -4,8 +4,9 @@
  * 
  * This example demonstrates the fundamental operations of the B+ Tree:
  * - Creating a tree with custom parameters
- * - Inserting data with file-based storage
+ * - Inserting tuples into the slotted-page heap file
  * - Searching for keys
+ * - Range queries over the linked leaves
  * - Displaying tree structure
  * - Deleting keys
  */
@@ -43,17 +44,9 @@ int main() {
     // Insert student data
     std::cout << "Inserting student data:\n";
     for (const auto& student : students) {
-        std::string filename = "DBFiles/" + std::to_string(student.id) + ".txt";
-        FILE* file = fopen(filename.c_str(), "w");
-        
-        if (file != nullptr) {
-            fprintf(file, "%s %d %d\n", student.name.c_str(), student.age, student.marks);
-            tree.insert(student.id, file);
-            fclose(file);
-            std::cout << "  Inserted: ID=" << student.id << ", Name=" << student.name << "\n";
-        } else {
-            std::cerr << "  Error: Could not create file for ID " << student.id << "\n";
-        }
+        std::string tuple = student.name + " " + std::to_string(student.age) + " " + std::to_string(student.marks);
+        tree.insertTuple(student.id, tuple);
+        std::cout << "  Inserted: ID=" << student.id << ", Name=" << student.name << "\n";
     }
     
     std::cout << "\n=== Tree Structure (Hierarchical) ===\n";
@@ -71,6 +64,12 @@ int main() {
         tree.search(id);
     }
     
+    // Range query: one descent, then the leaf chain
+    std::cout << "\n=== Range Query [102, 105) ===\n";
+    for (auto entry : tree.scan(102, 105)) {
+        std::cout << "  ID " << entry.first << ": " << tree.getTuples().read(entry.second).value_or("?") << "\n";
+    }
+    
     // Delete a student
     std::cout << "\n=== Delete Operation ===\n";
     int deleteId = 102;
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bptree/bloom_filter.hpp"
+#include "bptree/mapped_file.hpp"
+#include "bptree/node.hpp"
+#include "bptree/node_slab.hpp"
+#include "bptree/simd_search.hpp"
+#include "bptree/trace.hpp"
+
+namespace bptree {
+
+// What removeKey does about a leaf it leaves below half full, see BasicBPTree::setUnderflowPolicy()
+enum class UnderflowPolicy {
+    STRICT,    // borrow or merge right away
+    DEFERRED,  // leave it, even empty, and queue it for compact()
+};
+
+template <typename Key, typename Value, typename Compare = std::less<Key>, int Fanout = DYNAMIC_FANOUT>
+class BasicBPTree {
+    /*
+		::For Root Node :=
+			The root node has, at least two tree pointers
+		::For Internal Nodes:=
+			1. ceil(maxIntChildLimit/2)     <=  #of children <= maxIntChildLimit
+			2. ceil(maxIntChildLimit/2)-1  <=  #of keys     <= maxIntChildLimit -1
+		::For Leaf Nodes :=
+			1. ceil(maxLeafNodeLimit/2)   <=  #of keys     <= maxLeafNodeLimit -1
+		::For the Right Edge:=
+			The nodes on the path to the rightmost leaf may sit below those minimums. Appends split
+			them 100/0 (see insertion.hpp): a rightmost leaf can hold a single key and an internal
+			node on the edge a single separator until more appends fill them. Removals treat them
+			as any underfull node, removeKey borrows for them or merges them, compact() as well.
+
+		::Fanout:=
+			DYNAMIC_FANOUT (the default) reads maxIntChildLimit/maxLeafNodeLimit from the
+			constructor. Any other value fixes both limits at compile time, so every limit check
+			and the intra-node search below become constants the compiler can unroll.
+	*/
+    static_assert(Fanout == DYNAMIC_FANOUT || Fanout >= 3, "a static fanout needs at least 3 children");
+
+   public:
+    using Node = BasicNode<Key, Value, Fanout>;
+
+    /*
+		Ordered cursor over the ptr2next leaf chain: (leaf, slot) plus an optional exclusive upper
+		bound, once the bound (or the last leaf) is reached it compares equal to end(). Nothing is
+		allocated per row; key()/value() and *it hand out references into the leaf (the key of a
+		prefix-compressed leaf is put together in the iterator, valid until it moves).
+		Any insert/removeKey invalidates outstanding iterators.
+	*/
+    template <bool IsConst>
+    class BasicIterator {
+       public:
+        using NodePtr = std::conditional_t<IsConst, const Node*, Node*>;
+        using ValueRef = std::conditional_t<IsConst, const Value&, Value&>;
+
+        BasicIterator() = default;
+        operator BasicIterator<true>() const { return BasicIterator<true>(leaf, idx, bounded, hi, comp); }
+
+        const Key& key() const {
+            if constexpr (Node::PREFIXED) {
+                if (!leaf->prefix().empty()) return whole = leaf->prefix() + leaf->keys()[idx];
+            }
+            return leaf->keys()[idx];
+        }
+        ValueRef value() const { return leaf->dataPtr()[idx]; }
+        std::pair<const Key&, ValueRef> operator*() const { return {key(), value()}; }
+
+        BasicIterator& operator++() {
+            idx++;
+            settle();
+            return *this;
+        }
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const BasicIterator& other) const { return leaf == other.leaf && idx == other.idx; }
+        bool operator!=(const BasicIterator& other) const { return !(*this == other); }
+
+       private:
+        friend class BasicBPTree;
+        template <bool>
+        friend class BasicIterator;
+
+        BasicIterator(NodePtr leaf, int idx, bool bounded, const Key& hi, const Compare* comp)
+            : leaf(leaf), idx(idx), bounded(bounded), hi(hi), comp(comp) {
+            settle();
+        }
+
+        // Step over exhausted leaves, then turn into end() once the bound is reached
+        void settle() {
+            while (leaf != NULL && idx >= leaf->size) {
+                leaf = leaf->next();
+                idx = 0;
+            }
+            if (leaf != NULL && bounded && !(*comp)(key(), hi)) {
+                leaf = NULL;
+                idx = 0;
+            }
+        }
+
+        NodePtr leaf = NULL;
+        int idx = 0;
+        bool bounded = false;
+        Key hi = Key();  //exclusive upper bound, only looked at when bounded
+        const Compare* comp = NULL;
+        mutable std::conditional_t<Node::PREFIXED, Key, bool> whole{};  // key() of a prefix-compressed leaf
+    };
+
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    // [first, last) pair so a scan can be used in a range-for
+    template <typename It>
+    struct Range {
+        It first, last;
+        It begin() const { return first; }
+        It end() const { return last; }
+    };
+
+   protected:
+    int maxIntChildLimit;     //Limiting  #of children for internal Nodes!
+    int maxLeafNodeLimit;     // Limiting #of nodes for leaf Nodes!!!
+    Node* root;               //Pointer to the B+ Tree root
+    Compare comp;             //Strict weak ordering of the keys
+    mutable TreeStats stats;  //Counters, they stay zero when built with BPTREE_TRACING=0
+    std::function<void(TreeEvent, const Key&)> onEvent;  //Optional observer of every structural step
+    NodeSlab leafSlab;        //Blocks of every leaf, one size class
+    NodeSlab internalSlab;    //Blocks of every internal node
+    std::shared_ptr<MappedFile> image;  //Snapshot the tree was opened from, see open()
+    std::unique_ptr<BloomFilter> filter;  //Optional negative-lookup filter, see enableFilter()
+    mutable FilterStats filterStats;      //Its counters, rejected/falsePositives stay zero with BPTREE_TRACING=0
+    UnderflowPolicy underflowPolicy = UnderflowPolicy::STRICT;
+    std::vector<Key> underfullLeaves;     //A key of every leaf DEFERRED left below half, for compact()
+    bool tailUnderfull = false;           //DEFERRED deleted from a rightmost leaf already below half, see compact()
+    Node* tailLeaf = NULL;                //Rightmost leaf as the last insert left it, NULL when unknown
+
+    /*
+		Internal nodes passed on the way down to a leaf, with the child slot taken in each. Splits
+		and merges walk back up this instead of searching the tree for a parent. Every internal
+		node but the root has at least two children, so MAX_HEIGHT levels can never run out.
+	*/
+    static constexpr int MAX_HEIGHT = 64;
+    struct PathStep {
+        Node* node;
+        int child;  // ptr2Tree()[child] is the next node down
+    };
+    struct Path {
+        PathStep steps[MAX_HEIGHT];
+        int depth = 0;
+    };
+
+    int leafCapacity() const;      // one spare slot for the overflowing key
+    int internalCapacity() const;  // maxIntChildLimit-1 keys + one spare
+    int upperBound(const Node* cursor, const Key& key) const;  //#of keys <= key
+    int lowerBound(const Node* cursor, const Key& key) const;  //#of keys <  key
+    bool equal(const Key& a, const Key& b) const { return !comp(a, b) && !comp(b, a); }
+    void countComparisons(int n) const;            // what one intra-node search over n keys costs
+
+    // Suffix-truncated separators and prefix-compressed leaves for std::string keys (see key_compression.hpp)
+    static constexpr bool PREFIX_COMPRESSION =
+        Node::PREFIXED && (std::is_same_v<Compare, std::less<Key>> || std::is_same_v<Compare, std::less<>>);
+    using LeafKey = std::conditional_t<PREFIX_COMPRESSION, Key, const Key&>;
+    LeafKey leafKey(const Node* leaf, int idx) const;  // the whole key, prefix and all
+    int compareLeafKey(const Node* leaf, int idx, const Key& key) const;  // <0, 0, >0: leafKey below, at, above key
+    bool leafKeyEquals(const Node* leaf, int idx, const Key& key) const;
+    bool leafKeyAbove(const Node* leaf, int idx, const Key& key) const;  // key < leafKey(leaf, idx)
+    int leafBound(const Node* leaf, const Key& key, bool upper) const;   // upperBound/lowerBound of a compressed leaf
+    void storeLeafKey(Node* leaf, int idx, const Key& key);  // key has to start with the leaf's prefix
+    void fitPrefix(Node* leaf, const Key& key);   // shorten the prefix until key starts with it
+    void compactPrefix(Node* leaf);               // lengthen it to all the leaf's keys share
+    Key separator(const Key& leftMax, const Key& rightMin) const;  // shortest s, leftMax < s <= rightMin
+    Key leafSeparator(const Node* left, const Node* right) const;
+    void trace(TreeEvent event, const Key& key);   // count the event and hand it to onEvent
+
+    // Bloom filter of the keys, consulted before find and removeKey descend (see filter.hpp)
+    static constexpr std::uint64_t MIN_FILTER_KEYS = 1024;
+    static std::uint64_t keyHash(const Key& key);
+    bool filterRejects(const Key& key) const;  // true only if key is surely absent
+    void filterMissed() const;                 // the filter passed a key the tree does not hold
+    void filterAdd(const Key& key);
+    void filterRemoved(std::uint64_t keys = 1);  // rebuilds once half of the filter's keys are stale
+    void rebuildFilter(int bitsPerKey);        // from the keys in the tree, with room to grow
+
+    Node* descend(const Key& key, Path& path) const;     // leaf for key, internal nodes pushed on path
+    bool insertIntoLeaf(Node* cursor, const Key& key, const Value& value, Path& path);  // false if the leaf split
+    void insertInternal(const Key& x, Node* child, Path& path);  //Insert x and its right child in the parent on top of path
+    bool onRightEdge(const Path& path) const;                  // every step on path took the last child
+    bool removeEntry(const Key& x);                            //removeKey once past the filter
+    void removeInternal(int childIdx, Path& path);            //Remove ptr2Tree()[childIdx] and its key from the top of path
+
+    // removeRange: cut [lo, hi) out below node, free whole subtrees, join what is left underfull (see range_removal.hpp)
+    enum class Edge { BOTH, TO_END, FROM_START };  // which bounds of [lo, hi) fall inside the subtree
+    template <typename Visitor>
+    std::size_t removeRangeBelow(Node* node, const Key& lo, const Key& hi, Visitor& removed, Edge edge, Node*& leftEdge,
+                                 Node* rightEdge);
+    template <typename Visitor>
+    std::size_t dropSubtree(Node* node, Visitor& removed);  // every key below node, nodes freed
+    bool underfull(const Node* node) const;                  // below the minimum of a non-root node
+    void fixChildren(Node* node);                            // join every underfull child with a sibling
+    void joinSiblings(Node* parent, int i);                  // children i and i+1 merged or evened out
+    void removeChild(Node* parent, int childIdx);            // ptr2Tree()[childIdx] and the key left of it
+    void shrinkRoot(const Key& key);                         // collapse one-child roots, drop an empty root leaf
+
+    // bulkLoad and parallelBulkLoad: leaves and internal levels from whole runs of keys (see bulk_load.hpp)
+    static constexpr std::size_t PARALLEL_ENTRIES = std::size_t{1} << 16;  // fewest pairs worth a thread of their own
+    static constexpr std::size_t PARALLEL_NODES = 4096;                    // fewest nodes of a level worth one
+    static constexpr std::size_t SPLITTER_SAMPLES = 16;                    // per run and partition
+    bool evenLeaves(Node* left, Node* right);  // true if right moved into left entirely, left to free it
+    void buildLevels(std::vector<Node*>& level, std::vector<Key>& separators, int childFill, unsigned threads);
+    Node* findLeaf(const Key& key, bool upper) const;  // leaf whose range holds the first key >= (or >) key
+    Node* firstLeftNode(Node* cursor);
+    Node* newNode(bool isLeaf);    // empty node from the slab of its kind
+    void freeNode(Node* node);     // back to its slab's free list, or left in the snapshot image it lives in
+    void initSlabs();              // size classes from the limits, before the first node
+    void destroyTree(Node* node);  // Helper function for cleanup
+
+    // Batches: key order of a batch, and every descent of a sorted batch at once (see batch.hpp)
+    static constexpr std::size_t INSERT_CHUNK = 64;  // keys multiInsert prefetches the paths of in one go
+    template <typename KeyOf>
+    std::vector<std::size_t> sortedOrder(std::size_t n, KeyOf&& keyOf) const;
+    template <typename KeyOf, typename LeafVisitor>
+    void descendBatch(const std::size_t* order, std::size_t n, KeyOf&& keyOf, LeafVisitor&& visit) const;
+    template <typename Store>
+    void lookupBatch(const Key* keys, std::size_t n, Store&& store) const;
+
+   public:
+    BasicBPTree();
+    BasicBPTree(int degreeInternal, int degreeLeaf);
+    ~BasicBPTree();  // Destructor for proper cleanup
+
+    BasicBPTree(const BasicBPTree&) = delete;
+    BasicBPTree& operator=(const BasicBPTree&) = delete;
+
+    Node* getRoot();
+    int getMaxIntChildLimit() const;
+    int getMaxLeafNodeLimit() const;
+    void setRoot(Node*);
+    using EventHandler = std::function<void(TreeEvent, const Key&)>;
+    void setEventHandler(EventHandler handler);  // empty handler to stop
+    const TreeStats& getStats() const;
+    void resetStats();
+    MemoryStats getMemoryStats() const;  // bytes reserved by and in use in the node slabs
+
+    Value* find(const Key& key);  // NULL if the key is absent
+    const Value* find(const Key& key) const;
+    bool contains(const Key& key) const;
+    void insert(const Key& key, const Value& value);
+    bool removeKey(const Key& key);  // false if the key is absent
+    // Every key in [lo, hi), #of keys removed; removed(key, value) is called for each, in key order
+    std::size_t removeRange(const Key& lo, const Key& hi);
+    template <typename Visitor>
+    std::size_t removeRange(const Key& lo, const Key& hi, Visitor&& removed);
+
+    // n keys at once: sorted, with shared and interleaved descents. results[i] is what find(keys[i]) returns
+    void multiGet(const Key* keys, std::size_t n, Value** results);
+    void multiGet(const Key* keys, std::size_t n, const Value** results) const;
+    void multiInsert(const std::pair<Key, Value>* pairs, std::size_t n);  // same as n inserts in key order
+
+    // Replace the contents with (key, value) pairs sorted by Compare, false if they are not
+    template <typename InputIt>
+    bool bulkLoad(InputIt first, InputIt last, double fillFactor = 1.0);
+    // The same from pairs in any order, sorted and built on threads threads (0: all); [first, last) is reordered
+    template <typename RandomIt>
+    void parallelBulkLoad(RandomIt first, RandomIt last, double fillFactor = 1.0, unsigned threads = 0);
+
+    // Bloom filter in front of find/contains/removeKey, most absent keys cost one cache line instead of a descent
+    void enableFilter(int bitsPerKey = 10);  // built from the keys present, kept up to date from then on
+    void disableFilter();
+    FilterStats getFilterStats() const;
+
+    // DEFERRED takes borrows and merges off removeKey, compact() does them later in key order
+    void setUnderflowPolicy(UnderflowPolicy policy);  // back to STRICT compacts everything first
+    UnderflowPolicy getUnderflowPolicy() const;
+    std::size_t compact(std::size_t maxLeaves = SIZE_MAX);  // up to maxLeaves queued leaves, #of them joined
+    std::size_t pendingCompaction() const;                  // #of leaves queued
+
+    // Whole tree to one file and back, trivially copyable keys and values only (see snapshot.hpp)
+    void save(const std::string& path) const;
+    void open(const std::string& path);  // replace the contents with the image, mapped and used in place
+
+    // Ordered access: one descent, then the ptr2next leaf chain
+    Iterator begin();
+    Iterator end();
+    ConstIterator begin() const;
+    ConstIterator end() const;
+    Iterator lower_bound(const Key& key);  // first key >= key
+    Iterator upper_bound(const Key& key);  // first key >  key
+    ConstIterator lower_bound(const Key& key) const;
+    ConstIterator upper_bound(const Key& key) const;
+    Range<Iterator> scan(const Key& lo, const Key& hi);  // every key in [lo, hi)
+    Range<ConstIterator> scan(const Key& lo, const Key& hi) const;
+};
+
+}  // namespace bptree
+
+#include "bptree/impl/utils.hpp"
+#include "bptree/impl/search.hpp"
+#include "bptree/impl/insertion.hpp"
+#include "bptree/impl/removal.hpp"
+#include "bptree/impl/range_removal.hpp"
+#include "bptree/impl/compaction.hpp"
+#include "bptree/impl/bulk_load.hpp"
+#include "bptree/impl/parallel_build.hpp"
+#include "bptree/impl/batch.hpp"
+#include "bptree/impl/key_compression.hpp"
+#include "bptree/impl/snapshot.hpp"
+#include "bptree/impl/filter.hpp"
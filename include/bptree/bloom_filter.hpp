@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "bptree/node.hpp"
+
+namespace bptree {
+
+// Negative-lookup filter of a BasicBPTree, see BasicBPTree::enableFilter()
+struct FilterStats {
+    std::size_t bytes = 0;             // of the bit array, 0 while no filter is enabled
+    int bitsPerKey = 0;                // the filter was sized with, per key of capacity
+    std::uint64_t capacity = 0;        // keys it was sized for, a rebuild follows once more are added
+    std::uint64_t keys = 0;            // added since the last rebuild, stale ones included
+    std::uint64_t staleKeys = 0;       // of those, removed from the tree since (their bits stay set)
+    std::uint64_t rebuilds = 0;
+    std::uint64_t rejected = 0;        // find/removeKey answered by the filter alone
+    std::uint64_t falsePositives = 0;  // passed by the filter, absent from the tree
+};
+
+class BloomFilter {
+    /*
+		Blocked Bloom filter: every key sets its k bits inside one cache-line-sized block picked
+		by its hash, so a check touches a single line however many bits it tests. Against a
+		classic filter of the same size that costs a little accuracy, since blocks fill unevenly.
+
+		Keys come in as 64-bit hashes that are already well mixed (see mix()): the upper half
+		picks the block, a remix of the whole hash the k bits by double hashing. Bits are only
+		ever set, so a removed key keeps answering "maybe" until the filter is built again.
+	*/
+   public:
+    BloomFilter(std::uint64_t capacity, int bitsPerKey)
+        : blocks(std::max<std::uint64_t>(1, (capacity * bitsPerKey + BLOCK_BITS - 1) / BLOCK_BITS)),
+          keyCapacity(capacity),
+          bits(bitsPerKey),
+          probes(std::clamp(static_cast<int>(std::lround(bitsPerKey * 0.69)), 1, MAX_PROBES)) {}
+
+    void add(std::uint64_t hash) {
+        Block& block = blockOf(hash);
+        forEachBit(hash, [&block](unsigned bit) { block.words[bit / 64] |= std::uint64_t{1} << (bit % 64); });
+    }
+
+    bool mayContain(std::uint64_t hash) const {
+        const Block& block = blockOf(hash);
+        bool all = true;
+        forEachBit(hash, [&](unsigned bit) { all &= (block.words[bit / 64] >> (bit % 64)) & 1; });
+        return all;
+    }
+
+    std::uint64_t capacity() const { return keyCapacity; }
+    std::size_t bytes() const { return blocks.size() * sizeof(Block); }
+    int getBitsPerKey() const { return bits; }
+
+    // Spreads any std::hash result (the identity for integers in most libraries) over all 64 bits
+    static std::uint64_t mix(std::uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+   private:
+    static constexpr unsigned BLOCK_BITS = CACHE_LINE_SIZE * 8;
+    static constexpr int MAX_PROBES = 16;
+    static_assert(BLOCK_BITS == 512, "bit positions within a block are taken 9 bits at a time");
+
+    struct alignas(CACHE_LINE_SIZE) Block {
+        std::uint64_t words[BLOCK_BITS / 64] = {};
+    };
+
+    std::vector<Block> blocks;
+    std::uint64_t keyCapacity;
+    int bits;
+    int probes;
+
+    Block& blockOf(std::uint64_t hash) { return blocks[((hash >> 32) * blocks.size()) >> 32]; }
+    const Block& blockOf(std::uint64_t hash) const { return blocks[((hash >> 32) * blocks.size()) >> 32]; }
+
+    template <typename Visit>
+    void forEachBit(std::uint64_t hash, Visit&& visit) const {
+        std::uint64_t remixed = hash * 0x9e3779b97f4a7c15ULL;
+        std::uint32_t a = static_cast<std::uint32_t>(remixed >> 32);
+        std::uint32_t b = static_cast<std::uint32_t>(remixed) | 1;
+        for (int i = 0; i < probes; i++, a += b) visit(a >> (32 - 9));  // top 9 bits: one of 512
+    }
+};
+
+namespace detail {
+
+// Disabled std::hash specializations are not default constructible
+template <typename Key>
+inline constexpr bool HASHABLE = std::is_default_constructible_v<std::hash<Key>>;
+
+}  // namespace detail
+
+}  // namespace bptree
@@ -7,69 +7,73 @@
 #include <string>
 #include <memory>
 #include <cstdio>
+#include <cstddef>
 
-namespace bptree {
+#include "bptree/basic_bptree.hpp"
+#include "bptree/heap_file.hpp"
+#include "bptree/wal.hpp"
 
-class Node {
-    /*
-		Generally size of the this node should be equal to the block size. Which will limit the number of disk access and increase the accesssing time.
-		Intermediate nodes only hold the Tree pointers which is of considerably small size(so they can hold more Tree pointers) and only Leaf nodes hold
-		the data pointer directly to the disc.
+namespace bptree {
 
-		IMPORTANT := All the data has to be present in the leaf node
-	*/
-   public:
-    bool isLeaf;
-    std::vector<int> keys;
-    //Node* ptr2parent; //Pointer to go to parent node CANNOT USE check https://stackoverflow.com/questions/57831014/why-we-are-not-saving-the-parent-pointer-in-b-tree-for-easy-upward-traversal-in
-    Node* ptr2next;              //Pointer to connect next node for leaf nodes
-    union ptr {                  //to make memory efficient Node
-        std::vector<Node*> ptr2Tree;  //Array of pointers to Children sub-trees for intermediate Nodes
-        std::vector<FILE*> dataPtr;   // Data-Pointer for the leaf node
+/*
+	The student database of the demo: int roll numbers mapped to the RecordId of their tuple in the
+	heap file DBFiles/tuples.db (or another tupleFile per table). Limits are chosen at runtime
+	(DYNAMIC_FANOUT), its event handler narrates every step on cout, removeKey also erases the
+	tuple and removeRange every tuple of the range. Everything structural lives in BasicBPTree.
 
-        ptr();   // To remove the error !?
-        ~ptr();  // To remove the error !?
-    } ptr2TreeOrData;
+	Given a logFile, insertTuple, removeKey and removeRange are durable: each one is committed to
+	the write-ahead log before the heap file or the tree is touched (a whole range as one
+	LOG_REMOVE_RANGE record), and the constructor replays the log into the fresh heap file and
+	tree, so a crash at any point loses no acknowledged change and leaves no tuple without its
+	key. Plain insert() bypasses the log.
 
-    friend class BPTree;  // to access private members of the Node and hold the encapsulation concept
-   public:
-    Node();
-    ~Node();  // Destructor for proper cleanup
-};
+	The constructors start the heap file afresh, as the tuples of an earlier run would have no
+	index. save() writes the index as a snapshot image next to the flushed heap file, and open()
+	starts a BPTree from the two of them, keeping the heap file: the image is mapped rather than
+	rebuilt, so it answers searches right away, whatever its size (see BasicBPTree::open).
+	Changes made after open() live in memory until the next save().
+*/
+using Node = BasicNode<int, RecordId>;
 
-class BPTree {
-    /*
-		::For Root Node :=
-			The root node has, at least two tree pointers
-		::For Internal Nodes:=
-			1. ceil(maxIntChildLimit/2)     <=  #of children <= maxIntChildLimit
-			2. ceil(maxIntChildLimit/2)-1  <=  #of keys     <= maxIntChildLimit -1
-		::For Leaf Nodes :=
-			1. ceil(maxLeafNodeLimit/2)   <=  #of keys     <= maxLeafNodeLimit -1
-	*/
-   private:
-    int maxIntChildLimit;                                   //Limiting  #of children for internal Nodes!
-    int maxLeafNodeLimit;                                   // Limiting #of nodes for leaf Nodes!!!
-    Node* root;                                             //Pointer to the B+ Tree root
-    void insertInternal(int x, Node** cursor, Node** child);  //Insert x from child in cursor(parent)
-    Node** findParent(Node* cursor, Node* child);
-    Node* firstLeftNode(Node* cursor);
-    void destroyTree(Node* node);                          // Helper function for cleanup
+extern template class BasicBPTree<int, RecordId>;
 
+class BPTree : public BasicBPTree<int, RecordId> {
    public:
+    static constexpr const char* TUPLE_FILE = "DBFiles/tuples.db";
+    static constexpr const char* LOG_FILE = "DBFiles/tuples.wal";
+    static constexpr const char* INDEX_FILE = "DBFiles/tuples.idx";
+
     BPTree();
-    BPTree(int degreeInternal, int degreeLeaf);
-    ~BPTree();  // Destructor for proper cleanup
-    Node* getRoot();
-    int getMaxIntChildLimit();
-    int getMaxLeafNodeLimit();
-    void setRoot(Node *);
+    BPTree(int degreeInternal, int degreeLeaf, const std::string& tupleFile = TUPLE_FILE,
+           const std::string& logFile = "");  // no logFile: nothing survives the process
+    void insertTuple(int key, const std::string& tuple);  // store the tuple and index it, replacing an older one
+    void save(const std::string& indexFile = INDEX_FILE);  // flush the heap file, then write the index image
+    // The table as save() left it, index image mapped and heap file kept; it has no write-ahead log
+    static std::unique_ptr<BPTree> open(const std::string& indexFile = INDEX_FILE,
+                                        const std::string& tupleFile = TUPLE_FILE);
+    HeapFile& getTuples();
+    WriteAheadLog* getLog();  // NULL without a logFile
     void display(Node* cursor);
     void seqDisplay(Node* cursor);
     void search(int key);
-    void insert(int key, FILE* filePtr);
     void removeKey(int key);
-    void removeInternal(int x, Node* cursor, Node* child);
+    void removeRange(int lo, int hi);  // every key in [lo, hi) and its tuple
+
+   private:
+    // Record types in the write-ahead log; payloads start with the key
+    enum LogRecord : std::uint8_t { LOG_INSERT = 1, LOG_REMOVE = 2, LOG_REMOVE_RANGE = 3 };
+
+    HeapFile tuples;
+    std::unique_ptr<WriteAheadLog> log;
+
+    struct KeepTuples {};  // constructor tag: reopen the heap file instead of starting it afresh
+    BPTree(KeepTuples, const std::string& tupleFile);
+
+    static std::string logPayload(int key, const std::string& tuple = std::string());
+    void applyInsert(int key, const std::string& tuple);
+    bool applyRemove(int key, RecordId& erased);  // false if the key or its tuple was missing
+    std::size_t applyRemoveRange(int lo, int hi, std::size_t& keys);  // #of tuples erased
+    void recover(const std::string& logFile);
 };
 
-} // namespace bptree
\ No newline at end of file
+} // namespace bptree
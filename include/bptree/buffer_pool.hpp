@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "bptree/page_file.hpp"
+
+namespace bptree {
+
+enum class EvictionPolicy {
+    CLOCK,  // second chance: a frame used since the hand last passed survives one more sweep
+    LRU,    // the frame unpinned longest ago goes first
+};
+
+struct PoolStats {
+    std::uint64_t hits = 0;       // fetches served from a frame
+    std::uint64_t misses = 0;     // fetches that had to read the page
+    std::uint64_t evictions = 0;  // frames taken away from another page
+    std::uint64_t writeBacks = 0; // dirty frames written to the file
+};
+
+class BufferPool {
+    /*
+		A fixed number of page-sized frames caching the pages of one PageFile. fetch()/create() pin
+		a frame and hand out a PageGuard, the frame is unpinned when the guard goes away. Only
+		unpinned frames are evicted; a dirty one is written back first. Running out of unpinned
+		frames throws std::runtime_error, so a caller must never hold more guards than frames.
+	*/
+   public:
+    class PageGuard {
+       public:
+        PageGuard() = default;
+        PageGuard(PageGuard&& other) noexcept;
+        PageGuard& operator=(PageGuard&& other) noexcept;
+        ~PageGuard();
+
+        PageId id() const;
+        unsigned char* data() const;
+        void markDirty();  // the page changed and has to be written back before eviction
+        void release();    // unpin now instead of at destruction
+        explicit operator bool() const { return pool != nullptr; }
+
+       private:
+        friend class BufferPool;
+        PageGuard(BufferPool* pool, int frame) : pool(pool), frame(frame) {}
+
+        BufferPool* pool = nullptr;
+        int frame = -1;
+    };
+
+    BufferPool(PageFile& file, std::size_t frameCount, EvictionPolicy policy = EvictionPolicy::CLOCK);
+    ~BufferPool();  // writes back dirty frames
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    PageGuard fetch(PageId id);
+    PageGuard create();           // a new zeroed page of the file, already dirty
+    void release(PageId id);      // drop the page from the pool and free it in the file, it must be unpinned
+    void flush();                 // write back every dirty frame, then sync the file
+
+    PageFile& getFile();
+    std::size_t getFrameCount() const;
+    EvictionPolicy getPolicy() const;
+    const PoolStats& getStats() const;
+    void resetStats();
+
+   private:
+    struct Frame {
+        PageId id = INVALID_PAGE;
+        int pins = 0;
+        bool dirty = false;
+        bool referenced = false;  // CLOCK bit
+        bool inLru = false;
+        std::list<int>::iterator lruPos;  // LRU: position among the unpinned frames
+    };
+
+    PageFile& file;
+    EvictionPolicy policy;
+    std::size_t pageSize;
+    std::vector<Frame> frames;
+    std::unique_ptr<unsigned char[]> memory;  // frames.size() pages back to back
+    std::unordered_map<PageId, int> pageTable;
+    std::vector<int> freeFrames;
+    std::list<int> lru;  // unpinned frames, least recently used first
+    std::size_t hand = 0;
+    PoolStats stats;
+
+    unsigned char* frameData(int frame) const;
+    int takeFrame();  // a free frame or an evicted one
+    void pin(int frame);
+    void unpin(int frame);
+    void writeBack(int frame);
+};
+
+}  // namespace bptree
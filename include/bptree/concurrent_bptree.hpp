@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bptree/epoch.hpp"
+#include "bptree/node.hpp"
+#include "bptree/simd_search.hpp"
+#include "bptree/version_latch.hpp"
+
+namespace bptree {
+
+struct ConcurrentStats {
+    std::uint64_t restarts = 0;        // operations that saw a version change and started over
+    std::uint64_t retiredNodes = 0;    // nodes cut out by merges and root collapses
+    std::uint64_t freedNodes = 0;      // of those, freed once no reader could still be inside
+    std::uint64_t retiredBacklog = 0;  // retired but not freed yet
+    std::uint64_t epoch = 0;           // of the EpochManager
+};
+
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class ConcurrentBPTree {
+    /*
+		The same B+ Tree as BasicBPTree, safe to use from any #of threads at once through optimistic
+		lock coupling: every node carries a VersionLatch, and so does the root pointer.
+
+		::Readers:=
+			find and scan take no latch at all. They descend remembering the version of each node,
+			validate the parent after reading the child pointer and the child's version, and copy
+			what they need out of the leaf before validating it once more. A writer that got in
+			between bumped a version, so the reader starts over (a scan from the last key it handed
+			out, nothing is visited twice).
+
+		::Writers:=
+			insert and removeKey descend the same way and then lock only the nodes they change, each
+			by upgrading the version seen on the way down: the leaf alone for most operations, plus
+			the ancestors that split, or the parent and siblings a leaf borrows from or merges with,
+			plus the root latch when the tree grows or shrinks a level. All locks are taken up front,
+			so a failed upgrade releases them and restarts with nothing changed.
+
+		::Reclamation:=
+			A reader may still be inside a node a merge just cut out, so every operation runs under
+			an EpochManager::Guard and removed nodes are retired to the tree's EpochManager rather
+			than freed. They are freed in batches once every guard that could have reached them is
+			closed; getStats() reports the backlog.
+
+		Optimistic readers may look at a node while it is being rewritten, so keys and values have
+		to be trivially copyable (a torn read is detected and thrown away, never dereferenced).
+		insert replaces the value of a key that is already present.
+	*/
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "optimistic readers copy keys and values that may be changing underneath");
+    static_assert(alignof(Key) <= CACHE_LINE_SIZE && alignof(Value) <= CACHE_LINE_SIZE,
+                  "over-aligned keys/values are not supported");
+
+   public:
+    ConcurrentBPTree();
+    ConcurrentBPTree(int degreeInternal, int degreeLeaf);
+    ~ConcurrentBPTree();  // NOT thread-safe, every other call must have returned
+
+    ConcurrentBPTree(const ConcurrentBPTree&) = delete;
+    ConcurrentBPTree& operator=(const ConcurrentBPTree&) = delete;
+
+    std::optional<Value> find(const Key& key) const;  // a copy, the leaf may change right after
+    bool contains(const Key& key) const;
+    bool insert(const Key& key, const Value& value);  // false if key was present, its value is replaced
+    bool removeKey(const Key& key);                   // false if the key is absent
+
+    // visit(key, value) for every key in [lo, hi) in order, on copies taken from validated leaves
+    template <typename Visitor>
+    void scan(const Key& lo, const Key& hi, Visitor&& visit) const;
+
+    std::uint64_t size() const;  // #of keys
+    int getMaxIntChildLimit() const;
+    int getMaxLeafNodeLimit() const;
+    ConcurrentStats getStats() const;
+    std::size_t collect();  // free the retired nodes no reader can reach any more, #of nodes freed
+
+   private:
+    struct Node {
+        /*
+			| latch isLeaf size capacity next | keys[capacity] | children[capacity+1] OR values[capacity] |
+
+			One cache-line-aligned allocation like BasicNode, with the latch in front. Readers look
+			at a node a writer may be changing, so size, next and the child slots, the fields that
+			steer where a reader goes next, are relaxed atomics: each read returns a value that
+			was really stored, never one the compiler tore or read a second time after the bounds
+			check. Keys and values are plain, see VersionLatch::validate.
+		*/
+        VersionLatch latch;
+        bool isLeaf;
+        int capacity;
+        std::atomic<int> size;
+        std::atomic<Node*> next;  // next leaf
+
+        static Node* create(bool isLeaf, int capacity);
+        static void destroy(Node* node);
+
+        int getSize() const { return size.load(std::memory_order_relaxed); }
+        void setSize(int n) { size.store(n, std::memory_order_relaxed); }
+        Node* getNext() const { return next.load(std::memory_order_relaxed); }
+        void setNext(Node* leaf) { next.store(leaf, std::memory_order_relaxed); }
+        Node* child(int i) { return children()[i].load(std::memory_order_relaxed); }
+        void setChild(int i, Node* node) { children()[i].store(node, std::memory_order_relaxed); }
+        // children [first, last) of from to into, starting at slot dest, the ranges may overlap
+        static void copyChildren(Node* from, int first, int last, Node* into, int dest);
+
+        Key* keys() { return reinterpret_cast<Key*>(bytes() + keysOffset()); }
+        Value* values() { return reinterpret_cast<Value*>(bytes() + slotsOffset(capacity)); }
+
+       private:
+        using Slot = std::atomic<Node*>;
+        static constexpr std::size_t roundUp(std::size_t bytes, std::size_t alignment) {
+            return (bytes + alignment - 1) / alignment * alignment;
+        }
+        static constexpr std::size_t SLOT_ALIGN = alignof(Slot) > alignof(Value) ? alignof(Slot) : alignof(Value);
+        static constexpr std::size_t keysOffset() { return roundUp(sizeof(Node), alignof(Key)); }
+        static constexpr std::size_t slotsOffset(int capacity) {
+            return roundUp(keysOffset() + capacity * sizeof(Key), SLOT_ALIGN);
+        }
+        static std::size_t allocationSize(bool isLeaf, int capacity);
+
+        unsigned char* bytes() { return reinterpret_cast<unsigned char*>(this); }
+        Slot* children() { return reinterpret_cast<Slot*>(bytes() + slotsOffset(capacity)); }
+    };
+
+    // Nodes on the way down with the version each was read at and the child slot taken
+    static constexpr int MAX_HEIGHT = 64;
+    struct PathStep {
+        Node* node;
+        std::uint64_t version;
+        int child;
+    };
+    struct Path {
+        PathStep steps[MAX_HEIGHT];
+        int depth = 0;
+        std::uint64_t rootVersion = 0;
+    };
+
+    // Latches one write operation holds, released together
+    struct LatchSet {
+        Node* nodes[3 * MAX_HEIGHT + 1];  // a leaf, then a parent and up to two siblings per level
+        bool obsolete[3 * MAX_HEIGHT + 1];
+        int count = 0;
+        VersionLatch* rootLatch = nullptr;
+
+        void add(Node* node) {
+            nodes[count] = node;
+            obsolete[count++] = false;
+        }
+        void drop(Node* node);  // node is cut out of the tree, unlock it as obsolete
+    };
+
+    int maxIntChildLimit;  // Limiting #of children for internal Nodes!
+    int maxLeafNodeLimit;  // Limiting #of keys for leaf Nodes!!!
+    Compare comp;
+    mutable VersionLatch rootLatch;  // guards root, taken by writers that add or remove a level
+    std::atomic<Node*> root;         // never NULL, an empty tree is one empty leaf
+    std::atomic<std::uint64_t> count{0};
+    mutable std::atomic<std::uint64_t> restarts{0};
+    mutable EpochManager epochs;  // frees the nodes merges and root collapses cut out
+
+    int leafCapacity() const { return maxLeafNodeLimit + 1; }  // one spare slot for the overflowing key
+    int internalCapacity() const { return maxIntChildLimit; }  // maxIntChildLimit-1 keys + one spare
+    int minLeafKeys() const { return (maxLeafNodeLimit + 1) / 2; }
+    int minInternalKeys() const { return (maxIntChildLimit + 1) / 2 - 1; }
+
+    int upperBound(Node* node, int size, const Key& key) const;  //#of keys <= key
+    int lowerBound(Node* node, int size, const Key& key) const;  //#of keys <  key
+    bool equal(const Key& a, const Key& b) const { return !comp(a, b) && !comp(b, a); }
+
+    // Optimistic descent to the leaf for key, false if a version changed on the way
+    bool descend(const Key& key, Path* path, Node*& leaf, std::uint64_t& leafVersion) const;
+    bool tryFind(const Key& key, std::optional<Value>& result) const;
+    // Copies of the entries from slot i on below hi into batch, true if hi was reached in this leaf
+    bool copyLeaf(Node* leaf, int i, int size, const Key& hi, std::vector<std::pair<Key, Value>>& batch) const;
+    bool tryInsert(const Key& key, const Value& value, bool& inserted);
+    bool tryRemove(const Key& key, bool& removed);
+
+    // Structural changes, on nodes the caller holds locked
+    void splitLeaf(Node* leaf, Path& path);
+    void rebalance(Node* cursor, Path& path, LatchSet& held);
+    void removeChild(Node* parent, int childIdx);  // child(childIdx) and the key left of it
+
+    void release(LatchSet& held);  // unlock everything, retire what was dropped to the EpochManager
+    void backoff(int attempt) const;
+    void destroyTree(Node* node);
+};
+
+}  // namespace bptree
+
+#include "bptree/impl/concurrent_bptree.hpp"
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include "bptree/buffer_pool.hpp"
+#include "bptree/page_file.hpp"
+#include "bptree/simd_search.hpp"
+
+namespace bptree {
+
+struct DiskOptions {
+    std::size_t pageSize = DEFAULT_PAGE_SIZE;         // only used when the file is created
+    std::size_t poolPages = 256;                      // frames in the buffer pool
+    EvictionPolicy eviction = EvictionPolicy::CLOCK;
+    int maxIntChildLimit = 0;  // 0: as many children as fit a page
+    int maxLeafNodeLimit = 0;  // 0: as many keys as fit a page
+};
+
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class DiskBPTree {
+    /*
+		The same B+ Tree as BasicBPTree, but every node is a page of one index file and is reached
+		through a BufferPool, so the tree outlives the process and can be larger than memory.
+		Child and next-leaf pointers are PageIds:
+
+			| isLeaf size next | keys[capacity] | children[capacity+1] OR values[capacity] |
+
+		Keys and values are copied into pages byte for byte, so both have to be trivially copyable
+		(an int key with a record id or offset as value, not a FILE* or a std::string). The limits
+		follow from the page size unless DiskOptions narrows them, and stop at MAX_PAGE_KEYS however
+		large the page; like the in-memory nodes every page keeps one spare slot so an overflowing
+		key lands in place before the split.
+
+		The root, the limits and the #of keys live in the file header, reopening the file picks the
+		tree up again (the DiskOptions limits are then ignored). flush() or the destructor write
+		everything back; there is no crash recovery, a process dying in between can leave a torn
+		file behind.
+	*/
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "disk pages store keys and values byte for byte");
+    static_assert(alignof(Key) <= 16 && alignof(Value) <= 16, "over-aligned keys/values are not supported");
+
+   public:
+    explicit DiskBPTree(const std::string& path, const DiskOptions& options = DiskOptions());
+    ~DiskBPTree();
+
+    DiskBPTree(const DiskBPTree&) = delete;
+    DiskBPTree& operator=(const DiskBPTree&) = delete;
+
+    std::optional<Value> find(const Key& key);  // a copy, the page may be evicted right after
+    bool contains(const Key& key);
+    void insert(const Key& key, const Value& value);
+    bool removeKey(const Key& key);  // false if the key is absent
+
+    // visit(key, value) for every key in [lo, hi) / every key, in order
+    template <typename Visitor>
+    void scan(const Key& lo, const Key& hi, Visitor&& visit);
+    template <typename Visitor>
+    void forEach(Visitor&& visit);
+
+    void flush();  // write back every dirty page and the header, then sync
+
+    std::uint64_t size() const;  // #of keys
+    PageId getRoot() const;
+    int getMaxIntChildLimit() const;
+    int getMaxLeafNodeLimit() const;
+    BufferPool& getPool();
+    PageFile& getFile();
+
+   private:
+    using PageGuard = BufferPool::PageGuard;
+
+    struct PageHeader {
+        std::uint16_t isLeaf;
+        std::uint16_t size;
+        PageId next;  // next leaf, INVALID_PAGE for the last one and for internal pages
+    };
+    // Key slots of a page, whatever its size: PageHeader::size has to count them
+    static constexpr int MAX_PAGE_KEYS = UINT16_MAX;
+
+    // Slots of the PageFile header this tree owns
+    enum MetaSlot { META_SIGNATURE, META_ROOT, META_INT_LIMIT, META_LEAF_LIMIT, META_SIZE };
+
+    // Same descent record as BasicBPTree::Path, with page ids instead of node pointers
+    static constexpr int MAX_HEIGHT = 64;
+    struct PathStep {
+        PageId page;
+        int child;
+    };
+    struct Path {
+        PathStep steps[MAX_HEIGHT];
+        int depth = 0;
+    };
+
+    PageFile file;
+    BufferPool pool;
+    Compare comp;
+    PageId root;
+    int maxIntChildLimit;
+    int maxLeafNodeLimit;
+    std::uint64_t count;
+
+    static constexpr std::size_t roundUp(std::size_t bytes, std::size_t alignment) {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+    static constexpr std::size_t keysOffset() { return roundUp(sizeof(PageHeader), alignof(Key)); }
+    static constexpr std::size_t childrenOffset(int capacity) {
+        return roundUp(keysOffset() + capacity * sizeof(Key), alignof(PageId));
+    }
+    static constexpr std::size_t valuesOffset(int capacity) {
+        return roundUp(keysOffset() + capacity * sizeof(Key), alignof(Value));
+    }
+    static std::uint64_t signature();
+
+    int leafCapacity() const { return maxLeafNodeLimit + 1; }
+    int internalCapacity() const { return maxIntChildLimit; }
+
+    PageHeader* header(const PageGuard& page) const { return reinterpret_cast<PageHeader*>(page.data()); }
+    Key* keys(const PageGuard& page) const { return reinterpret_cast<Key*>(page.data() + keysOffset()); }
+    PageId* children(const PageGuard& page) const {
+        return reinterpret_cast<PageId*>(page.data() + childrenOffset(internalCapacity()));
+    }
+    Value* values(const PageGuard& page) const {
+        return reinterpret_cast<Value*>(page.data() + valuesOffset(leafCapacity()));
+    }
+
+    int upperBound(const PageGuard& page, const Key& key) const;  //#of keys <= key
+    int lowerBound(const PageGuard& page, const Key& key) const;  //#of keys <  key
+    bool equal(const Key& a, const Key& b) const { return !comp(a, b) && !comp(b, a); }
+
+    PageGuard newPage(bool isLeaf);
+    PageGuard descend(const Key& key, Path& path);  // leaf for key, internal pages pushed on path
+    void growRoot(PageId left, const Key& separator, PageId right);
+    void insertInternal(Key x, PageId child, Path& path);
+    void removeInternal(int childIdx, Path& path);
+    void saveMeta();
+};
+
+}  // namespace bptree
+
+#include "bptree/impl/disk_bptree.hpp"
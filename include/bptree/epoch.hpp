@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "bptree/node.hpp"
+
+namespace bptree {
+
+struct EpochStats {
+    std::uint64_t epoch = 0;        // current global epoch
+    std::uint64_t retired = 0;      // objects retired so far
+    std::uint64_t freed = 0;        // of those, freed
+    std::uint64_t backlog = 0;      // retired - freed: waiting for readers to move on
+    std::uint64_t collections = 0;  // collect() passes that got to run
+};
+
+class EpochManager {
+    /*
+		Epoch-based reclamation. Code that follows pointers it did not lock wraps the access in a
+		Guard, which pins the global epoch in one of a fixed set of cache-line-sized slots. An
+		object unlinked from the structure is retire()d rather than freed and tagged with the epoch
+		of its retirement. The global epoch only advances once every pinned slot has seen the
+		current one, so when it is two past an object's tag no guard that could have reached the
+		object is still open and the object is freed.
+
+		Retiring is one append under a mutex. Every RECLAIM_BATCH retirements the retiring thread
+		makes a collect() pass, unless another thread already runs one, so the freeing happens in
+		batches and nobody waits for it. collect() may also be called from a housekeeping thread.
+		A guard held for long (a slow scan visitor) holds the backlog back, never correctness.
+	*/
+   public:
+    using Deleter = void (*)(void*);
+
+    class Guard {
+       public:
+        explicit Guard(EpochManager& manager);
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+       private:
+        std::atomic<std::uint64_t>* slot;
+    };
+
+    EpochManager();
+    ~EpochManager();  // frees whatever is still retired, no guard may be open
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    void retire(void* object, Deleter deleter);
+    std::size_t collect();  // try to advance the epoch and free what is safe, #of objects freed
+    EpochStats getStats() const;
+
+   private:
+    static constexpr int SLOTS = 128;  // more concurrent guards than this wait for a free slot
+    static constexpr std::size_t RECLAIM_BATCH = 64;
+    static constexpr std::uint64_t IDLE = 0;  // slot value outside a guard, epochs start at 1
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<std::uint64_t> pinned{IDLE};
+    };
+    struct Retired {
+        void* object;
+        Deleter deleter;
+        std::uint64_t epoch;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> epoch{1};
+
+    mutable std::mutex retiredMutex;
+    std::vector<Retired> retired;  // in retirement order, so epochs never decrease along it
+    std::size_t sinceCollect = 0;
+    std::uint64_t retiredCount = 0;
+    std::uint64_t freedCount = 0;
+    std::uint64_t collections = 0;
+    std::mutex collectMutex;  // one collect() pass at a time, the others skip
+
+    std::atomic<std::uint64_t>* pin();
+    bool tryAdvance();
+};
+
+}  // namespace bptree
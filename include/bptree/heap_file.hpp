@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "bptree/buffer_pool.hpp"
+#include "bptree/page_file.hpp"
+
+namespace bptree {
+
+// Where a record lives in a HeapFile: small and trivially copyable, so a leaf can hold it as value
+struct RecordId {
+    PageId page = INVALID_PAGE;
+    std::uint32_t slot = 0;
+
+    bool operator==(const RecordId& other) const { return page == other.page && slot == other.slot; }
+    bool operator!=(const RecordId& other) const { return !(*this == other); }
+};
+
+class HeapFile {
+    /*
+		Variable-length records in the slotted pages of one PageFile, cached by a BufferPool:
+
+			| slotCount freeEnd fragmented freeClass prevFree nextFree | slots[slotCount] -> ... gap ... <- records |
+
+		The slot array grows from the front, the record bytes from the back of the page. A slot is
+		{offset, length}; erasing a record zeroes its offset, so the RecordIds of the other records
+		on the page never change and the slot is handed out again by a later insert. Bytes freed in
+		the middle of the page are only counted (fragmented) and squeezed out when an insert needs
+		them.
+
+		Pages with at least pageSize/8 bytes free are chained into one of three doubly linked
+		free-space lists by how much is free (1/8, 1/4, 1/2 of the page and up), the list heads are
+		kept in the file header. An insert takes the head of the fullest list whose pages all have
+		room for it, so pages fill up before new ones are started and no insert scans the file; an
+		erase moves its page to the list it now belongs to. Reading a record is one fetch of its page. Records larger than maxRecordSize() throw
+		std::invalid_argument, page sizes above 32K as well (offsets are 16 bits).
+	*/
+   public:
+    explicit HeapFile(const std::string& path, std::size_t poolPages = 64,
+                      EvictionPolicy eviction = EvictionPolicy::CLOCK, std::size_t pageSize = DEFAULT_PAGE_SIZE);
+    ~HeapFile();
+
+    HeapFile(const HeapFile&) = delete;
+    HeapFile& operator=(const HeapFile&) = delete;
+
+    RecordId insert(std::string_view record);
+    std::optional<std::string> read(RecordId rid);  // nullopt for an erased or never used RecordId
+    bool erase(RecordId rid);                       // false if there was no record
+
+    void flush();  // write back every dirty page and the header, then sync
+
+    std::uint64_t size() const;  // #of records
+    std::size_t maxRecordSize() const;
+    BufferPool& getPool();
+    PageFile& getFile();
+
+   private:
+    using PageGuard = BufferPool::PageGuard;
+
+    struct PageHeader {
+        std::uint16_t slotCount;
+        std::uint16_t freeEnd;     // first byte of the record area
+        std::uint16_t fragmented;  // bytes of erased records below freeEnd
+        std::uint16_t freeClass;   // 0: on no free-space list, else the list + 1
+        PageId prevFree;           // neighbours on that list
+        PageId nextFree;
+    };
+
+    struct Slot {
+        std::uint16_t offset;  // 0: free slot
+        std::uint16_t length;
+    };
+
+    // Slots of the PageFile header this heap owns
+    enum MetaSlot { META_SIGNATURE, META_RECORDS, META_FREE_HEAD };  // META_FREE_HEAD + class
+
+    static constexpr int FREE_CLASSES = 3;
+
+    PageFile file;
+    BufferPool pool;
+    PageId freeHead[FREE_CLASSES];
+    std::uint64_t count;
+
+    static PageHeader* header(const PageGuard& page) { return reinterpret_cast<PageHeader*>(page.data()); }
+    static Slot* slots(const PageGuard& page) { return reinterpret_cast<Slot*>(page.data() + sizeof(PageHeader)); }
+
+    std::size_t classFloor(int freeClass) const;         // least free bytes of a page on that list
+    int classOf(const PageGuard& page) const;            // the list the page belongs on, -1 for none
+    std::size_t gap(const PageGuard& page) const;        // contiguous free bytes between slots and records
+    std::size_t freeSpace(const PageGuard& page) const;  // gap plus fragmented bytes
+    int freeSlot(const PageGuard& page) const;           // a reusable slot, -1 if the array has to grow
+    bool fits(const PageGuard& page, std::size_t length) const;
+    void compact(PageGuard& page);
+    std::uint32_t place(PageGuard& page, std::string_view record);
+    void link(PageGuard& page, int freeClass);
+    void unlink(PageGuard& page);
+    void relist(PageGuard& page);  // move the page to the list its free space calls for
+    void saveMeta();
+};
+
+}  // namespace bptree
@@ -0,0 +1,135 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+#include <numeric>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename KeyOf>
+std::vector<std::size_t> BasicBPTree<Key, Value, Compare, Fanout>::sortedOrder(std::size_t n, KeyOf&& keyOf) const {
+    // Positions of the batch in key order, equal keys in batch order; already sorted batches cost one pass
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    bool sorted = true;
+    for (std::size_t i = 1; i < n && sorted; i++) sorted = !comp(keyOf(i), keyOf(i - 1));
+    if (!sorted)
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return comp(keyOf(a), keyOf(b)); });
+    return order;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename KeyOf, typename LeafVisitor>
+void BasicBPTree<Key, Value, Compare, Fanout>::descendBatch(const std::size_t* order, std::size_t n, KeyOf&& keyOf,
+                                                            LeafVisitor&& visit) const {
+    /*
+		All descents of a sorted batch at once, one level at a time. At every node the run of keys
+		that reached it is cut into one run per child (the same child upperBound would pick for
+		each key), so neighbouring keys share every node they have in common and each node is
+		searched once per batch, not once per key. The children of a whole level are prefetched
+		before the first of them is searched, so their misses overlap instead of queueing up.
+		visit(leaf, begin, end) gets order[begin, end), the keys that belong to leaf.
+	*/
+    struct Run {
+        const Node* node;
+        std::size_t begin, end;
+    };
+    if (root == NULL || n == 0) return;
+
+    const int prefetchCapacity = std::max(leafCapacity(), internalCapacity());
+    std::vector<Run> level{{root, 0, n}}, below;
+    if constexpr (TRACING) stats.nodeVisits++;
+    while (!level.front().node->isLeaf) {  // every leaf is at the same depth
+        below.clear();
+        for (const Run& run : level) {
+            const Node* node = run.node;
+            const Key* separators = node->keys();
+            for (std::size_t i = run.begin; i < run.end;) {
+                int child = upperBound(node, keyOf(order[i]));
+                std::size_t j = i + 1;
+                if (child < node->size)
+                    while (j < run.end && comp(keyOf(order[j]), separators[child])) j++;
+                else
+                    j = run.end;
+                const Node* next = node->child(child);
+                Node::prefetch(next, prefetchCapacity);
+                below.push_back({next, i, j});
+                i = j;
+            }
+        }
+        if constexpr (TRACING) stats.nodeVisits += below.size();
+        level.swap(below);
+    }
+
+    for (const Run& run : level) visit(run.node, run.begin, run.end);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename Store>
+void BasicBPTree<Key, Value, Compare, Fanout>::lookupBatch(const Key* keys, std::size_t n, Store&& store) const {
+    // store(i, value or NULL) for every keys[i]
+    auto keyOf = [keys](std::size_t idx) -> const Key& { return keys[idx]; };
+    std::vector<std::size_t> order = sortedOrder(n, keyOf);
+    if (root == NULL) {
+        for (std::size_t i = 0; i < n; i++) store(i, static_cast<const Value*>(NULL));
+        return;
+    }
+    descendBatch(order.data(), n, keyOf, [&](const Node* leaf, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            const Key& key = keys[order[i]];
+            int idx = lowerBound(leaf, key);
+            store(order[i], idx < leaf->size && leafKeyEquals(leaf, idx, key) ? &leaf->dataPtr()[idx] : NULL);
+        }
+    });
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::multiGet(const Key* keys, std::size_t n, const Value** results) const {
+    lookupBatch(keys, n, [results](std::size_t i, const Value* value) { results[i] = value; });
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::multiGet(const Key* keys, std::size_t n, Value** results) {
+    lookupBatch(keys, n, [results](std::size_t i, const Value* value) { results[i] = const_cast<Value*>(value); });
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::multiInsert(const std::pair<Key, Value>* pairs, std::size_t n) {
+    /*
+		Inserted in key order, a chunk at a time. Each chunk first goes down as one batch only to
+		prefetch its paths, so the inserts that follow find their nodes in cache. A key that
+		belongs to the leaf the previous key went into, which still has room, is put there
+		without a descent of its own. Each key enters the filter as it enters its leaf: a rebuild
+		the filter starts on the way reads the tree, and would lose keys added ahead of it.
+	*/
+    auto keyOf = [pairs](std::size_t idx) -> const Key& { return pairs[idx].first; };
+    std::vector<std::size_t> order = sortedOrder(n, keyOf);
+
+    Node* last = NULL;  // leaf the previous key went into, NULL after a split
+    for (std::size_t chunk = 0; chunk < n; chunk += INSERT_CHUNK) {
+        const std::size_t chunkEnd = std::min(n, chunk + INSERT_CHUNK);
+        descendBatch(order.data() + chunk, chunkEnd - chunk, keyOf, [](const Node*, std::size_t, std::size_t) {});
+
+        for (std::size_t i = chunk; i < chunkEnd; i++) {
+            const std::pair<Key, Value>& entry = pairs[order[i]];
+            if (root == NULL) {
+                insert(entry.first, entry.second);  // filtered there
+                continue;
+            }
+            if (filter != NULL) filterAdd(entry.first);
+
+            // Keys below the leaf's largest (or anything, for the last leaf) route to it, given the previous one did
+            Path path;
+            if (last != NULL && last->size < getMaxLeafNodeLimit() &&
+                (last->ptr2next == NULL || leafKeyAbove(last, last->size - 1, entry.first))) {
+                insertIntoLeaf(last, entry.first, entry.second, path);
+                continue;
+            }
+            Node* leaf = descend(entry.first, path);
+            last = insertIntoLeaf(leaf, entry.first, entry.second, path) ? leaf : NULL;
+        }
+    }
+}
+
+}  // namespace bptree
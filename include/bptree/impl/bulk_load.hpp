@@ -0,0 +1,176 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+#include <exception>
+#include <thread>
+
+namespace bptree {
+
+namespace detail {
+
+// fn(begin, end) over [0, count) cut in up to `threads` slices of at least grain items, the last on the calling thread
+template <typename Fn>
+void parallelFor(unsigned threads, std::size_t count, std::size_t grain, Fn&& fn) {
+    const std::size_t slices = std::clamp<std::size_t>(count / std::max<std::size_t>(grain, 1), 1, std::max(threads, 1u));
+    if (slices == 1) {
+        fn(std::size_t{0}, count);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(slices);
+    auto slice = [&](std::size_t s) {
+        try {
+            fn(count * s / slices, count * (s + 1) / slices);
+        } catch (...) {
+            errors[s] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(slices - 1);
+    for (std::size_t s = 0; s + 1 < slices; s++) workers.emplace_back(slice, s);
+    slice(slices - 1);
+    for (std::thread& worker : workers) worker.join();
+    for (std::exception_ptr& error : errors)
+        if (error) std::rethrow_exception(error);
+}
+
+}  // namespace detail
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename InputIt>
+bool BasicBPTree<Key, Value, Compare, Fanout>::bulkLoad(InputIt first, InputIt last, double fillFactor) {
+    /*
+		Bottom-up build from (key, value) pairs already sorted by Compare:
+			1. Stream the pairs into leaves of leafFill keys each, linking them through ptr2next and
+			remembering the first key of every leaf but the first as its separator.
+			2. Group each level into internal nodes of about childFill children, the separator in
+			front of every group moves up to the next level, until only the root is left.
+		No descent, no split and no findParent, every node is written exactly once. fillFactor is the
+		fraction of maxLeafNodeLimit/maxIntChildLimit to fill, clamped so every node stays above the
+		underflow limits removeKey works with; leave room for later inserts with something below 1.
+		Out of order input returns false and the tree is left as it was. String separators are the
+		shortest that still divide their leaves (see key_compression.hpp).
+	*/
+    const int maxLeaf = getMaxLeafNodeLimit();
+    const int minLeaf = (maxLeaf + 1) / 2;
+    const int leafFill = std::clamp(static_cast<int>(maxLeaf * fillFactor + 0.5), minLeaf, maxLeaf);
+    const int childFill = std::clamp(static_cast<int>(getMaxIntChildLimit() * fillFactor + 0.5),
+                                     (getMaxIntChildLimit() + 1) / 2, getMaxIntChildLimit());
+
+    std::vector<Node*> level;     // the leaves, then every internal level in turn
+    std::vector<Key> separators;  // separators[i] divides level[i] from level[i + 1]
+    Node* leaf = NULL;
+
+    for (; first != last; ++first) {
+        auto&& entry = *first;
+        if (leaf != NULL && comp(entry.first, leaf->keys()[leaf->size - 1])) {
+            for (Node* node : level) freeNode(node);
+            return false;
+        }
+        if (leaf == NULL || leaf->size == leafFill) {
+            Node* newLeaf = newNode(true);
+            if (leaf != NULL) {
+                leaf->ptr2next = newLeaf;
+                separators.push_back(separator(leaf->keys()[leaf->size - 1], entry.first));
+            }
+            level.push_back(newLeaf);
+            leaf = newLeaf;
+        }
+        leaf->keys()[leaf->size] = entry.first;
+        leaf->dataPtr()[leaf->size] = entry.second;
+        leaf->size++;
+    }
+
+    /*
+		The stream length is unknown up front, so only the last leaf can come up short. Fold it into
+		its left neighbour when both fit in one leaf, otherwise even the two out.
+	*/
+    if (level.size() > 1 && leaf->size < minLeaf) {
+        Node* prev = level[level.size() - 2];
+        if (evenLeaves(prev, leaf)) {
+            freeNode(leaf);
+            level.pop_back();
+            separators.pop_back();
+        } else {
+            separators.back() = separator(prev->keys()[prev->size - 1], leaf->keys()[0]);
+        }
+    }
+    for (Node* node : level) compactPrefix(node);  // leaves are filled with whole keys, compressed once complete
+    buildLevels(level, separators, childFill, 1);
+
+    destroyTree(root);
+    image.reset();  // whatever lived in a snapshot image is gone now
+    root = level.empty() ? NULL : level[0];
+    if constexpr (TRACING) stats.rootChanges++;
+    if (filter != NULL) rebuildFilter(filter->getBitsPerKey());
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::evenLeaves(Node* left, Node* right) {
+    // Neighbouring leaves of whole keys: right moved into left if both fit, otherwise total/2 entries left in right
+    const int total = left->size + right->size;
+    if (total <= getMaxLeafNodeLimit()) {
+        std::move(right->keys(), right->keys() + right->size, left->keys() + left->size);
+        std::move(right->dataPtr(), right->dataPtr() + right->size, left->dataPtr() + left->size);
+        left->size = total;
+        left->ptr2next = right->ptr2next;
+        right->size = 0;
+        return true;
+    }
+    const int leftSize = total - total / 2;
+    if (left->size > leftSize) {
+        int shift = left->size - leftSize;  // entries moving from the tail of left
+        std::move_backward(right->keys(), right->keys() + right->size, right->keys() + right->size + shift);
+        std::move_backward(right->dataPtr(), right->dataPtr() + right->size, right->dataPtr() + right->size + shift);
+        std::move(left->keys() + leftSize, left->keys() + left->size, right->keys());
+        std::move(left->dataPtr() + leftSize, left->dataPtr() + left->size, right->dataPtr());
+    } else if (left->size < leftSize) {
+        int shift = leftSize - left->size;  // entries moving from the head of right
+        std::move(right->keys(), right->keys() + shift, left->keys() + left->size);
+        std::move(right->dataPtr(), right->dataPtr() + shift, left->dataPtr() + left->size);
+        std::move(right->keys() + shift, right->keys() + right->size, right->keys());
+        std::move(right->dataPtr() + shift, right->dataPtr() + right->size, right->dataPtr());
+    }
+    left->size = leftSize;
+    right->size = total / 2;
+    return false;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::buildLevels(std::vector<Node*>& level, std::vector<Key>& separators,
+                                                           int childFill, unsigned threads) {
+    const std::size_t minChildren = (getMaxIntChildLimit() + 1) / 2;
+    while (level.size() > 1) {
+        /*
+			Internal levels are fully known, so spread the children evenly over just enough nodes
+			instead of patching up the last one: with n children in k nodes each gets n/k or n/k+1.
+			That fixes where every node starts, so its slice of the level can be built on any
+			thread. Blocks are taken here, the slab is not thread-safe.
+		*/
+        std::size_t n = level.size();
+        std::size_t k = (n + childFill - 1) / childFill;
+        if (k > 1 && n / k < minChildren) k = n / minChildren;
+
+        std::vector<Node*> nextLevel(k);
+        std::vector<Key> nextSeparators(k - 1);
+        for (Node*& node : nextLevel) node = static_cast<Node*>(internalSlab.allocate());
+        detail::parallelFor(threads, k, PARALLEL_NODES, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; j++) {
+                std::size_t idx = j * (n / k) + std::min(j, n % k);  // first child of node j
+                int children = static_cast<int>(n / k + (j < n % k ? 1 : 0));
+                Node* node = Node::construct(nextLevel[j], false, internalCapacity());
+                if (j > 0) nextSeparators[j - 1] = std::move(separators[idx - 1]);
+                for (int c = 0; c < children; c++) {
+                    node->ptr2Tree()[c] = level[idx + c];
+                    if (c > 0) node->keys()[c - 1] = std::move(separators[idx + c - 1]);
+                }
+                node->size = children - 1;
+            }
+        });
+        level.swap(nextLevel);
+        separators.swap(nextSeparators);
+    }
+}
+
+}  // namespace bptree
@@ -0,0 +1,76 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+#include <algorithm>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::setUnderflowPolicy(UnderflowPolicy policy) {
+    /*
+		Under DEFERRED a delete never borrows or merges: it takes the key out of its leaf and is
+		done, however empty that leaves the leaf, so a delete costs one descent and one shift
+		and a workload hovering around the half-full line does not merge and split the same
+		leaves back and forth. A leaf that drops below half is queued by one of its keys, once.
+		The rightmost leaf can start below half (see ::Appends in insertion.hpp), so it never
+		crosses that line: a delete from it only raises tailUnderfull, and compact() queues it
+		then by the last separator above it, the same key however often it was deleted from.
+		Searches, scans and inserts work on underfull and empty leaves as on any other.
+
+		compact() descends to the queued leaves in key order and joins each that is still
+		underfull with a sibling (merged if both fit in one node, else evened out), then goes up
+		the path while the parents are underfull in turn, the same joins removeRange does. Leaves
+		under one parent are all fixed by the first of them. Trees are not shared between threads,
+		so the owner runs it, e.g. in batches between requests.
+	*/
+    if (underflowPolicy == UnderflowPolicy::DEFERRED && policy == UnderflowPolicy::STRICT) compact();
+    underflowPolicy = policy;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+UnderflowPolicy BasicBPTree<Key, Value, Compare, Fanout>::getUnderflowPolicy() const {
+    return underflowPolicy;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::size_t BasicBPTree<Key, Value, Compare, Fanout>::pendingCompaction() const {
+    return underfullLeaves.size() + (tailUnderfull ? 1 : 0);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::size_t BasicBPTree<Key, Value, Compare, Fanout>::compact(std::size_t maxLeaves) {
+    if (tailUnderfull && root != NULL && !root->isLeaf) {
+        // The last separator on the right edge routes to the rightmost leaf and nowhere else
+        Node* parent = root;
+        while (!parent->child(parent->size)->isLeaf) parent = parent->child(parent->size);
+        underfullLeaves.push_back(parent->keys()[parent->size - 1]);
+    }
+    tailUnderfull = false;
+
+    // The newest maxLeaves entries of the queue, in key order so neighbouring leaves come in turn
+    const std::size_t n = std::min(maxLeaves, underfullLeaves.size());
+    std::vector<Key> batch(std::make_move_iterator(underfullLeaves.end() - n), std::make_move_iterator(underfullLeaves.end()));
+    underfullLeaves.resize(underfullLeaves.size() - n);
+    std::sort(batch.begin(), batch.end(), [this](const Key& a, const Key& b) { return comp(a, b); });
+
+    std::size_t joined = 0;
+    for (const Key& key : batch) {
+        if (root == NULL) break;
+        Path path;
+        Node* leaf = descend(key, path);
+        if (path.depth == 0 || !underfull(leaf)) continue;  // refilled since, or joined by an earlier one
+
+        // Fix the children of each parent up the path, for as long as that parent is underfull itself
+        joined++;
+        for (int d = path.depth - 1; d >= 0; d--) {
+            Node* parent = path.steps[d].node;
+            fixChildren(parent);
+            if (!underfull(parent)) break;
+        }
+        shrinkRoot(key);
+    }
+    return joined;
+}
+
+}  // namespace bptree
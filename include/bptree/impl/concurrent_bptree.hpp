@@ -0,0 +1,583 @@
+#pragma once
+
+// Member definitions of ConcurrentBPTree, included from bptree/concurrent_bptree.hpp
+
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <utility>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare>
+std::size_t ConcurrentBPTree<Key, Value, Compare>::Node::allocationSize(bool isLeaf, int capacity) {
+    std::size_t slotBytes = isLeaf ? capacity * sizeof(Value) : (capacity + 1) * sizeof(Slot);
+    return roundUp(slotsOffset(capacity) + slotBytes, CACHE_LINE_SIZE);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename ConcurrentBPTree<Key, Value, Compare>::Node* ConcurrentBPTree<Key, Value, Compare>::Node::create(bool isLeaf,
+                                                                                                      int capacity) {
+    // Keys and values are trivially copyable, only the child pointers need a defined start
+    void* block = ::operator new(allocationSize(isLeaf, capacity), std::align_val_t(CACHE_LINE_SIZE));
+    Node* node = new (block) Node();
+    node->isLeaf = isLeaf;
+    node->capacity = capacity;
+    node->setSize(0);
+    node->setNext(nullptr);
+    if (!isLeaf) {
+        for (int i = 0; i <= capacity; i++) new (node->children() + i) Slot(nullptr);
+    }
+    return node;
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::Node::destroy(Node* node) {
+    node->~Node();
+    ::operator delete(node, std::align_val_t(CACHE_LINE_SIZE));
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::Node::copyChildren(Node* from, int first, int last, Node* into, int dest) {
+    if (from == into && dest > first) {
+        for (int i = last - first - 1; i >= 0; i--) into->setChild(dest + i, from->child(first + i));
+    } else {
+        for (int i = 0; i < last - first; i++) into->setChild(dest + i, from->child(first + i));
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::LatchSet::drop(Node* node) {
+    for (int i = 0; i < count; i++)
+        if (nodes[i] == node) obsolete[i] = true;
+}
+
+template <typename Key, typename Value, typename Compare>
+ConcurrentBPTree<Key, Value, Compare>::ConcurrentBPTree() : ConcurrentBPTree(4, 3) {}
+
+template <typename Key, typename Value, typename Compare>
+ConcurrentBPTree<Key, Value, Compare>::ConcurrentBPTree(int degreeInternal, int degreeLeaf)
+    : maxIntChildLimit(degreeInternal), maxLeafNodeLimit(degreeLeaf) {
+    root.store(Node::create(true, leafCapacity()), std::memory_order_release);
+}
+
+template <typename Key, typename Value, typename Compare>
+ConcurrentBPTree<Key, Value, Compare>::~ConcurrentBPTree() {
+    destroyTree(root.load(std::memory_order_relaxed));
+    // epochs frees the retired nodes last
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::destroyTree(Node* node) {
+    if (!node->isLeaf) {
+        for (int i = 0; i <= node->getSize(); i++) destroyTree(node->child(i));
+    }
+    Node::destroy(node);
+}
+
+template <typename Key, typename Value, typename Compare>
+std::uint64_t ConcurrentBPTree<Key, Value, Compare>::size() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+template <typename Key, typename Value, typename Compare>
+int ConcurrentBPTree<Key, Value, Compare>::getMaxIntChildLimit() const {
+    return maxIntChildLimit;
+}
+
+template <typename Key, typename Value, typename Compare>
+int ConcurrentBPTree<Key, Value, Compare>::getMaxLeafNodeLimit() const {
+    return maxLeafNodeLimit;
+}
+
+template <typename Key, typename Value, typename Compare>
+ConcurrentStats ConcurrentBPTree<Key, Value, Compare>::getStats() const {
+    EpochStats reclaimed = epochs.getStats();
+    ConcurrentStats stats;
+    stats.restarts = restarts.load(std::memory_order_relaxed);
+    stats.retiredNodes = reclaimed.retired;
+    stats.freedNodes = reclaimed.freed;
+    stats.retiredBacklog = reclaimed.backlog;
+    stats.epoch = reclaimed.epoch;
+    return stats;
+}
+
+template <typename Key, typename Value, typename Compare>
+std::size_t ConcurrentBPTree<Key, Value, Compare>::collect() {
+    return epochs.collect();
+}
+
+template <typename Key, typename Value, typename Compare>
+int ConcurrentBPTree<Key, Value, Compare>::upperBound(Node* node, int size, const Key& key) const {
+    // size is read once by the caller, a racing writer can change the node's size but never past capacity
+    const Key* keys = node->keys();
+    if constexpr (simd::SUPPORTED<Key, Compare>)
+        return simd::upperBound(keys, size, key);
+    else
+        return std::upper_bound(keys, keys + size, key, comp) - keys;
+}
+
+template <typename Key, typename Value, typename Compare>
+int ConcurrentBPTree<Key, Value, Compare>::lowerBound(Node* node, int size, const Key& key) const {
+    const Key* keys = node->keys();
+    if constexpr (simd::SUPPORTED<Key, Compare>)
+        return simd::lowerBound(keys, size, key);
+    else
+        return std::lower_bound(keys, keys + size, key, comp) - keys;
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::backoff(int attempt) const {
+    restarts.fetch_add(1, std::memory_order_relaxed);
+    if (attempt >= 4) std::this_thread::yield();  // whoever holds the latch needs the core more than we do
+}
+
+template <typename Key, typename Value, typename Compare>
+bool ConcurrentBPTree<Key, Value, Compare>::descend(const Key& key, Path* path, Node*& leaf,
+                                                    std::uint64_t& leafVersion) const {
+    /*
+		Lock coupling without the locks: the child's version is read while the parent still
+		validates, so the child was really the parent's child at that moment and any later change
+		to it shows up in its own version.
+	*/
+    std::uint64_t rootVersion, version;
+    if (!rootLatch.readLock(rootVersion)) return false;
+    Node* node = root.load(std::memory_order_acquire);
+    if (!node->latch.readLock(version) || !rootLatch.validate(rootVersion)) return false;
+    if (path != nullptr) {
+        path->depth = 0;
+        path->rootVersion = rootVersion;
+    }
+
+    for (int depth = 0; !node->isLeaf; depth++) {
+        if (depth == MAX_HEIGHT) return false;
+        int i = upperBound(node, node->getSize(), key);
+        Node* child = node->child(i);
+        // The slot may have been read mid-shift, nothing is followed before the parent checks out
+        if (!node->latch.validate(version) || child == nullptr) return false;
+
+        std::uint64_t childVersion;
+        if (!child->latch.readLock(childVersion) || !node->latch.validate(version)) return false;
+        if (path != nullptr) path->steps[path->depth++] = {node, version, i};
+        node = child;
+        version = childVersion;
+    }
+
+    leaf = node;
+    leafVersion = version;
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+std::optional<Value> ConcurrentBPTree<Key, Value, Compare>::find(const Key& key) const {
+    EpochManager::Guard guard(epochs);
+    std::optional<Value> result;
+    for (int attempt = 0; !tryFind(key, result); attempt++) backoff(attempt);
+    return result;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool ConcurrentBPTree<Key, Value, Compare>::contains(const Key& key) const {
+    return find(key).has_value();
+}
+
+template <typename Key, typename Value, typename Compare>
+bool ConcurrentBPTree<Key, Value, Compare>::tryFind(const Key& key, std::optional<Value>& result) const {
+    Node* leaf;
+    std::uint64_t version;
+    if (!descend(key, nullptr, leaf, version)) return false;
+
+    int size = leaf->getSize();
+    int idx = lowerBound(leaf, size, key);
+    bool found = idx < size && equal(leaf->keys()[idx], key);
+    Value value = found ? leaf->values()[idx] : Value();
+    if (!leaf->latch.validate(version)) return false;
+
+    result = found ? std::optional<Value>(value) : std::nullopt;
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename Visitor>
+void ConcurrentBPTree<Key, Value, Compare>::scan(const Key& lo, const Key& hi, Visitor&& visit) const {
+    /*
+		Leaf by leaf: copy the keys in range, validate, hand the copies out, then step to the next
+		leaf while the current one still validates. On a restart the scan descends again to the
+		last key it handed out and carries on right after it. The guard stays open for the whole
+		scan, a slow visitor delays reclamation.
+	*/
+    EpochManager::Guard guard(epochs);
+    std::vector<std::pair<Key, Value>> batch;
+    batch.reserve(leafCapacity());
+    Key from = lo;
+    bool resumed = false;  // from was already visited
+
+    for (int attempt = 0;; attempt++) {
+        if (attempt > 0) backoff(attempt - 1);
+        Node* leaf;
+        std::uint64_t version;
+        if (!descend(from, nullptr, leaf, version)) continue;
+
+        int size = leaf->getSize();
+        int i = resumed ? upperBound(leaf, size, from) : lowerBound(leaf, size, from);
+        while (true) {
+            bool done = copyLeaf(leaf, i, size, hi, batch);
+            Node* next = leaf->getNext();
+            if (!leaf->latch.validate(version)) break;
+
+            for (const auto& entry : batch) visit(static_cast<const Key&>(entry.first), static_cast<const Value&>(entry.second));
+            if (!batch.empty()) {
+                from = batch.back().first;
+                resumed = true;
+            }
+            if (done || next == nullptr) return;
+
+            std::uint64_t nextVersion;
+            if (!next->latch.readLock(nextVersion) || !leaf->latch.validate(version)) break;
+            leaf = next;
+            version = nextVersion;
+            size = leaf->getSize();
+            i = 0;
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+bool ConcurrentBPTree<Key, Value, Compare>::copyLeaf(Node* leaf, int i, int size, const Key& hi,
+                                                     std::vector<std::pair<Key, Value>>& batch) const {
+    batch.clear();
+    for (; i < size; i++) {
+        if (!comp(leaf->keys()[i], hi)) return true;
+        batch.emplace_back(leaf->keys()[i], leaf->values()[i]);
+    }
+    return false;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool ConcurrentBPTree<Key, Value, Compare>::insert(const Key& key, const Value& value) {
+    EpochManager::Guard guard(epochs);
+    bool inserted = false;
+    for (int attempt = 0; !tryInsert(key, value, inserted); attempt++) backoff(attempt);
+    return inserted;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool ConcurrentBPTree<Key, Value, Compare>::tryInsert(const Key& key, const Value& value, bool& inserted) {
+    Path path;
+    Node* leaf;
+    std::uint64_t leafVersion;
+    if (!descend(key, &path, leaf, leafVersion)) return false;
+    if (!leaf->latch.tryUpgrade(leafVersion)) return false;
+    LatchSet held;
+    held.add(leaf);
+
+    Key* keys = leaf->keys();
+    Value* values = leaf->values();
+    int size = leaf->getSize();
+    int i = lowerBound(leaf, size, key);
+    if (i < size && equal(keys[i], key)) {
+        values[i] = value;
+        release(held);
+        inserted = false;
+        return true;
+    }
+
+    if (size == maxLeafNodeLimit) {
+        // The leaf splits: lock every ancestor that splits with it and the first one that has room
+        int level = path.depth - 1;
+        for (; level >= 0; level--) {
+            const PathStep& step = path.steps[level];
+            if (!step.node->latch.tryUpgrade(step.version)) {
+                release(held);
+                return false;
+            }
+            held.add(step.node);
+            if (step.node->getSize() < maxIntChildLimit - 1) break;
+        }
+        if (level < 0) {  // up to the root, the tree grows a level
+            if (!rootLatch.tryUpgrade(path.rootVersion)) {
+                release(held);
+                return false;
+            }
+            held.rootLatch = &rootLatch;
+        }
+    }
+
+    // Everything this insert changes is locked now
+    for (int j = size; j > i; j--) {
+        keys[j] = keys[j - 1];
+        values[j] = values[j - 1];
+    }
+    keys[i] = key;
+    values[i] = value;
+    leaf->setSize(size + 1);
+    if (size + 1 > maxLeafNodeLimit) splitLeaf(leaf, path);
+
+    release(held);
+    count.fetch_add(1, std::memory_order_relaxed);
+    inserted = true;
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::splitLeaf(Node* leaf, Path& path) {
+    /*
+		Same split as BasicBPTree::insert/insertInternal. The new nodes are reachable only through
+		locked ones until release(), so they need no latch of their own.
+	*/
+    Node* newLeaf = Node::create(true, leafCapacity());
+    int keep = maxLeafNodeLimit / 2 + 1;
+    int size = leaf->getSize();
+    std::copy(leaf->keys() + keep, leaf->keys() + size, newLeaf->keys());
+    std::copy(leaf->values() + keep, leaf->values() + size, newLeaf->values());
+    newLeaf->setSize(size - keep);
+    newLeaf->setNext(leaf->getNext());
+    leaf->setNext(newLeaf);
+    leaf->setSize(keep);
+
+    Key separator = newLeaf->keys()[0];
+    Node* left = leaf;
+    Node* right = newLeaf;
+    while (path.depth > 0) {
+        PathStep step = path.steps[--path.depth];
+        Node* cursor = step.node;
+        Key* keys = cursor->keys();
+        int i = step.child;
+        int size = cursor->getSize();
+        for (int j = size; j > i; j--) keys[j] = keys[j - 1];
+        Node::copyChildren(cursor, i + 1, size + 1, cursor, i + 2);
+        keys[i] = separator;
+        cursor->setChild(i + 1, right);
+        cursor->setSize(++size);
+        if (size <= maxIntChildLimit - 1) return;
+
+        int partitionIdx = size / 2;  //right biased, the middle key moves up
+        Node* newInternalNode = Node::create(false, internalCapacity());
+        std::copy(keys + partitionIdx + 1, keys + size, newInternalNode->keys());
+        Node::copyChildren(cursor, partitionIdx + 1, size + 1, newInternalNode, 0);
+        newInternalNode->setSize(size - partitionIdx - 1);
+        cursor->setSize(partitionIdx);
+
+        separator = keys[partitionIdx];
+        left = cursor;
+        right = newInternalNode;
+    }
+
+    // The split went through the root, the caller holds the root latch
+    Node* newRoot = Node::create(false, internalCapacity());
+    newRoot->keys()[0] = separator;
+    newRoot->setChild(0, left);
+    newRoot->setChild(1, right);
+    newRoot->setSize(1);
+    root.store(newRoot, std::memory_order_release);
+}
+
+template <typename Key, typename Value, typename Compare>
+bool ConcurrentBPTree<Key, Value, Compare>::removeKey(const Key& key) {
+    EpochManager::Guard guard(epochs);
+    bool removed = false;
+    for (int attempt = 0; !tryRemove(key, removed); attempt++) backoff(attempt);
+    return removed;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool ConcurrentBPTree<Key, Value, Compare>::tryRemove(const Key& key, bool& removed) {
+    Path path;
+    Node* leaf;
+    std::uint64_t leafVersion;
+    if (!descend(key, &path, leaf, leafVersion)) return false;
+    if (!leaf->latch.tryUpgrade(leafVersion)) return false;
+    LatchSet held;
+    held.add(leaf);
+
+    int size = leaf->getSize();
+    int pos = lowerBound(leaf, size, key);
+    if (pos == size || !equal(leaf->keys()[pos], key)) {
+        release(held);
+        removed = false;
+        return true;
+    }
+
+    /*
+		Lock what the rebalancing is going to touch before touching anything, making the same
+		choices rebalance() will: the parent of an underflowing node, its left sibling and, if that
+		one cannot lend, its right sibling. A borrow ends it, a merge takes a key from the parent,
+		which may underflow in turn. The root leaf may run empty, the root itself only collapses.
+	*/
+    Node* cursor = leaf;
+    int minKeys = minLeafKeys();
+    for (int level = path.depth - 1; level >= 0 && cursor->getSize() - 1 < minKeys; level--) {
+        const PathStep& step = path.steps[level];
+        Node* parent = step.node;
+        if (!parent->latch.tryUpgrade(step.version)) {
+            release(held);
+            return false;
+        }
+        held.add(parent);
+
+        Node* left = step.child > 0 ? parent->child(step.child - 1) : nullptr;
+        Node* right = step.child < parent->getSize() ? parent->child(step.child + 1) : nullptr;
+        bool lends = false;
+        for (Node* sibling : {left, right}) {
+            if (sibling == nullptr) continue;
+            if (!sibling->latch.tryLock()) {
+                release(held);
+                return false;
+            }
+            held.add(sibling);
+            if (sibling->getSize() > minKeys) {
+                lends = true;
+                break;
+            }
+        }
+        if (lends) break;
+
+        if (level == 0 && parent->getSize() == 1) {  // the merge empties the root, the tree shrinks a level
+            if (!rootLatch.tryUpgrade(path.rootVersion)) {
+                release(held);
+                return false;
+            }
+            held.rootLatch = &rootLatch;
+            break;
+        }
+        cursor = parent;
+        minKeys = minInternalKeys();
+    }
+
+    Key* keys = leaf->keys();
+    Value* values = leaf->values();
+    for (int i = pos; i < size - 1; i++) {
+        keys[i] = keys[i + 1];
+        values[i] = values[i + 1];
+    }
+    leaf->setSize(size - 1);
+    rebalance(leaf, path, held);
+
+    release(held);
+    count.fetch_sub(1, std::memory_order_relaxed);
+    removed = true;
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::rebalance(Node* cursor, Path& path, LatchSet& held) {
+    /*
+		BasicBPTree::removeKey/removeInternal for one level after the other: borrow from the left
+		sibling, else from the right one, else merge into the left one, else merge the right one
+		in. Merged-away nodes are dropped from the LatchSet, release() retires them.
+	*/
+    while (path.depth > 0) {
+        const int minKeys = cursor->isLeaf ? minLeafKeys() : minInternalKeys();
+        int size = cursor->getSize();
+        if (size >= minKeys) return;
+
+        PathStep step = path.steps[--path.depth];
+        Node* parent = step.node;
+        int pos = step.child;
+        Node* left = pos > 0 ? parent->child(pos - 1) : nullptr;
+        Node* right = pos < parent->getSize() ? parent->child(pos + 1) : nullptr;
+        Key* keys = cursor->keys();
+
+        if (left != nullptr && left->getSize() > minKeys) {
+            // Make room at the front of cursor for the largest entry of the left sibling
+            int leftSize = left->getSize();
+            if (cursor->isLeaf) {
+                std::copy_backward(keys, keys + size, keys + size + 1);
+                std::copy_backward(cursor->values(), cursor->values() + size, cursor->values() + size + 1);
+                keys[0] = left->keys()[leftSize - 1];
+                cursor->values()[0] = left->values()[leftSize - 1];
+                parent->keys()[pos - 1] = keys[0];
+            } else {
+                std::copy_backward(keys, keys + size, keys + size + 1);
+                Node::copyChildren(cursor, 0, size + 1, cursor, 1);
+                keys[0] = parent->keys()[pos - 1];
+                parent->keys()[pos - 1] = left->keys()[leftSize - 1];
+                cursor->setChild(0, left->child(leftSize));
+            }
+            cursor->setSize(size + 1);
+            left->setSize(leftSize - 1);
+            return;
+        }
+
+        if (right != nullptr && right->getSize() > minKeys) {
+            // Append the smallest entry of the right sibling
+            int rightSize = right->getSize();
+            if (cursor->isLeaf) {
+                keys[size] = right->keys()[0];
+                cursor->values()[size] = right->values()[0];
+                std::copy(right->keys() + 1, right->keys() + rightSize, right->keys());
+                std::copy(right->values() + 1, right->values() + rightSize, right->values());
+                parent->keys()[pos] = right->keys()[0];
+            } else {
+                keys[size] = parent->keys()[pos];
+                parent->keys()[pos] = right->keys()[0];
+                cursor->setChild(size + 1, right->child(0));
+                std::copy(right->keys() + 1, right->keys() + rightSize, right->keys());
+                Node::copyChildren(right, 1, rightSize + 1, right, 0);
+            }
+            cursor->setSize(size + 1);
+            right->setSize(rightSize - 1);
+            return;
+        }
+
+        // Merge: everything of the right node moves into the left one, the right one leaves the tree
+        Node* into = left != nullptr ? left : cursor;
+        Node* from = left != nullptr ? cursor : right;
+        int fromIdx = left != nullptr ? pos : pos + 1;
+        int intoSize = into->getSize();
+        int fromSize = from->getSize();
+        if (into->isLeaf) {
+            std::copy(from->keys(), from->keys() + fromSize, into->keys() + intoSize);
+            std::copy(from->values(), from->values() + fromSize, into->values() + intoSize);
+            into->setSize(intoSize + fromSize);
+            into->setNext(from->getNext());
+        } else {
+            into->keys()[intoSize] = parent->keys()[fromIdx - 1];
+            std::copy(from->keys(), from->keys() + fromSize, into->keys() + intoSize + 1);
+            Node::copyChildren(from, 0, fromSize + 1, into, intoSize + 1);
+            into->setSize(intoSize + fromSize + 1);
+        }
+        removeChild(parent, fromIdx);
+        held.drop(from);
+
+        if (path.depth == 0) {
+            if (parent->getSize() == 0) {  // the root lost its last separator
+                root.store(parent->child(0), std::memory_order_release);
+                held.drop(parent);
+            }
+            return;
+        }
+        cursor = parent;
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::removeChild(Node* parent, int childIdx) {
+    Key* keys = parent->keys();
+    int size = parent->getSize();
+    std::copy(keys + childIdx, keys + size, keys + childIdx - 1);
+    Node::copyChildren(parent, childIdx + 1, size + 1, parent, childIdx);
+    parent->setSize(size - 1);
+}
+
+template <typename Key, typename Value, typename Compare>
+void ConcurrentBPTree<Key, Value, Compare>::release(LatchSet& held) {
+    int dropped = 0;
+    for (int i = 0; i < held.count; i++) {
+        if (held.obsolete[i]) {
+            held.nodes[i]->latch.unlockObsolete();
+            dropped++;
+        } else {
+            held.nodes[i]->latch.unlock();
+        }
+    }
+    if (held.rootLatch != nullptr) held.rootLatch->unlock();
+
+    // Unlinked and marked obsolete first, so no reader that starts from now on can get there
+    if (dropped > 0) {
+        for (int i = 0; i < held.count; i++)
+            if (held.obsolete[i]) epochs.retire(held.nodes[i], [](void* node) { Node::destroy(static_cast<Node*>(node)); });
+    }
+}
+
+}  // namespace bptree
@@ -0,0 +1,571 @@
+#pragma once
+
+// Member definitions of DiskBPTree, included from bptree/disk_bptree.hpp
+
+#include <stdexcept>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare>
+DiskBPTree<Key, Value, Compare>::DiskBPTree(const std::string& path, const DiskOptions& options)
+    : file(path, options.pageSize), pool(file, options.poolPages, options.eviction) {
+    /*
+		A descent never pins more than three pages at once (node, parent, sibling), the rest of the
+		pool is cache. A fresh file takes its limits from the page size or from options, a reopened
+		one reads them back from the header together with the root.
+	*/
+    if (options.poolPages < 8) throw std::invalid_argument("a disk tree needs a pool of at least 8 pages");
+
+    if (file.isNew()) {
+        const std::size_t pageSize = file.getPageSize();
+        int leafFit = 0;  // #of key/value slots a leaf page holds
+        while (leafFit < MAX_PAGE_KEYS &&
+               valuesOffset(leafFit + 1) + (leafFit + 1) * sizeof(Value) <= pageSize)
+            leafFit++;
+        int internalFit = 0;  // #of key slots an internal page holds, with one child more
+        while (internalFit < MAX_PAGE_KEYS &&
+               childrenOffset(internalFit + 1) + (internalFit + 2) * sizeof(PageId) <= pageSize)
+            internalFit++;
+
+        maxLeafNodeLimit = options.maxLeafNodeLimit != 0 ? options.maxLeafNodeLimit : leafFit - 1;
+        maxIntChildLimit = options.maxIntChildLimit != 0 ? options.maxIntChildLimit : internalFit;
+        if (maxLeafNodeLimit < 3 || maxIntChildLimit < 3 || maxLeafNodeLimit >= leafFit ||
+            maxIntChildLimit > internalFit)
+            throw std::invalid_argument(
+                "node limits must be at least 3 and fit a page of at most 65535 keys");
+
+        root = INVALID_PAGE;
+        count = 0;
+        file.setMeta(META_SIGNATURE, signature());
+        saveMeta();
+    } else {
+        if (file.getMeta(META_SIGNATURE) != signature())
+            throw std::runtime_error("index file " + path + " holds other key/value types");
+        root = static_cast<PageId>(file.getMeta(META_ROOT));
+        maxIntChildLimit = static_cast<int>(file.getMeta(META_INT_LIMIT));
+        maxLeafNodeLimit = static_cast<int>(file.getMeta(META_LEAF_LIMIT));
+        count = file.getMeta(META_SIZE);
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+DiskBPTree<Key, Value, Compare>::~DiskBPTree() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Call flush() first to see write errors
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+std::uint64_t DiskBPTree<Key, Value, Compare>::signature() {
+    // Tells a file of this tree from any other page file, and from one written with other types
+    return (std::uint64_t{0x4454} << 48) | (std::uint64_t{sizeof(Key)} << 24) | std::uint64_t{sizeof(Value)};
+}
+
+template <typename Key, typename Value, typename Compare>
+void DiskBPTree<Key, Value, Compare>::saveMeta() {
+    file.setMeta(META_ROOT, root);
+    file.setMeta(META_INT_LIMIT, static_cast<std::uint64_t>(maxIntChildLimit));
+    file.setMeta(META_LEAF_LIMIT, static_cast<std::uint64_t>(maxLeafNodeLimit));
+    file.setMeta(META_SIZE, count);
+}
+
+template <typename Key, typename Value, typename Compare>
+void DiskBPTree<Key, Value, Compare>::flush() {
+    saveMeta();
+    pool.flush();
+}
+
+template <typename Key, typename Value, typename Compare>
+std::uint64_t DiskBPTree<Key, Value, Compare>::size() const {
+    return count;
+}
+
+template <typename Key, typename Value, typename Compare>
+PageId DiskBPTree<Key, Value, Compare>::getRoot() const {
+    return root;
+}
+
+template <typename Key, typename Value, typename Compare>
+int DiskBPTree<Key, Value, Compare>::getMaxIntChildLimit() const {
+    return maxIntChildLimit;
+}
+
+template <typename Key, typename Value, typename Compare>
+int DiskBPTree<Key, Value, Compare>::getMaxLeafNodeLimit() const {
+    return maxLeafNodeLimit;
+}
+
+template <typename Key, typename Value, typename Compare>
+BufferPool& DiskBPTree<Key, Value, Compare>::getPool() {
+    return pool;
+}
+
+template <typename Key, typename Value, typename Compare>
+PageFile& DiskBPTree<Key, Value, Compare>::getFile() {
+    return file;
+}
+
+template <typename Key, typename Value, typename Compare>
+int DiskBPTree<Key, Value, Compare>::upperBound(const PageGuard& page, const Key& key) const {
+    const Key* k = keys(page);
+    int n = header(page)->size;
+    if constexpr (simd::SUPPORTED<Key, Compare>)
+        return simd::upperBound(k, n, key);
+    else
+        return static_cast<int>(std::upper_bound(k, k + n, key, comp) - k);
+}
+
+template <typename Key, typename Value, typename Compare>
+int DiskBPTree<Key, Value, Compare>::lowerBound(const PageGuard& page, const Key& key) const {
+    const Key* k = keys(page);
+    int n = header(page)->size;
+    if constexpr (simd::SUPPORTED<Key, Compare>)
+        return simd::lowerBound(k, n, key);
+    else
+        return static_cast<int>(std::lower_bound(k, k + n, key, comp) - k);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename DiskBPTree<Key, Value, Compare>::PageGuard DiskBPTree<Key, Value, Compare>::newPage(bool isLeaf) {
+    PageGuard page = pool.create();
+    header(page)->isLeaf = isLeaf;
+    header(page)->size = 0;
+    header(page)->next = INVALID_PAGE;
+    return page;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename DiskBPTree<Key, Value, Compare>::PageGuard DiskBPTree<Key, Value, Compare>::descend(const Key& key, Path& path) {
+    // Only the page we stand on is pinned, the path keeps ids so parents can be evicted meanwhile
+    path.depth = 0;
+    PageGuard page = pool.fetch(root);
+    while (!header(page)->isLeaf) {
+        int i = upperBound(page, key);
+        path.steps[path.depth++] = {page.id(), i};
+        page = pool.fetch(children(page)[i]);
+    }
+    return page;
+}
+
+template <typename Key, typename Value, typename Compare>
+std::optional<Value> DiskBPTree<Key, Value, Compare>::find(const Key& key) {
+    if (root == INVALID_PAGE) {
+        return std::nullopt;
+    }
+
+    PageGuard page = pool.fetch(root);
+    while (!header(page)->isLeaf) {
+        page = pool.fetch(children(page)[upperBound(page, key)]);
+    }
+
+    int idx = lowerBound(page, key);
+    if (idx == header(page)->size || !equal(keys(page)[idx], key)) {
+        return std::nullopt;
+    }
+    return values(page)[idx];
+}
+
+template <typename Key, typename Value, typename Compare>
+bool DiskBPTree<Key, Value, Compare>::contains(const Key& key) {
+    return find(key).has_value();
+}
+
+template <typename Key, typename Value, typename Compare>
+void DiskBPTree<Key, Value, Compare>::growRoot(PageId left, const Key& separator, PageId right) {
+    PageGuard page = newPage(false);
+    keys(page)[0] = separator;
+    children(page)[0] = left;
+    children(page)[1] = right;
+    header(page)->size = 1;
+    root = page.id();
+    saveMeta();
+}
+
+template <typename Key, typename Value, typename Compare>
+void DiskBPTree<Key, Value, Compare>::insert(const Key& key, const Value& value) {
+    /*
+		Same algorithm as BasicBPTree::insert: place the key in its leaf, split the leaf if it went
+		past maxLeafNodeLimit and push the first key of the new leaf up the recorded path.
+	*/
+    if (root == INVALID_PAGE) {
+        PageGuard leaf = newPage(true);
+        keys(leaf)[0] = key;
+        values(leaf)[0] = value;
+        header(leaf)->size = 1;
+        root = leaf.id();
+        count = 1;
+        saveMeta();
+        return;
+    }
+
+    Path path;
+    PageGuard leaf = descend(key, path);
+    PageHeader* h = header(leaf);
+    Key* k = keys(leaf);
+    Value* v = values(leaf);
+    int i = upperBound(leaf, key);
+    std::copy_backward(k + i, k + h->size, k + h->size + 1);
+    std::copy_backward(v + i, v + h->size, v + h->size + 1);
+    k[i] = key;
+    v[i] = value;
+    h->size++;
+    leaf.markDirty();
+    count++;
+    saveMeta();
+
+    if (h->size <= maxLeafNodeLimit) {
+        return;
+    }
+
+    //OldNode keeps the first (maxLeafNodeLimit/2 + 1) keys & values, NewNode takes the rest
+    PageGuard newLeaf = newPage(true);
+    int keep = maxLeafNodeLimit / 2 + 1;
+    std::copy(k + keep, k + h->size, keys(newLeaf));
+    std::copy(v + keep, v + h->size, values(newLeaf));
+    header(newLeaf)->size = static_cast<std::uint16_t>(h->size - keep);
+    h->size = static_cast<std::uint16_t>(keep);
+    header(newLeaf)->next = h->next;
+    h->next = newLeaf.id();
+
+    Key separator = keys(newLeaf)[0];
+    PageId left = leaf.id();
+    PageId right = newLeaf.id();
+    leaf.release();
+    newLeaf.release();
+
+    if (path.depth == 0)
+        growRoot(left, separator, right);
+    else
+        insertInternal(separator, right, path);
+}
+
+template <typename Key, typename Value, typename Compare>
+void DiskBPTree<Key, Value, Compare>::insertInternal(Key x, PageId child, Path& path) {
+    // Walk up the path: place x and its right child next to the slot we came down through, split on overflow
+    while (true) {
+        PathStep step = path.steps[--path.depth];
+        PageGuard node = pool.fetch(step.page);
+        node.markDirty();
+        PageHeader* h = header(node);
+        Key* k = keys(node);
+        PageId* c = children(node);
+        int i = step.child;
+
+        std::copy_backward(k + i, k + h->size, k + h->size + 1);
+        std::copy_backward(c + i + 1, c + h->size + 1, c + h->size + 2);
+        k[i] = x;
+        c[i + 1] = child;
+        h->size++;
+
+        if (h->size <= maxIntChildLimit - 1) {
+            return;
+        }
+
+        int partitionIdx = h->size / 2;  //right biased
+        Key partitionKey = k[partitionIdx];  //exclude middle element while splitting
+        PageGuard sibling = newPage(false);
+        std::copy(k + partitionIdx + 1, k + h->size, keys(sibling));
+        std::copy(c + partitionIdx + 1, c + h->size + 1, children(sibling));
+        header(sibling)->size = static_cast<std::uint16_t>(h->size - partitionIdx - 1);
+        h->size = static_cast<std::uint16_t>(partitionIdx);
+
+        x = partitionKey;
+        child = sibling.id();
+        if (path.depth == 0) {
+            PageId left = node.id();
+            node.release();
+            sibling.release();
+            growRoot(left, x, child);
+            return;
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+bool DiskBPTree<Key, Value, Compare>::removeKey(const Key& x) {
+    /*
+		Same algorithm as BasicBPTree::removeKey: on underflow borrow from a sibling with keys to
+		spare, else merge into the left (or the right into us), free the emptied page and remove
+		its separator from the parent.
+	*/
+    if (root == INVALID_PAGE) {
+        return false;
+    }
+
+    Path path;
+    PageGuard leaf = descend(x, path);
+    PageHeader* h = header(leaf);
+    Key* k = keys(leaf);
+    Value* v = values(leaf);
+    int pos = lowerBound(leaf, x);
+    if (pos == h->size || !equal(k[pos], x)) {
+        return false;
+    }
+
+    std::copy(k + pos + 1, k + h->size, k + pos);
+    std::copy(v + pos + 1, v + h->size, v + pos);
+    h->size--;
+    leaf.markDirty();
+    count--;
+
+    if (path.depth == 0) {
+        if (h->size == 0) {
+            // Tree becomes empty
+            PageId gone = leaf.id();
+            leaf.release();
+            pool.release(gone);
+            root = INVALID_PAGE;
+        }
+        saveMeta();
+        return true;
+    }
+    saveMeta();
+
+    const int minKeys = (maxLeafNodeLimit + 1) / 2;
+    if (h->size >= minKeys) {
+        return true;
+    }
+
+    PathStep up = path.steps[path.depth - 1];
+    PageGuard parent = pool.fetch(up.page);
+    Key* pk = keys(parent);
+    PageId* pc = children(parent);
+    int leftSibling = up.child - 1;
+    int rightSibling = up.child + 1;
+
+    //1. Try to borrow the largest key of the left sibling
+    if (leftSibling >= 0) {
+        PageGuard left = pool.fetch(pc[leftSibling]);
+        PageHeader* lh = header(left);
+        if (lh->size > minKeys) {
+            std::copy_backward(k, k + h->size, k + h->size + 1);
+            std::copy_backward(v, v + h->size, v + h->size + 1);
+            k[0] = keys(left)[lh->size - 1];
+            v[0] = values(left)[lh->size - 1];
+            h->size++;
+            lh->size--;
+            pk[leftSibling] = k[0];
+            left.markDirty();
+            parent.markDirty();
+            return true;
+        }
+    }
+
+    //2. Try to borrow the smallest key of the right sibling
+    if (rightSibling <= header(parent)->size) {
+        PageGuard right = pool.fetch(pc[rightSibling]);
+        PageHeader* rh = header(right);
+        if (rh->size > minKeys) {
+            Key* rk = keys(right);
+            Value* rv = values(right);
+            k[h->size] = rk[0];
+            v[h->size] = rv[0];
+            h->size++;
+            std::copy(rk + 1, rk + rh->size, rk);
+            std::copy(rv + 1, rv + rh->size, rv);
+            rh->size--;
+            pk[rightSibling - 1] = rk[0];
+            right.markDirty();
+            parent.markDirty();
+            return true;
+        }
+    }
+
+    //3. Merge, the page on the right of the pair is freed
+    if (leftSibling >= 0) {
+        PageGuard left = pool.fetch(pc[leftSibling]);
+        PageHeader* lh = header(left);
+        std::copy(k, k + h->size, keys(left) + lh->size);
+        std::copy(v, v + h->size, values(left) + lh->size);
+        lh->size += h->size;
+        lh->next = h->next;
+        left.markDirty();
+
+        PageId gone = leaf.id();
+        leaf.release();
+        left.release();
+        parent.release();
+        pool.release(gone);
+        removeInternal(up.child, path);
+    } else {
+        PageGuard right = pool.fetch(pc[rightSibling]);
+        PageHeader* rh = header(right);
+        std::copy(keys(right), keys(right) + rh->size, k + h->size);
+        std::copy(values(right), values(right) + rh->size, v + h->size);
+        h->size += rh->size;
+        h->next = rh->next;
+
+        PageId gone = right.id();
+        right.release();
+        leaf.release();
+        parent.release();
+        pool.release(gone);
+        removeInternal(rightSibling, path);
+    }
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+void DiskBPTree<Key, Value, Compare>::removeInternal(int childIdx, Path& path) {
+    // Walk up the path: drop children[childIdx] and the key left of it, fix underflows on the way
+    while (true) {
+        PathStep step = path.steps[--path.depth];
+        PageGuard node = pool.fetch(step.page);
+        node.markDirty();
+        PageHeader* h = header(node);
+        Key* k = keys(node);
+        PageId* c = children(node);
+
+        if (path.depth == 0 && h->size == 1) {
+            // The root is down to one child, which becomes the root
+            root = c[childIdx == 1 ? 0 : 1];
+            PageId gone = node.id();
+            node.release();
+            pool.release(gone);
+            saveMeta();
+            return;
+        }
+
+        std::copy(k + childIdx, k + h->size, k + childIdx - 1);
+        std::copy(c + childIdx + 1, c + h->size + 1, c + childIdx);
+        h->size--;
+
+        const int minKeys = (maxIntChildLimit + 1) / 2 - 1;
+        if (h->size >= minKeys || path.depth == 0) {
+            return;
+        }
+
+        PathStep up = path.steps[path.depth - 1];
+        PageGuard parent = pool.fetch(up.page);
+        Key* pk = keys(parent);
+        PageId* pc = children(parent);
+        int pos = up.child;
+        int leftSibling = pos - 1;
+        int rightSibling = pos + 1;
+
+        // Rotate a key in from the left sibling through the parent
+        if (leftSibling >= 0) {
+            PageGuard left = pool.fetch(pc[leftSibling]);
+            PageHeader* lh = header(left);
+            if (lh->size > minKeys) {
+                std::copy_backward(k, k + h->size, k + h->size + 1);
+                std::copy_backward(c, c + h->size + 1, c + h->size + 2);
+                k[0] = pk[leftSibling];
+                pk[leftSibling] = keys(left)[lh->size - 1];
+                c[0] = children(left)[lh->size];
+                h->size++;
+                lh->size--;
+                left.markDirty();
+                parent.markDirty();
+                return;
+            }
+        }
+
+        // Rotate a key in from the right sibling through the parent
+        if (rightSibling <= header(parent)->size) {
+            PageGuard right = pool.fetch(pc[rightSibling]);
+            PageHeader* rh = header(right);
+            if (rh->size > minKeys) {
+                Key* rk = keys(right);
+                PageId* rc = children(right);
+                k[h->size] = pk[pos];
+                pk[pos] = rk[0];
+                c[h->size + 1] = rc[0];
+                h->size++;
+                std::copy(rk + 1, rk + rh->size, rk);
+                std::copy(rc + 1, rc + rh->size + 1, rc);
+                rh->size--;
+                right.markDirty();
+                parent.markDirty();
+                return;
+            }
+        }
+
+        // Merge: left + parent key + right, then the parent loses the right one of the pair
+        if (leftSibling >= 0) {
+            PageGuard left = pool.fetch(pc[leftSibling]);
+            PageHeader* lh = header(left);
+            keys(left)[lh->size] = pk[leftSibling];
+            std::copy(k, k + h->size, keys(left) + lh->size + 1);
+            std::copy(c, c + h->size + 1, children(left) + lh->size + 1);
+            lh->size += h->size + 1;
+            left.markDirty();
+
+            PageId gone = node.id();
+            node.release();
+            left.release();
+            parent.release();
+            pool.release(gone);
+            childIdx = pos;
+        } else {
+            PageGuard right = pool.fetch(pc[rightSibling]);
+            PageHeader* rh = header(right);
+            k[h->size] = pk[rightSibling - 1];
+            std::copy(keys(right), keys(right) + rh->size, k + h->size + 1);
+            std::copy(children(right), children(right) + rh->size + 1, c + h->size + 1);
+            h->size += rh->size + 1;
+
+            PageId gone = right.id();
+            right.release();
+            node.release();
+            parent.release();
+            pool.release(gone);
+            childIdx = rightSibling;
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename Visitor>
+void DiskBPTree<Key, Value, Compare>::scan(const Key& lo, const Key& hi, Visitor&& visit) {
+    /*
+		One descent to lo, then along the next-leaf ids with one page pinned at a time. The visitor
+		sees references into the pinned page and must not modify the tree.
+	*/
+    if (root == INVALID_PAGE) {
+        return;
+    }
+
+    PageGuard page = pool.fetch(root);
+    while (!header(page)->isLeaf) {
+        page = pool.fetch(children(page)[lowerBound(page, lo)]);
+    }
+
+    int i = lowerBound(page, lo);
+    while (true) {
+        const PageHeader* h = header(page);
+        for (; i < h->size; i++) {
+            if (!comp(keys(page)[i], hi)) return;
+            visit(static_cast<const Key&>(keys(page)[i]), static_cast<const Value&>(values(page)[i]));
+        }
+        if (h->next == INVALID_PAGE) return;
+        page = pool.fetch(h->next);
+        i = 0;
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename Visitor>
+void DiskBPTree<Key, Value, Compare>::forEach(Visitor&& visit) {
+    if (root == INVALID_PAGE) {
+        return;
+    }
+
+    PageGuard page = pool.fetch(root);
+    while (!header(page)->isLeaf) {
+        page = pool.fetch(children(page)[0]);
+    }
+
+    while (true) {
+        const PageHeader* h = header(page);
+        for (int i = 0; i < h->size; i++) {
+            visit(static_cast<const Key&>(keys(page)[i]), static_cast<const Value&>(values(page)[i]));
+        }
+        if (h->next == INVALID_PAGE) return;
+        page = pool.fetch(h->next);
+    }
+}
+
+}  // namespace bptree
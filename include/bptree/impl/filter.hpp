@@ -0,0 +1,105 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+#include <stdexcept>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::enableFilter(int bitsPerKey) {
+    /*
+		A BloomFilter over std::hash of every key: find, contains and removeKey ask it first and
+		return right away for a key it has never seen. insert, multiInsert, bulkLoad and open keep
+		it up to date (the last two, and enableFilter itself, by reading every key once).
+
+		Removed keys cannot be taken out of a Bloom filter, they only make it answer "maybe"
+		more often. Once half of the keys it holds are stale, or it holds more keys than it was
+		sized for, it is built again from the tree, for the keys present plus half as many
+		again: O(n) every O(n) updates. Keys equal under Compare have to hash alike, which is
+		what std::less and std::hash give.
+	*/
+    static_assert(detail::HASHABLE<Key>, "the filter hashes keys with std::hash");
+    if (bitsPerKey < 1) throw std::invalid_argument("a filter needs at least one bit per key");
+    filterStats = FilterStats();
+    rebuildFilter(bitsPerKey);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::disableFilter() {
+    filter.reset();
+    filterStats = FilterStats();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+FilterStats BasicBPTree<Key, Value, Compare, Fanout>::getFilterStats() const {
+    FilterStats current = filterStats;
+    if (filter != NULL) {
+        current.bytes = filter->bytes();
+        current.bitsPerKey = filter->getBitsPerKey();
+        current.capacity = filter->capacity();
+    }
+    return current;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::uint64_t BasicBPTree<Key, Value, Compare, Fanout>::keyHash(const Key& key) {
+    return BloomFilter::mix(static_cast<std::uint64_t>(std::hash<Key>()(key)));
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::filterRejects(const Key& key) const {
+    if constexpr (detail::HASHABLE<Key>) {
+        if (filter != NULL && !filter->mayContain(keyHash(key))) {
+            if constexpr (TRACING) filterStats.rejected++;
+            return true;
+        }
+    } else {
+        (void)key;
+    }
+    return false;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::filterMissed() const {
+    if constexpr (TRACING) {
+        if (filter != NULL) filterStats.falsePositives++;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::filterAdd(const Key& key) {
+    if constexpr (detail::HASHABLE<Key>) {
+        if (filterStats.keys >= filter->capacity()) rebuildFilter(filter->getBitsPerKey());
+        filter->add(keyHash(key));
+        filterStats.keys++;
+    } else {
+        (void)key;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::filterRemoved(std::uint64_t keys) {
+    filterStats.staleKeys += keys;
+    if (filterStats.staleKeys * 2 > filterStats.keys) rebuildFilter(filter->getBitsPerKey());
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::rebuildFilter(int bitsPerKey) {
+    if constexpr (detail::HASHABLE<Key>) {
+        const BasicBPTree& tree = *this;
+        std::vector<std::uint64_t> hashes;
+        for (ConstIterator it = tree.begin(); it != tree.end(); ++it) hashes.push_back(keyHash(it.key()));
+
+        const std::uint64_t keys = hashes.size();
+        filter = std::make_unique<BloomFilter>(std::max(keys + keys / 2, MIN_FILTER_KEYS), bitsPerKey);
+        for (std::uint64_t hash : hashes) filter->add(hash);
+        filterStats.keys = keys;
+        filterStats.staleKeys = 0;
+        filterStats.rebuilds++;
+    } else {
+        (void)bitsPerKey;
+    }
+}
+
+}  // namespace bptree
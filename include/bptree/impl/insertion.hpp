@@ -0,0 +1,204 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::insert(const Key& key, const Value& value) {  //in Leaf Node
+    /*
+		1. If the node has an empty space, insert the key/reference pair into the node.
+		2. If the node is already full, split it into two nodes, distributing the keys
+		evenly between the two nodes. If the node is a leaf, take a copy of the minimum
+		value in the second of these two nodes and repeat this insertion algorithm to
+		insert it into the parent node. If the node is a non-leaf, exclude the middle
+		value during the split and repeat this insertion algorithm to insert this excluded
+		value into the parent node.
+	*/
+    if (filter != NULL) filterAdd(key);
+
+    if (root == NULL) {
+        root = newNode(true);
+        root->keys()[0] = key;
+        root->dataPtr()[0] = value;
+        root->size = 1;
+
+        tailLeaf = root;
+        trace(TreeEvent::ROOT_CREATED, key);
+        return;
+    }
+
+    /*
+		::Appends:= a key at or past the largest one goes to the rightmost leaf, which the last
+		insert that reached it is still holding. While that leaf has room it cannot split, so the
+		path is never needed and the descent is skipped.
+	*/
+    Path path;
+    if (tailLeaf != NULL && tailLeaf->next() == NULL && tailLeaf->size > 0 && tailLeaf->size < getMaxLeafNodeLimit() &&
+        !leafKeyAbove(tailLeaf, tailLeaf->size - 1, key)) {
+        if constexpr (TRACING) {
+            stats.nodeVisits++;
+            stats.appends++;
+        }
+        insertIntoLeaf(tailLeaf, key, value, path);
+        return;
+    }
+
+    //searching for the possible position for the given key by doing the same procedure we did in search
+    Node* cursor = descend(key, path);
+    if (cursor->next() == NULL) tailLeaf = cursor;  // a split moves it on to the new leaf
+    insertIntoLeaf(cursor, key, value, path);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::insertIntoLeaf(Node* cursor, const Key& key, const Value& value, Path& path) {
+    /*
+		Every node keeps one spare slot, so the key always fits in place first. If that pushed
+		the leaf past maxLeafNodeLimit we split it afterwards.
+	*/
+    Key* keys = cursor->keys();
+    Value* dataPtr = cursor->dataPtr();
+    int i = upperBound(cursor, key);
+    fitPrefix(cursor, key);
+    for (int j = cursor->size; j > i; j--) {  // shifting the position for keys and datapointer
+        keys[j] = std::move(keys[j - 1]);
+        dataPtr[j] = std::move(dataPtr[j - 1]);
+    }
+    storeLeafKey(cursor, i, key);
+    dataPtr[i] = value;
+    cursor->size++;
+
+    if (cursor->size <= getMaxLeafNodeLimit()) {
+        trace(TreeEvent::LEAF_INSERT, key);
+        return true;
+    }
+
+    /*
+		DAMN!! Node Overflowed :(
+		HAIYYA! Splitting the Node .
+	*/
+
+    /*
+		BAZINGA! I have the power to create new Leaf :)
+	*/
+    Node* newLeaf = newNode(true);
+
+    //swapping the next ptr
+    Node* temp = cursor->next();
+    cursor->ptr2next = newLeaf;
+    newLeaf->ptr2next = temp;
+    if (temp == NULL) tailLeaf = newLeaf;
+
+    /*
+		OldNode keeps the first (maxLeafNodeLimit/2 + 1) keys & dataPtr, NewNode takes the rest.
+		A key appended past the end of the rightmost leaf splits 100/0 instead: the old leaf stays
+		full and the new one starts with the key alone, so ascending inserts fill every leaf they
+		leave behind. Only that new leaf sits below half, until the next appends arrive.
+	*/
+    const bool appending = temp == NULL && i == cursor->size - 1;
+    int keep = appending ? cursor->size - 1 : getMaxLeafNodeLimit() / 2 + 1;  //check +1 or not while partitioning
+    std::move(keys + keep, keys + cursor->size, newLeaf->keys());
+    std::move(dataPtr + keep, dataPtr + cursor->size, newLeaf->dataPtr());
+    newLeaf->size = cursor->size - keep;
+    cursor->size = keep;
+    if constexpr (PREFIX_COMPRESSION) newLeaf->prefix() = cursor->prefix();
+    compactPrefix(cursor);  // each half may share more than the two did together
+    compactPrefix(newLeaf);
+
+    // Anything between the halves routes the same, the shortest such key is pushed up
+    const Key separatorKey = leafSeparator(cursor, newLeaf);
+    trace(TreeEvent::LEAF_SPLIT, separatorKey);
+
+    if (cursor == root) {
+        /*
+			If cursor is root node we create new node
+		*/
+
+        Node* newRoot = newNode(false);
+        newRoot->keys()[0] = separatorKey;
+        newRoot->ptr2Tree()[0] = cursor;
+        newRoot->ptr2Tree()[1] = newLeaf;
+        newRoot->size = 1;
+        root = newRoot;
+        trace(TreeEvent::ROOT_SPLIT, newRoot->keys()[0]);
+    } else {
+        // Insert new key in the parent
+        insertInternal(separatorKey, newLeaf, path);
+    }
+    return false;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::insertInternal(const Key& x, Node* child, Path& path) {  //in Internal Nodes
+    /*
+		Place x and its right child in the node first (the spare slot makes room for one
+		overflowing key), then split if the node now holds more than maxIntChildLimit-1 keys.
+		The split child sits at the slot recorded on the way down, so its new sibling goes right
+		after it; searching for x instead would misplace it among equal keys.
+		On the right edge of the tree a split of the last child is what appends cause: the node
+		keeps all but one key and its last two children, 100/0 as far as an internal node with two
+		children can go, and the rest of the appends fill the new one.
+	*/
+    PathStep step = path.steps[--path.depth];
+    Node* cursor = step.node;
+    Key* keys = cursor->keys();
+    Node** ptr2Tree = cursor->ptr2Tree();
+    int i = step.child;
+
+    // Different loops because size is different for both (i.e. diff of one)
+    for (int j = cursor->size; j > i; j--) {  // shifting the position for keys and datapointer
+        keys[j] = std::move(keys[j - 1]);
+    }
+    for (int j = cursor->size + 1; j > (i + 1); j--) {
+        ptr2Tree[j] = ptr2Tree[j - 1];
+    }
+    keys[i] = x;
+    ptr2Tree[i + 1] = child;
+    cursor->size++;
+
+    if (cursor->size <= getMaxIntChildLimit() - 1) {
+        trace(TreeEvent::INTERNAL_INSERT, x);
+    } else {  //splitting
+        int partitionIdx = cursor->size / 2;    //right biased
+        if (i == cursor->size - 1 && onRightEdge(path)) partitionIdx = std::max(partitionIdx, cursor->size - 2);
+        Key partitionKey = keys[partitionIdx];  //exclude middle element while splitting
+        trace(TreeEvent::INTERNAL_SPLIT, partitionKey);
+
+        Node* newInternalNode = newNode(false);
+
+        //Moving the keys & TreePtr right of the partition to NewNode
+        std::move(keys + partitionIdx + 1, keys + cursor->size, newInternalNode->keys());
+        // because only key is excluded not the pointer
+        for (int j = partitionIdx + 1; j <= cursor->size; j++) newInternalNode->ptr2Tree()[j - partitionIdx - 1] = cursor->child(j);
+        newInternalNode->size = cursor->size - partitionIdx - 1;
+        cursor->size = partitionIdx;
+
+        if (cursor == root) {
+            /*
+				If cursor is a root we create a new Node
+			*/
+            Node* newRoot = newNode(false);
+            newRoot->keys()[0] = partitionKey;
+            newRoot->ptr2Tree()[0] = cursor;
+            newRoot->ptr2Tree()[1] = newInternalNode;
+            newRoot->size = 1;
+
+            root = newRoot;
+            trace(TreeEvent::ROOT_SPLIT, partitionKey);
+        } else {
+            /*
+				::Recursion:: the parent is the next step up the path
+			*/
+            insertInternal(partitionKey, newInternalNode, path);
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::onRightEdge(const Path& path) const {
+    for (int d = 0; d < path.depth; d++)
+        if (path.steps[d].child != path.steps[d].node->size) return false;
+    return true;
+}
+
+}  // namespace bptree
@@ -0,0 +1,147 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+#include <string_view>
+
+namespace bptree {
+
+/*
+	String keys ordered by std::less get two kinds of compression, every other key type gets
+	neither and the helpers below reduce to plain key accesses:
+
+	::Suffix truncation:=
+		A leaf split (or borrow, or bulkLoad) pushes up the shortest string s with
+		leftMax < s <= rightMin instead of the whole of rightMin. Any such s routes every key to
+		the same leaf, and a short separator stays in the string's inline buffer, so internal
+		nodes are searched without chasing a heap pointer per key.
+
+	::Prefix compression:=
+		A leaf keeps the prefix all of its keys share once, in Node::prefix(), and keys() hold
+		only the rest. Inserting a key that does not start with the prefix shortens it, a split
+		or borrow lengthens it again to what the remaining keys share (compactPrefix). A search
+		compares the key against the prefix once and then only the suffixes.
+*/
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::LeafKey BasicBPTree<Key, Value, Compare, Fanout>::leafKey(const Node* leaf, int idx) const {
+    if constexpr (PREFIX_COMPRESSION)
+        return leaf->prefix() + leaf->keys()[idx];
+    else
+        return leaf->keys()[idx];
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+int BasicBPTree<Key, Value, Compare, Fanout>::compareLeafKey(const Node* leaf, int idx, const Key& key) const {
+    // Sign of leafKey(leaf, idx) - key, without putting the key together
+    if constexpr (PREFIX_COMPRESSION) {
+        std::string_view whole(key), prefix(leaf->prefix());
+        if (int c = whole.compare(0, prefix.size(), prefix); c != 0) return -c;
+        return std::string_view(leaf->keys()[idx]).compare(whole.substr(prefix.size()));
+    } else {
+        return comp(leaf->keys()[idx], key) ? -1 : comp(key, leaf->keys()[idx]) ? 1 : 0;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::leafKeyEquals(const Node* leaf, int idx, const Key& key) const {
+    if constexpr (PREFIX_COMPRESSION)
+        return compareLeafKey(leaf, idx, key) == 0;
+    else
+        return equal(leaf->keys()[idx], key);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::leafKeyAbove(const Node* leaf, int idx, const Key& key) const {
+    if constexpr (PREFIX_COMPRESSION)
+        return compareLeafKey(leaf, idx, key) > 0;
+    else
+        return comp(key, leaf->keys()[idx]);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+int BasicBPTree<Key, Value, Compare, Fanout>::leafBound(const Node* leaf, const Key& key, bool upper) const {
+    // A key outside the prefix sorts before or after the whole leaf, otherwise only suffixes are compared
+    if constexpr (PREFIX_COMPRESSION) {
+        std::string_view whole(key), prefix(leaf->prefix());
+        if (int c = whole.compare(0, prefix.size(), prefix); c != 0) return c < 0 ? 0 : leaf->size;
+        const std::string_view rest = whole.substr(prefix.size());
+        const Key* keys = leaf->keys();
+        countComparisons(leaf->size);
+        if (upper)
+            return std::upper_bound(keys, keys + leaf->size, rest,
+                                    [](std::string_view a, const Key& b) { return a < std::string_view(b); }) - keys;
+        return std::lower_bound(keys, keys + leaf->size, rest,
+                                [](const Key& a, std::string_view b) { return std::string_view(a) < b; }) - keys;
+    } else {
+        return upper ? upperBound(leaf, key) : lowerBound(leaf, key);
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::storeLeafKey(Node* leaf, int idx, const Key& key) {
+    if constexpr (PREFIX_COMPRESSION)
+        leaf->keys()[idx].assign(key, leaf->prefix().size());
+    else
+        leaf->keys()[idx] = key;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::fitPrefix(Node* leaf, const Key& key) {
+    if constexpr (PREFIX_COMPRESSION) {
+        Key& prefix = leaf->prefix();
+        std::size_t shared = 0;
+        while (shared < prefix.size() && shared < key.size() && prefix[shared] == key[shared]) shared++;
+        if (shared == prefix.size()) return;
+
+        // The part of the prefix the key does not share goes back in front of every stored key
+        const std::string_view lost = std::string_view(prefix).substr(shared);
+        for (int i = 0; i < leaf->size; i++) leaf->keys()[i].insert(0, lost);
+        prefix.resize(shared);
+    } else {
+        (void)leaf;
+        (void)key;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::compactPrefix(Node* leaf) {
+    // The keys are sorted, so what the first and the last share every key in between shares too
+    if constexpr (PREFIX_COMPRESSION) {
+        if (leaf->size == 0) return;
+        const Key& first = leaf->keys()[0];
+        const Key& last = leaf->keys()[leaf->size - 1];
+        std::size_t shared = 0;
+        while (shared < first.size() && shared < last.size() && first[shared] == last[shared]) shared++;
+        if (shared == 0) return;
+
+        leaf->prefix().append(first, 0, shared);
+        for (int i = 0; i < leaf->size; i++) leaf->keys()[i].erase(0, shared);
+    } else {
+        (void)leaf;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+Key BasicBPTree<Key, Value, Compare, Fanout>::separator(const Key& leftMax, const Key& rightMin) const {
+    /*
+		rightMin cut right after the first character it differs from leftMax in: still above
+		leftMax, still not above rightMin. Equal keys on both sides (duplicates) leave nothing to cut.
+	*/
+    if constexpr (PREFIX_COMPRESSION) {
+        std::size_t shared = 0;
+        while (shared < leftMax.size() && shared < rightMin.size() && leftMax[shared] == rightMin[shared]) shared++;
+        if (shared < rightMin.size()) return rightMin.substr(0, shared + 1);
+        return rightMin;
+    } else {
+        (void)leftMax;
+        return rightMin;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+Key BasicBPTree<Key, Value, Compare, Fanout>::leafSeparator(const Node* left, const Node* right) const {
+    return separator(leafKey(left, left->size - 1), leafKey(right, 0));
+}
+
+}  // namespace bptree
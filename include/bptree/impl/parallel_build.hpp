@@ -0,0 +1,184 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+#include <iterator>
+#include <thread>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename RandomIt>
+void BasicBPTree<Key, Value, Compare, Fanout>::parallelBulkLoad(RandomIt first, RandomIt last, double fillFactor,
+                                                                unsigned threads) {
+    /*
+		bulkLoad for (key, value) pairs in any order, on threads threads (0: one per hardware thread):
+			1. Sort: [first, last) is cut into one run per thread and each run stable_sort-ed in place.
+			2. Partition: splitters sampled from the sorted runs cut every run in one slice per
+			thread. Partition p is slice p of every run, all of its keys sort between splitters
+			p-1 and p, and its size, so its #of leaves, is known before a leaf is written.
+			3. Leaves: every partition k-way merges its slices straight into leaves of leafFill
+			keys, linked and separated as in bulkLoad. Ties go to the earlier run, so equal keys
+			keep their input order.
+			4. Stitch: the partitions' chains are linked end to end. Only the last leaf of a
+			partition can come up short, it is folded into or evened out with the next leaf.
+			5. Internal levels: see buildLevels(), each level is built by all threads at once.
+		The runs are never merged into one array: the sort costs no extra copy of the input, and
+		[first, last) is left sorted run by run, not as a whole. Slab blocks are taken on the
+		calling thread in one go per level and filled by the workers. The tree has the shape
+		bulkLoad gives the same keys, up to where the partitions meet.
+	*/
+    using Entry = typename std::iterator_traits<RandomIt>::value_type;
+    const int maxLeaf = getMaxLeafNodeLimit();
+    const int minLeaf = (maxLeaf + 1) / 2;
+    const int leafFill = std::clamp(static_cast<int>(maxLeaf * fillFactor + 0.5), minLeaf, maxLeaf);
+    const int childFill = std::clamp(static_cast<int>(getMaxIntChildLimit() * fillFactor + 0.5),
+                                     (getMaxIntChildLimit() + 1) / 2, getMaxIntChildLimit());
+
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t parts = std::clamp<std::size_t>(n / PARALLEL_ENTRIES, 1, threads);
+    auto byKey = [this](const Entry& a, const Entry& b) { return comp(a.first, b.first); };
+
+    std::vector<RandomIt> runs(parts + 1);
+    for (std::size_t r = 0; r <= parts; r++) runs[r] = first + n * r / parts;
+    detail::parallelFor(threads, parts, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; r++) std::stable_sort(runs[r], runs[r + 1], byKey);
+    });
+
+    // SPLITTER_SAMPLES evenly spaced keys per run and partition, every parts-th of them in key order a splitter
+    std::vector<Key> samples;
+    samples.reserve(parts * parts * SPLITTER_SAMPLES);
+    for (std::size_t r = 0; r < parts; r++) {
+        const std::size_t length = runs[r + 1] - runs[r];
+        for (std::size_t s = 1; length > 0 && s <= parts * SPLITTER_SAMPLES; s++)
+            samples.push_back((runs[r] + (length * s - 1) / (parts * SPLITTER_SAMPLES + 1))->first);
+    }
+    std::sort(samples.begin(), samples.end(), comp);
+
+    // slices[r * (parts + 1) + p]: where partition p starts in run r
+    std::vector<RandomIt> slices((parts + 1) * parts);
+    std::vector<std::size_t> leafStart(parts + 1, 0);  // of partition p in blocks
+    for (std::size_t r = 0; r < parts; r++) {
+        RandomIt* cut = &slices[r * (parts + 1)];
+        cut[0] = runs[r];
+        cut[parts] = runs[r + 1];
+        for (std::size_t p = 1; p < parts; p++) {
+            const Key& splitter = samples[samples.size() * p / parts];
+            cut[p] = std::lower_bound(cut[p - 1], runs[r + 1], splitter,
+                                      [this](const Entry& entry, const Key& key) { return comp(entry.first, key); });
+        }
+    }
+    for (std::size_t p = 0; p < parts; p++) {
+        std::size_t size = 0;
+        for (std::size_t r = 0; r < parts; r++) size += slices[r * (parts + 1) + p + 1] - slices[r * (parts + 1) + p];
+        leafStart[p + 1] = leafStart[p] + (size + leafFill - 1) / leafFill;
+    }
+    std::vector<Node*> blocks(leafStart[parts]);
+    for (Node*& block : blocks) block = static_cast<Node*>(leafSlab.allocate());
+
+    std::vector<std::vector<Key>> partSeparators(parts);  // between the leaves of one partition
+    detail::parallelFor(threads, parts, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t p = begin; p < end; p++) {
+            std::vector<RandomIt> at(parts), stop(parts);
+            std::vector<std::size_t> heap;  // runs with entries left, the next entry in key order on top
+            auto later = [&](std::size_t a, std::size_t b) {
+                if (comp(at[b]->first, at[a]->first)) return true;
+                return !comp(at[a]->first, at[b]->first) && a > b;
+            };
+            for (std::size_t r = 0; r < parts; r++) {
+                at[r] = slices[r * (parts + 1) + p];
+                stop[r] = slices[r * (parts + 1) + p + 1];
+                if (at[r] != stop[r]) heap.push_back(r);
+            }
+            std::make_heap(heap.begin(), heap.end(), later);
+
+            Node* leaf = NULL;
+            std::size_t next = leafStart[p];
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), later);
+                const std::size_t r = heap.back();
+                const Entry& entry = *at[r];
+                if (leaf == NULL || leaf->size == leafFill) {
+                    Node* newLeaf = Node::construct(blocks[next++], true, leafCapacity());
+                    if (leaf != NULL) {
+                        leaf->ptr2next = newLeaf;
+                        partSeparators[p].push_back(separator(leaf->keys()[leaf->size - 1], entry.first));
+                    }
+                    leaf = newLeaf;
+                }
+                leaf->keys()[leaf->size] = entry.first;
+                leaf->dataPtr()[leaf->size] = entry.second;
+                leaf->size++;
+                if (++at[r] != stop[r]) std::push_heap(heap.begin(), heap.end(), later);
+                else heap.pop_back();
+            }
+        }
+    });
+
+    /*
+		Stitch, on this thread but only where partitions meet: a short last leaf joins the first
+		leaf of the next non-empty partition. When it takes all of it, that first leaf is dropped,
+		and the partition's first separator now divides the short leaf from the second one.
+	*/
+    std::vector<bool> dropsFirst(parts, false);
+    std::vector<Key> boundary(parts);  // separator in front of partition p, unless it drops its first leaf
+    Node* tail = NULL;
+    for (std::size_t p = 0; p < parts; p++) {
+        if (leafStart[p] == leafStart[p + 1]) continue;
+        Node* head = blocks[leafStart[p]];
+        if (tail != NULL) {
+            tail->ptr2next = head;
+            if (tail->size < minLeaf && evenLeaves(tail, head)) {
+                dropsFirst[p] = true;
+                freeNode(head);
+                if (leafStart[p + 1] - leafStart[p] == 1) continue;  // the whole partition went into tail
+            } else {
+                boundary[p] = separator(tail->keys()[tail->size - 1], head->keys()[0]);
+            }
+        }
+        tail = blocks[leafStart[p + 1] - 1];
+    }
+
+    std::vector<std::size_t> levelStart(parts + 1, 0);  // of partition p's leaves and separators in level
+    for (std::size_t p = 0; p < parts; p++)
+        levelStart[p + 1] = levelStart[p] + (leafStart[p + 1] - leafStart[p]) - (dropsFirst[p] ? 1 : 0);
+    std::vector<Node*> level(levelStart[parts]);
+    std::vector<Key> separators(level.empty() ? 0 : level.size() - 1);
+    detail::parallelFor(threads, parts, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t p = begin; p < end; p++) {
+            // A partition without leaves owns no slot: levelStart[p] is the next one's, and so is its boundary
+            if (leafStart[p] == leafStart[p + 1]) continue;
+            const std::size_t skip = dropsFirst[p] ? 1 : 0;
+            std::copy(blocks.begin() + leafStart[p] + skip, blocks.begin() + leafStart[p + 1], level.begin() + levelStart[p]);
+            // separators[i] divides level[i] from level[i + 1], a dropped first leaf takes no slot
+            if (levelStart[p] > 0 && !skip) separators[levelStart[p] - 1] = std::move(boundary[p]);
+            for (std::size_t j = 0; j < partSeparators[p].size(); j++)
+                separators[levelStart[p] + j - skip] = std::move(partSeparators[p][j]);
+        }
+    });
+
+    if (level.size() > 1 && level.back()->size < minLeaf) {
+        Node* prev = level[level.size() - 2];
+        Node* leaf = level.back();
+        if (evenLeaves(prev, leaf)) {
+            freeNode(leaf);
+            level.pop_back();
+            separators.pop_back();
+        } else {
+            separators.back() = separator(prev->keys()[prev->size - 1], leaf->keys()[0]);
+        }
+    }
+    detail::parallelFor(threads, level.size(), PARALLEL_NODES, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) compactPrefix(level[i]);
+    });
+    buildLevels(level, separators, childFill, threads);
+
+    destroyTree(root);
+    image.reset();
+    root = level.empty() ? NULL : level[0];
+    if constexpr (TRACING) stats.rootChanges++;
+    if (filter != NULL) rebuildFilter(filter->getBitsPerKey());
+}
+
+}  // namespace bptree
@@ -0,0 +1,278 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+#include <vector>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::size_t BasicBPTree<Key, Value, Compare, Fanout>::removeRange(const Key& lo, const Key& hi) {
+    return removeRange(lo, hi, [](const Key&, const Value&) {});
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename Visitor>
+std::size_t BasicBPTree<Key, Value, Compare, Fanout>::removeRange(const Key& lo, const Key& hi, Visitor&& removed) {
+    /*
+		One pass down the two edges of [lo, hi) instead of one removeKey per key:
+
+		1. In every internal node on the way, the children strictly between the one holding lo
+		   and the one holding hi lie wholly inside the range. They are freed subtree by subtree,
+		   their leaves visited once for removed() and never searched. Only the two edge children
+		   are descended into, and in the two edge leaves the keys in range are cut out.
+		2. The left edge leaf is linked straight to the right one, past every leaf freed, as soon
+		   as it is reached: the joins below may already follow its ptr2next.
+		3. Edge nodes may now be underfull, even empty. Bottom-up, each is joined with a sibling:
+		   merged if the two fit in one node, else evened out, and the children where two
+		   internal nodes met are checked again. An emptied root collapses as in removeKey.
+
+		The work is O(height * fanout) for the structure plus O(1) per removed key to free it.
+		removed(key, value) is called for every key in order, right before its node lets go of it.
+	*/
+    if (root == NULL || !comp(lo, hi)) return 0;
+
+    // The leaf the descent for hi ends in, the last one the range can reach into
+    Node* rightEdge = root;
+    while (!rightEdge->isLeaf) rightEdge = rightEdge->child(lowerBound(rightEdge, hi));
+
+    Node* leftEdge = NULL;
+    std::size_t count = removeRangeBelow(root, lo, hi, removed, Edge::BOTH, leftEdge, rightEdge);
+    shrinkRoot(lo);
+
+    if (count > 0) {
+        trace(TreeEvent::RANGE_DELETE, lo);
+        if (filter != NULL) filterRemoved(count);
+    }
+    return count;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename Visitor>
+std::size_t BasicBPTree<Key, Value, Compare, Fanout>::removeRangeBelow(Node* node, const Key& lo, const Key& hi, Visitor& removed,
+                                                                        Edge edge, Node*& leftEdge, Node* rightEdge) {
+    /*
+		Above the node where the edges part both of them go down the same child. Below it, the
+		left edge (TO_END) loses everything right of its path and the right edge (FROM_START)
+		everything left of it, so no emptied leaf is left behind between the two edge leaves.
+	*/
+    if constexpr (TRACING) stats.nodeVisits++;
+    if (node->isLeaf) {
+        if (leftEdge == NULL) {
+            leftEdge = node;
+            if (node != rightEdge) node->ptr2next = rightEdge;
+        }
+
+        int first = edge == Edge::FROM_START ? 0 : leafBound(node, lo, false);
+        int last = edge == Edge::TO_END ? node->size : leafBound(node, hi, false);
+        for (int i = first; i < last; i++) removed(static_cast<const Key&>(leafKey(node, i)), node->dataPtr()[i]);
+        int cut = last - first;
+        if (cut == 0) return 0;
+        for (int i = first; i + cut < node->size; i++) {
+            node->keys()[i] = std::move(node->keys()[i + cut]);
+            node->dataPtr()[i] = std::move(node->dataPtr()[i + cut]);
+        }
+        // Drop the references of the vacated slots, the values are not owned by the tree
+        for (int i = node->size - cut; i < node->size; i++) {
+            node->keys()[i] = Key();
+            node->dataPtr()[i] = Value();
+        }
+        node->size -= cut;
+        compactPrefix(node);
+        return cut;
+    }
+
+    // Child first holds the first copy of lo, which may sit left of a separator equal to lo; child
+    // last holds the keys just below hi
+    int first = edge == Edge::FROM_START ? 0 : lowerBound(node, lo);
+    int last = edge == Edge::TO_END ? node->size : lowerBound(node, hi);
+    if (first == last) {
+        std::size_t count = removeRangeBelow(node->child(first), lo, hi, removed, edge, leftEdge, rightEdge);
+        fixChildren(node);
+        return count;
+    }
+
+    // Children [keepLeft, keepRight) go whole: those strictly between, plus first/last on an edge of their own
+    std::size_t count = 0;
+    int keepLeft = first + 1, keepRight = last;
+    if (edge == Edge::FROM_START)
+        keepLeft = first;
+    else
+        count += removeRangeBelow(node->child(first), lo, hi, removed, Edge::TO_END, leftEdge, rightEdge);
+    if (edge == Edge::TO_END) keepRight = last + 1;
+    for (int c = keepLeft; c < keepRight; c++) count += dropSubtree(node->child(c), removed);
+    if (edge != Edge::TO_END) count += removeRangeBelow(node->child(last), lo, hi, removed, Edge::FROM_START, leftEdge, rightEdge);
+
+    /*
+		Close the gap. Between the two edge children keys[last-1] stays, it still bounds last from
+		below; a right edge keeps keys[last..] and a left edge keys[..first-1].
+	*/
+    int gone = keepRight - keepLeft;
+    if (gone > 0) {
+        int firstKey = edge == Edge::FROM_START ? 0 : first;
+        for (int i = firstKey; i + gone < node->size; i++) node->keys()[i] = std::move(node->keys()[i + gone]);
+        for (int c = keepLeft; c + gone <= node->size; c++) node->ptr2Tree()[c] = node->ptr2Tree()[c + gone];
+        for (int c = node->size - gone + 1; c <= node->size; c++) node->ptr2Tree()[c] = NULL;
+        node->size -= gone;
+    }
+    fixChildren(node);
+    return count;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename Visitor>
+std::size_t BasicBPTree<Key, Value, Compare, Fanout>::dropSubtree(Node* node, Visitor& removed) {
+    std::size_t count = 0;
+    if (node->isLeaf) {
+        for (int i = 0; i < node->size; i++) removed(static_cast<const Key&>(leafKey(node, i)), node->dataPtr()[i]);
+        count = node->size;
+    } else {
+        for (int c = 0; c <= node->size; c++) count += dropSubtree(node->child(c), removed);
+    }
+    freeNode(node);
+    return count;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::underfull(const Node* node) const {
+    if (node->isLeaf) return node->size < (getMaxLeafNodeLimit() + 1) / 2;
+    return node->size < (getMaxIntChildLimit() + 1) / 2 - 1;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::fixChildren(Node* node) {
+    // A lone child is left as it is, node itself is underfull then and its parent joins it
+    int c = 0;
+    while (c <= node->size && node->size > 0) {
+        if (!underfull(node->child(c))) {
+            c++;
+            continue;
+        }
+        c = c > 0 ? c - 1 : 0;
+        joinSiblings(node, c);
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::joinSiblings(Node* parent, int i) {
+    /*
+		Children i and i+1 of parent become one node if their keys fit, or else split their keys
+		evenly between them: each half has at least ceil(limit/2) entries, whatever the two had.
+	*/
+    Node* left = parent->child(i);
+    Node* right = parent->child(i + 1);
+
+    if (left->isLeaf) {
+        int total = left->size + right->size;
+        int keep = total <= getMaxLeafNodeLimit() ? total : total / 2;  // left's share
+        if (left->size < keep) {
+            // Right's smallest keys go to the back of left
+            int moved = keep - left->size;
+            fitPrefix(left, leafKey(right, 0));
+            fitPrefix(left, leafKey(right, moved - 1));
+            for (int j = 0; j < moved; j++) {
+                storeLeafKey(left, left->size, leafKey(right, j));
+                left->dataPtr()[left->size] = std::move(right->dataPtr()[j]);
+                left->size++;
+            }
+            for (int j = 0; j + moved < right->size; j++) {
+                right->keys()[j] = std::move(right->keys()[j + moved]);
+                right->dataPtr()[j] = std::move(right->dataPtr()[j + moved]);
+            }
+            right->size -= moved;
+        } else if (left->size > keep) {
+            // Left's largest keys go to the front of right
+            int moved = left->size - keep;
+            fitPrefix(right, leafKey(left, keep));
+            fitPrefix(right, leafKey(left, left->size - 1));
+            for (int j = right->size - 1; j >= 0; j--) {
+                right->keys()[j + moved] = std::move(right->keys()[j]);
+                right->dataPtr()[j + moved] = std::move(right->dataPtr()[j]);
+            }
+            for (int j = 0; j < moved; j++) {
+                storeLeafKey(right, j, leafKey(left, keep + j));
+                right->dataPtr()[j] = std::move(left->dataPtr()[keep + j]);
+            }
+            right->size += moved;
+            left->size = keep;
+        }
+        compactPrefix(left);
+
+        if (right->size == 0) {
+            left->ptr2next = right->next();
+            trace(TreeEvent::LEAF_MERGE, parent->keys()[i]);
+            removeChild(parent, i + 1);
+            freeNode(right);
+        } else {
+            compactPrefix(right);
+            parent->keys()[i] = leafSeparator(left, right);
+            trace(TreeEvent::LEAF_BORROW_RIGHT, parent->keys()[i]);
+        }
+        return;
+    }
+
+    // Internal: lay out keys and children of both with the separator between, then cut anew
+    std::vector<Key> keys;
+    std::vector<Node*> children;
+    keys.reserve(left->size + right->size + 1);
+    children.reserve(left->size + right->size + 2);
+    for (int j = 0; j < left->size; j++) keys.push_back(std::move(left->keys()[j]));
+    keys.push_back(std::move(parent->keys()[i]));
+    for (int j = 0; j < right->size; j++) keys.push_back(std::move(right->keys()[j]));
+    for (int c = 0; c <= left->size; c++) children.push_back(left->child(c));
+    for (int c = 0; c <= right->size; c++) children.push_back(right->child(c));
+
+    int total = static_cast<int>(children.size());
+    if (total <= getMaxIntChildLimit()) {
+        for (int j = 0; j < total - 1; j++) left->keys()[j] = std::move(keys[j]);
+        for (int c = 0; c < total; c++) left->ptr2Tree()[c] = children[c];
+        left->size = total - 1;
+        for (int c = 0; c <= right->size; c++) right->ptr2Tree()[c] = NULL;
+        trace(TreeEvent::INTERNAL_MERGE, left->keys()[0]);
+        removeChild(parent, i + 1);
+        freeNode(right);
+        fixChildren(left);
+        return;
+    }
+
+    int keep = total / 2;  // children of left, keys[keep-1] moves up
+    for (int j = 0; j < keep - 1; j++) left->keys()[j] = std::move(keys[j]);
+    for (int c = 0; c < keep; c++) left->ptr2Tree()[c] = children[c];
+    for (int c = keep; c <= left->size; c++) left->ptr2Tree()[c] = NULL;
+    left->size = keep - 1;
+    parent->keys()[i] = std::move(keys[keep - 1]);
+    for (int j = keep; j < total - 1; j++) right->keys()[j - keep] = std::move(keys[j]);
+    for (int c = keep; c < total; c++) right->ptr2Tree()[c - keep] = children[c];
+    right->size = total - keep - 1;
+    trace(TreeEvent::INTERNAL_BORROW_RIGHT, parent->keys()[i]);
+    fixChildren(left);
+    fixChildren(right);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::shrinkRoot(const Key& key) {
+    // Internal roots left with one child go, then an emptied root leaf
+    while (!root->isLeaf && root->size == 0) {
+        Node* old = root;
+        root = old->child(0);
+        old->ptr2Tree()[0] = NULL;
+        freeNode(old);
+        trace(TreeEvent::ROOT_COLLAPSED, key);
+    }
+    if (root->size == 0) {
+        freeNode(root);
+        root = NULL;
+        trace(TreeEvent::TREE_EMPTIED, key);
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::removeChild(Node* parent, int childIdx) {
+    // ptr2Tree()[childIdx] and the key left of it
+    for (int j = childIdx - 1; j < parent->size - 1; j++) parent->keys()[j] = std::move(parent->keys()[j + 1]);
+    for (int c = childIdx; c < parent->size; c++) parent->ptr2Tree()[c] = parent->ptr2Tree()[c + 1];
+    parent->ptr2Tree()[parent->size] = NULL;
+    parent->size--;
+}
+
+}  // namespace bptree
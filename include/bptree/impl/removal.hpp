@@ -0,0 +1,340 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::removeKey(const Key& x) {
+	if (filterRejects(x)) {
+		trace(TreeEvent::KEY_NOT_FOUND, x);
+		return false;
+	}
+	bool removed = removeEntry(x);
+	if (filter != NULL) {
+		if (removed) filterRemoved();
+		else filterMissed();
+	}
+	return removed;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::removeEntry(const Key& x) {
+	Node* root = getRoot();
+
+	// If tree is empty
+	if (root == NULL || root->size == 0) {
+		trace(TreeEvent::KEY_NOT_FOUND, x);
+		return false;
+	}
+
+	// Going to the Leaf Node, Which may contain the *key*, the path keeps the parent and our slot in it
+	Path path;
+	Node* cursor = descend(x, path);
+	Node* parent = path.depth > 0 ? path.steps[path.depth - 1].node : NULL;
+	int leftSibling = -1, rightSibling = -1;
+	if (parent != NULL) {
+		leftSibling = path.steps[path.depth - 1].child - 1;//left side of the parent node
+		rightSibling = path.steps[path.depth - 1].child + 1;// right side of the parent node
+	}
+
+	// Check if the value exists in this leaf node
+	int pos = lowerBound(cursor, x);
+	if (pos == cursor->size || !leafKeyEquals(cursor, pos, x)) {
+		trace(TreeEvent::KEY_NOT_FOUND, x);
+		return false;
+	}
+	
+	// Drop the reference, whatever the value stands for (a FILE* of the caller, an inline value, ..) is not owned by the tree
+	cursor->dataPtr()[pos] = Value();
+
+	// Shifting the keys and dataPtr for the leaf Node
+	for (int i = pos; i < cursor->size-1; i++) {
+		cursor->keys()[i] = std::move(cursor->keys()[i+1]);
+		cursor->dataPtr()[i] = std::move(cursor->dataPtr()[i + 1]);
+	}
+	cursor->size--;
+
+	// If it is leaf as well as the root node
+	trace(TreeEvent::LEAF_DELETE, x);
+	if (cursor == root) {
+		if (cursor->size == 0) {
+			// Tree becomes empty
+			setRoot(NULL);
+			freeNode(cursor);
+			trace(TreeEvent::TREE_EMPTIED, x);
+		}
+		return true;
+	}
+
+	if (cursor->size >= (getMaxLeafNodeLimit() + 1) / 2) {
+		//Sufficient Node available for invariant to hold
+		return true;
+	}
+
+	trace(TreeEvent::LEAF_UNDERFLOW, x);
+
+	// Deferred: the leaf stays as it is, queued the first time it drops below half for compact()
+	if (underflowPolicy == UnderflowPolicy::DEFERRED) {
+		if (cursor->size == (getMaxLeafNodeLimit() + 1) / 2 - 1) underfullLeaves.push_back(x);
+		else if (cursor->next() == NULL) tailUnderfull = true;  // an append split left it below half to begin with
+		return true;
+	}
+
+	//1. Try to borrow a key from leftSibling
+	if (leftSibling >= 0 && leftSibling <= parent->size) {
+		Node* leftNode = parent->child(leftSibling);
+
+		//Check if LeftSibling has extra Key to transfer
+		if (leftNode->size > (getMaxLeafNodeLimit() + 1) / 2) {
+
+			//Transfer the maximum key from the left Sibling
+			int maxIdx = leftNode->size-1;
+			LeafKey moved = leafKey(leftNode, maxIdx);
+			fitPrefix(cursor, moved);
+
+			//Make room at the front of cursor
+			for (int i = cursor->size; i > 0; i--) {
+				cursor->keys()[i] = cursor->keys()[i - 1];
+				cursor->dataPtr()[i] = cursor->dataPtr()[i - 1];
+			}
+			storeLeafKey(cursor, 0, moved);
+			cursor->dataPtr()[0] = leftNode->dataPtr()[maxIdx];
+			cursor->size++;
+
+			//resize the left Sibling Node After Tranfer
+			leftNode->size = maxIdx;
+			compactPrefix(leftNode);
+
+			//Update Parent
+			parent->keys()[leftSibling] = leafSeparator(leftNode, cursor);
+			trace(TreeEvent::LEAF_BORROW_LEFT, parent->keys()[leftSibling]);
+			return true;
+		}
+	}
+
+	//2. Try to borrow a key from rightSibling
+	if (rightSibling >= 0 && rightSibling <= parent->size) {
+		Node* rightNode = parent->child(rightSibling);
+
+		//Check if RightSibling has extra Key to transfer
+		if (rightNode->size > (getMaxLeafNodeLimit() + 1) / 2) {
+
+			//Transfer the minimum key from the right Sibling
+			int minIdx = 0;
+			LeafKey moved = leafKey(rightNode, minIdx);
+			fitPrefix(cursor, moved);
+			storeLeafKey(cursor, cursor->size, moved);
+			cursor->dataPtr()[cursor->size] = rightNode->dataPtr()[minIdx];
+			cursor->size++;
+
+			//resize the right Sibling Node After Tranfer
+			for (int i = 0; i < rightNode->size - 1; i++) {
+				rightNode->keys()[i] = rightNode->keys()[i + 1];
+				rightNode->dataPtr()[i] = rightNode->dataPtr()[i + 1];
+			}
+			rightNode->size--;
+			compactPrefix(rightNode);
+
+			//Update Parent
+			parent->keys()[rightSibling-1] = leafSeparator(cursor, rightNode);
+			trace(TreeEvent::LEAF_BORROW_RIGHT, parent->keys()[rightSibling-1]);
+			return true;
+		}
+	}
+
+	// Merge and Delete Node
+	if (leftSibling >= 0 && leftSibling <= parent->size) {// If left sibling exists
+		Node* leftNode = parent->child(leftSibling);
+		//Transfer Key and dataPtr to leftSibling and connect ptr2next
+		if (cursor->size > 0) {  // the leaf's first and last key bound what all of its keys share
+			fitPrefix(leftNode, leafKey(cursor, 0));
+			fitPrefix(leftNode, leafKey(cursor, cursor->size - 1));
+		}
+		for (int i = 0; i < cursor->size; i++) {
+			storeLeafKey(leftNode, leftNode->size, leafKey(cursor, i));
+			leftNode->dataPtr()[leftNode->size] = cursor->dataPtr()[i];
+			leftNode->size++;
+		}
+		leftNode->ptr2next = cursor->next();
+		trace(TreeEvent::LEAF_MERGE, x);
+		removeInternal(leftSibling + 1, path);//delete parent Node Key
+		freeNode(cursor);
+	}
+	else if (rightSibling >= 0 && rightSibling <= parent->size) {
+		Node* rightNode = parent->child(rightSibling);
+		//Transfer Key and dataPtr to rightSibling and connect ptr2next
+		if (rightNode->size > 0) {
+			fitPrefix(cursor, leafKey(rightNode, 0));
+			fitPrefix(cursor, leafKey(rightNode, rightNode->size - 1));
+		}
+		for (int i = 0; i < rightNode->size; i++) {
+			storeLeafKey(cursor, cursor->size, leafKey(rightNode, i));
+			cursor->dataPtr()[cursor->size] = rightNode->dataPtr()[i];
+			cursor->size++;
+		}
+		cursor->ptr2next = rightNode->next();
+		trace(TreeEvent::LEAF_MERGE, x);
+		removeInternal(rightSibling, path);//delete parent Node Key
+		freeNode(rightNode);
+	}
+
+	return true;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::removeInternal(int childIdx, Path& path) {
+	/*
+		The node on top of path lost the child at childIdx to a merge with its left neighbour, so
+		that pointer and the key separating the two go. If this underflows, the parent and our slot
+		in it are the next step up the path, no need to search the tree for them.
+	*/
+	PathStep step = path.steps[--path.depth];
+	Node* cursor = step.node;
+	Node* root = getRoot();
+	Key x = cursor->keys()[childIdx - 1];
+
+	// Check if key from root is to deleted
+	if (cursor == root && cursor->size == 1) {
+		// If only one key is left the other child becomes the root
+		setRoot(cursor->child(childIdx == 1 ? 0 : 1));
+		freeNode(cursor);
+		trace(TreeEvent::ROOT_COLLAPSED, x);
+		return;
+	}
+
+	// Deleting key x from the parent
+	for (int i = childIdx - 1; i < cursor->size - 1; i++) {
+		cursor->keys()[i] = std::move(cursor->keys()[i + 1]);
+	}
+
+	// Now deleting the ptr2tree
+	for (int i = childIdx; i < cursor->size; i++) {
+		cursor->ptr2Tree()[i] = cursor->ptr2Tree()[i + 1];
+	}
+	cursor->size--;
+
+	// If there is No underflow. Phew!!
+	trace(TreeEvent::INTERNAL_DELETE, x);
+	if (cursor->size >= (getMaxIntChildLimit() + 1) / 2 - 1) {
+		return;
+	}
+
+	trace(TreeEvent::INTERNAL_UNDERFLOW, x);
+
+	if (cursor == root) {
+		return;
+	}
+
+	Node* parent = path.steps[path.depth - 1].node;
+	int pos = path.steps[path.depth - 1].child;
+	int leftSibling = pos - 1, rightSibling = pos + 1;
+
+	// If possible transfer to leftSibling
+	if (leftSibling >= 0 && leftSibling <= parent->size) {
+		Node* leftNode = parent->child(leftSibling);
+
+		//Check if LeftSibling has extra Key to transfer
+		if (leftNode->size > (getMaxIntChildLimit() + 1) / 2 - 1) {
+
+			//Make room at the front of cursor
+			for (int i = cursor->size; i > 0; i--) {
+				cursor->keys()[i] = cursor->keys()[i - 1];
+			}
+			for (int i = cursor->size + 1; i > 0; i--) {
+				cursor->ptr2Tree()[i] = cursor->ptr2Tree()[i - 1];
+			}
+
+			//transfer key from left sibling through parent
+			int maxIdxKey = leftNode->size - 1;
+			cursor->keys()[0] = parent->keys()[leftSibling];
+			parent->keys()[leftSibling] = leftNode->keys()[maxIdxKey];
+
+			int maxIdxPtr = leftNode->size;
+			cursor->ptr2Tree()[0] = leftNode->child(maxIdxPtr);
+			cursor->size++;
+
+			//resize the left Sibling Node After Transfer
+			leftNode->size = maxIdxKey;
+
+			trace(TreeEvent::INTERNAL_BORROW_LEFT, parent->keys()[leftSibling]);
+			return;
+		}
+	}
+
+	// If possible transfer to rightSibling
+	if (rightSibling >= 0 && rightSibling <= parent->size) {
+		Node* rightNode = parent->child(rightSibling);
+
+		//Check if RightSibling has extra Key to transfer
+		if (rightNode->size > (getMaxIntChildLimit() + 1) / 2 - 1) {
+
+			//transfer key from right sibling through parent
+			cursor->keys()[cursor->size] = parent->keys()[pos];
+			parent->keys()[pos] = rightNode->keys()[0];
+
+			//transfer the pointer from rightSibling to cursor
+			cursor->ptr2Tree()[cursor->size + 1] = rightNode->child(0);
+			cursor->size++;
+
+			for (int i = 0; i < rightNode->size - 1; i++) {
+				rightNode->keys()[i] = rightNode->keys()[i + 1];
+			}
+			for (int i = 0; i < rightNode->size; i++) {
+				rightNode->ptr2Tree()[i] = rightNode->ptr2Tree()[i + 1];
+			}
+			rightNode->size--;
+			 
+			trace(TreeEvent::INTERNAL_BORROW_RIGHT, parent->keys()[pos]);
+			return;
+		}
+	}
+
+	//Start to Merge Now, if None of the above cases applied
+	if (leftSibling >= 0 && leftSibling <= parent->size) {
+		//leftNode + parent key + cursor
+		Node* leftNode = parent->child(leftSibling);
+		leftNode->keys()[leftNode->size] = parent->keys()[leftSibling];
+
+		for (int i = 0; i < cursor->size; i++) {
+			leftNode->keys()[leftNode->size + 1 + i] = cursor->keys()[i];
+		}
+
+		for (int i = 0; i <= cursor->size; i++) {
+			leftNode->ptr2Tree()[leftNode->size + 1 + i] = cursor->child(i);
+			cursor->ptr2Tree()[i] = NULL;
+		}
+		leftNode->size += cursor->size + 1;
+
+		trace(TreeEvent::INTERNAL_MERGE, parent->keys()[leftSibling]);
+
+		// Clean up the merged node - call removeInternal BEFORE delete to avoid use-after-free
+		removeInternal(pos, path);
+		freeNode(cursor);
+		cursor = nullptr;  // Prevent accidental reuse
+	}
+	else if (rightSibling >= 0 && rightSibling <= parent->size) {
+		//cursor + parentkey +rightNode
+		Node* rightNode = parent->child(rightSibling);
+		cursor->keys()[cursor->size] = parent->keys()[rightSibling - 1];
+
+		for (int i = 0; i < rightNode->size; i++) {
+			cursor->keys()[cursor->size + 1 + i] = rightNode->keys()[i];
+		}
+
+		for (int i = 0; i <= rightNode->size; i++) {
+			cursor->ptr2Tree()[cursor->size + 1 + i] = rightNode->child(i);
+			rightNode->ptr2Tree()[i] = NULL;
+		}
+		cursor->size += rightNode->size + 1;
+
+		trace(TreeEvent::INTERNAL_MERGE, parent->keys()[rightSibling - 1]);
+
+		// Clean up the merged node - call removeInternal BEFORE delete to avoid use-after-free
+		removeInternal(rightSibling, path);
+		freeNode(rightNode);
+		rightNode = nullptr;  // Prevent accidental reuse
+	}
+}
+
+}  // namespace bptree
@@ -0,0 +1,222 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+namespace bptree {
+
+namespace detail {
+
+constexpr int floorPow2(int n) {
+    int p = 1;
+    while (p * 2 <= n) p *= 2;
+    return p;
+}
+
+}  // namespace detail
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+int BasicBPTree<Key, Value, Compare, Fanout>::upperBound(const Node* cursor, const Key& key) const {
+    /*
+		upper_bound returns the position of the first key which is greater than key (Because we
+		are storing the same value in the right node). With a static Fanout this is a branchless
+		binary search with a fixed #of halving steps: it unrolls completely and every step is a
+		conditional move, slots past cursor->size behave like +infinity. Integer keys go to the
+		vectorized compare-and-popcount kernels instead (see simd_search.hpp).
+	*/
+    if constexpr (PREFIX_COMPRESSION) {
+        if (cursor->isLeaf) return leafBound(cursor, key, true);
+    }
+    const Key* keys = cursor->keys();
+    countComparisons(cursor->size);
+    if constexpr (simd::SUPPORTED<Key, Compare>) {
+        return simd::upperBound(keys, cursor->size, key);
+    } else if constexpr (Fanout != DYNAMIC_FANOUT) {
+        int base = 0;
+        for (int len = detail::floorPow2(Node::STATIC_CAPACITY); len > 0; len >>= 1) {
+            int probe = base + len;
+            int slot = (probe < Node::STATIC_CAPACITY ? probe : Node::STATIC_CAPACITY) - 1;
+            bool notGreater = (probe <= cursor->size) & !comp(key, keys[slot]);
+            base = notGreater ? probe : base;
+        }
+        return base;
+    } else {
+        return std::upper_bound(keys, keys + cursor->size, key, comp) - keys;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+int BasicBPTree<Key, Value, Compare, Fanout>::lowerBound(const Node* cursor, const Key& key) const {
+    if constexpr (PREFIX_COMPRESSION) {
+        if (cursor->isLeaf) return leafBound(cursor, key, false);
+    }
+    const Key* keys = cursor->keys();
+    countComparisons(cursor->size);
+    if constexpr (simd::SUPPORTED<Key, Compare>) {
+        return simd::lowerBound(keys, cursor->size, key);
+    } else if constexpr (Fanout != DYNAMIC_FANOUT) {
+        int base = 0;
+        for (int len = detail::floorPow2(Node::STATIC_CAPACITY); len > 0; len >>= 1) {
+            int probe = base + len;
+            int slot = (probe < Node::STATIC_CAPACITY ? probe : Node::STATIC_CAPACITY) - 1;
+            bool less = (probe <= cursor->size) & comp(keys[slot], key);
+            base = less ? probe : base;
+        }
+        return base;
+    } else {
+        return std::lower_bound(keys, keys + cursor->size, key, comp) - keys;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::countComparisons(int n) const {
+    /*
+		Derived from the node size rather than counted per compare, so the search loops stay as
+		they are: a binary search over n keys takes bit_width(n) steps, the vector kernels narrow
+		to a WINDOW first and then compare every key left in it.
+	*/
+    if constexpr (TRACING) {
+        if constexpr (simd::SUPPORTED<Key, Compare>) {
+            if (simd::activeIsa() != simd::Isa::SCALAR) {
+                int steps = 0;
+                for (; n > simd::WINDOW; n /= 2) steps++;
+                stats.keyComparisons += steps + n;
+                return;
+            }
+        } else if constexpr (Fanout != DYNAMIC_FANOUT) {
+            n = detail::floorPow2(Node::STATIC_CAPACITY);
+        }
+        int steps = 0;
+        for (; n > 0; n >>= 1) steps++;
+        stats.keyComparisons += steps;
+    } else {
+        (void)n;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+const Value* BasicBPTree<Key, Value, Compare, Fanout>::find(const Key& key) const {
+    if (root == NULL || filterRejects(key)) {
+        return NULL;
+    }
+
+    const Node* cursor = root;
+    if constexpr (TRACING) stats.nodeVisits++;
+    while (cursor->isLeaf == false) {
+        cursor = cursor->child(upperBound(cursor, key));  //upper_bound takes care of all the edge cases
+        if constexpr (TRACING) stats.nodeVisits++;
+    }
+
+    int idx = lowerBound(cursor, key);  //Binary search
+    if (idx == cursor->size || !leafKeyEquals(cursor, idx, key)) {
+        filterMissed();
+        return NULL;
+    }
+
+    /*
+		We can fetch the data from the disc in main memory using data-ptr
+		using cursor->dataPtr()[idx]
+	*/
+    return &cursor->dataPtr()[idx];
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+Value* BasicBPTree<Key, Value, Compare, Fanout>::find(const Key& key) {
+    return const_cast<Value*>(static_cast<const BasicBPTree*>(this)->find(key));
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool BasicBPTree<Key, Value, Compare, Fanout>::contains(const Key& key) const {
+    return find(key) != NULL;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Node* BasicBPTree<Key, Value, Compare, Fanout>::findLeaf(const Key& key, bool upper) const {
+    /*
+		Descending by lowerBound keeps us left of separators equal to key, so with duplicate keys
+		the leaf we land on is the one holding (or just preceding) the first copy.
+	*/
+    Node* cursor = root;
+    if constexpr (TRACING) stats.nodeVisits += cursor != NULL;
+    while (cursor != NULL && cursor->isLeaf == false) {
+        cursor = cursor->child(upper ? upperBound(cursor, key) : lowerBound(cursor, key));
+        if constexpr (TRACING) stats.nodeVisits++;
+    }
+    return cursor;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Node* BasicBPTree<Key, Value, Compare, Fanout>::descend(const Key& key, Path& path) const {
+    // Same descent as find, remembering every internal node and the slot we left it through
+    Node* cursor = root;
+    path.depth = 0;
+    if constexpr (TRACING) stats.nodeVisits++;
+    while (cursor->isLeaf == false) {
+        int i = upperBound(cursor, key);
+        path.steps[path.depth++] = {cursor, i};
+        cursor = cursor->child(i);
+        if constexpr (TRACING) stats.nodeVisits++;
+    }
+    return cursor;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Iterator BasicBPTree<Key, Value, Compare, Fanout>::begin() {
+    return Iterator(root == NULL ? NULL : firstLeftNode(root), 0, false, Key(), &comp);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Iterator BasicBPTree<Key, Value, Compare, Fanout>::end() {
+    return Iterator();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::ConstIterator BasicBPTree<Key, Value, Compare, Fanout>::begin() const {
+    return const_cast<BasicBPTree*>(this)->begin();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::ConstIterator BasicBPTree<Key, Value, Compare, Fanout>::end() const {
+    return ConstIterator();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Iterator BasicBPTree<Key, Value, Compare, Fanout>::lower_bound(const Key& key) {
+    Node* leaf = findLeaf(key, false);
+    return Iterator(leaf, leaf == NULL ? 0 : lowerBound(leaf, key), false, Key(), &comp);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Iterator BasicBPTree<Key, Value, Compare, Fanout>::upper_bound(const Key& key) {
+    Node* leaf = findLeaf(key, true);
+    return Iterator(leaf, leaf == NULL ? 0 : upperBound(leaf, key), false, Key(), &comp);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::ConstIterator BasicBPTree<Key, Value, Compare, Fanout>::lower_bound(const Key& key) const {
+    return const_cast<BasicBPTree*>(this)->lower_bound(key);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::ConstIterator BasicBPTree<Key, Value, Compare, Fanout>::upper_bound(const Key& key) const {
+    return const_cast<BasicBPTree*>(this)->upper_bound(key);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::template Range<typename BasicBPTree<Key, Value, Compare, Fanout>::Iterator>
+BasicBPTree<Key, Value, Compare, Fanout>::scan(const Key& lo, const Key& hi) {
+    /*
+		Descend once to lo and let the iterator walk ptr2next until it meets hi, so the end of
+		the range never needs a second descent.
+	*/
+    Node* leaf = findLeaf(lo, false);
+    return {Iterator(leaf, leaf == NULL ? 0 : lowerBound(leaf, lo), true, hi, &comp), Iterator()};
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::template Range<typename BasicBPTree<Key, Value, Compare, Fanout>::ConstIterator>
+BasicBPTree<Key, Value, Compare, Fanout>::scan(const Key& lo, const Key& hi) const {
+    auto range = const_cast<BasicBPTree*>(this)->scan(lo, hi);
+    return {range.first, range.last};
+}
+
+}  // namespace bptree
@@ -0,0 +1,276 @@
+#pragma once
+
+// Member definitions of ShardedBPTree, included from bptree/sharded_bptree.hpp
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename... TreeArgs>
+ShardedBPTree<Key, Value, Compare, Fanout>::ShardedBPTree(std::vector<Key> fences, const TreeArgs&... treeArgs)
+    : layout(nullptr) {
+    if (!std::is_sorted(fences.begin(), fences.end(), comp)) throw std::invalid_argument("fences have to be sorted");
+    for (std::size_t i = 0; i <= fences.size(); i++) shards.push_back(std::make_unique<Shard>(treeArgs...));
+    layout.store(new Layout{std::move(fences)}, std::memory_order_release);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+ShardedBPTree<Key, Value, Compare, Fanout>::~ShardedBPTree() {
+    delete layout.load(std::memory_order_relaxed);
+    // epochs frees the retired layouts
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::size_t ShardedBPTree<Key, Value, Compare, Fanout>::route(const Layout& current, const Key& key) const {
+    return std::upper_bound(current.fences.begin(), current.fences.end(), key, comp) - current.fences.begin();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename Op>
+auto ShardedBPTree<Key, Value, Compare, Fanout>::withShard(const Key& key, Op&& op) const {
+    /*
+		The layout may be replaced between reading the fences and getting the lock, but never while
+		the shard is held: rebalance() publishes with both shards of the boundary locked. So if the
+		layout is still the one routed by, key belongs to this shard for as long as the lock is held.
+		The guard keeps the layout alive meanwhile, and so also keeps its address from being reused.
+	*/
+    for (;;) {
+        EpochManager::Guard guard(epochs);
+        const Layout* current = layout.load(std::memory_order_acquire);
+        Shard& shard = *shards[route(*current, key)];
+        std::lock_guard<std::mutex> held(shard.lock);
+        if (layout.load(std::memory_order_acquire) == current) {
+            shard.ops++;
+            return op(shard);
+        }
+        reroutes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::optional<Value> ShardedBPTree<Key, Value, Compare, Fanout>::find(const Key& key) const {
+    return withShard(key, [&](Shard& shard) -> std::optional<Value> {
+        const Value* value = static_cast<const Tree&>(shard.tree).find(key);
+        if (value == NULL) return std::nullopt;
+        return *value;
+    });
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool ShardedBPTree<Key, Value, Compare, Fanout>::contains(const Key& key) const {
+    return withShard(key, [&](Shard& shard) { return shard.tree.contains(key); });
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool ShardedBPTree<Key, Value, Compare, Fanout>::insert(const Key& key, const Value& value) {
+    return withShard(key, [&](Shard& shard) {
+        Value* present = shard.tree.find(key);
+        if (present != NULL) {
+            *present = value;
+            return false;
+        }
+        shard.tree.insert(key, value);
+        shard.keys++;
+        return true;
+    });
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+bool ShardedBPTree<Key, Value, Compare, Fanout>::removeKey(const Key& key) {
+    return withShard(key, [&](Shard& shard) {
+        if (!shard.tree.removeKey(key)) return false;
+        shard.keys--;
+        return true;
+    });
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename Visitor>
+void ShardedBPTree<Key, Value, Compare, Fanout>::scan(const Key& lo, const Key& hi, Visitor&& visit) const {
+    // Each round scans one shard from `from` on and moves `from` to the fence it ends at
+    Key from = lo;
+    while (comp(from, hi)) {
+        EpochManager::Guard guard(epochs);
+        const Layout* current = layout.load(std::memory_order_acquire);
+        const std::size_t i = route(*current, from);
+        const Shard& shard = *shards[i];
+        std::lock_guard<std::mutex> held(shard.lock);
+        if (layout.load(std::memory_order_acquire) != current) {
+            reroutes.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        for (auto it = shard.tree.lower_bound(from), end = shard.tree.end(); it != end; ++it) {
+            if (!comp(it.key(), hi)) return;
+            visit(it.key(), it.value());
+        }
+        if (i + 1 == shards.size()) return;
+        from = current->fences[i];
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+template <typename RandomIt>
+bool ShardedBPTree<Key, Value, Compare, Fanout>::bulkLoad(RandomIt first, RandomIt last, double fillFactor,
+                                                          unsigned threads) {
+    /*
+		Shard s gets the pairs from about s/N of the way on, cut at the first pair of its key so
+		equal keys stay together, and its first key becomes fence s-1. The shards are loaded in
+		parallel (see detail::parallelFor in bulk_load.hpp), each into its own slabs.
+	*/
+    auto byKey = [this](const auto& a, const auto& b) { return comp(a.first, b.first); };
+    if (!std::is_sorted(first, last, byKey)) return false;
+
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t count = shards.size();
+    std::lock_guard<std::mutex> serial(rebalanceLock);
+    std::vector<Key> fences = layout.load(std::memory_order_acquire)->fences;
+    std::vector<RandomIt> cuts(count + 1, first);
+    cuts[count] = last;
+    for (std::size_t s = 1; s < count && n > 0; s++) {
+        fences[s - 1] = (first + n * s / count)->first;
+        cuts[s] = std::lower_bound(first, last, fences[s - 1],
+                                   [this](const auto& entry, const Key& key) { return comp(entry.first, key); });
+    }
+    if (n == 0) std::fill(cuts.begin(), cuts.end(), first);
+
+    std::vector<std::unique_lock<std::mutex>> held;
+    for (std::unique_ptr<Shard>& shard : shards) held.emplace_back(shard->lock);
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    detail::parallelFor(threads, count, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t s = begin; s < end; s++) {
+            shards[s]->tree.bulkLoad(cuts[s], cuts[s + 1], fillFactor);
+            shards[s]->keys = cuts[s + 1] - cuts[s];
+            shards[s]->ops = 0;
+        }
+    });
+    publish(std::move(fences));
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void ShardedBPTree<Key, Value, Compare, Fanout>::publish(std::vector<Key> fences) {
+    const Layout* old = layout.exchange(new Layout{std::move(fences)}, std::memory_order_acq_rel);
+    epochs.retire(const_cast<Layout*>(old), [](void* retired) { delete static_cast<Layout*>(retired); });
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::size_t ShardedBPTree<Key, Value, Compare, Fanout>::rebalance(double tolerance) {
+    /*
+		The load of a shard is the #of operations routed to it since the last call, or its #of
+		keys if there were none. Boundaries are visited left to right; where one side carries more
+		than tolerance times the other, the busier side hands the share of its keys that evens the
+		pair out, assuming its load is spread evenly over them, to the quieter side. The load moves
+		with them, so a hot spot is spread over several neighbours in one call. Keys cross one
+		boundary per call, a range that has far to go gets there over repeated calls.
+	*/
+    std::lock_guard<std::mutex> serial(rebalanceLock);
+    const std::size_t count = shards.size();
+    std::vector<double> load(count);
+    double total = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        std::lock_guard<std::mutex> held(shards[i]->lock);
+        load[i] = static_cast<double>(shards[i]->ops);
+        total += load[i];
+        shards[i]->ops = 0;
+    }
+    if (total == 0) {
+        for (std::size_t i = 0; i < count; i++) {
+            std::lock_guard<std::mutex> held(shards[i]->lock);
+            load[i] = static_cast<double>(shards[i]->keys);
+        }
+    }
+
+    std::size_t moved = 0;
+    for (std::size_t i = 0; i + 1 < count; i++) {
+        const bool fromLeft = load[i] > tolerance * load[i + 1];
+        if (!fromLeft && !(load[i + 1] > tolerance * load[i])) continue;
+        double& busy = fromLeft ? load[i] : load[i + 1];
+        double& quiet = fromLeft ? load[i + 1] : load[i];
+        const double fraction = (busy - quiet) / (2 * busy);
+        const std::size_t keys = moveBoundary(i, fraction, fromLeft);
+        if (keys == 0) continue;
+        moved += keys;
+        quiet += busy * fraction;
+        busy -= busy * fraction;
+    }
+    return moved;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::size_t ShardedBPTree<Key, Value, Compare, Fanout>::moveBoundary(std::size_t left, double fraction, bool fromLeft) {
+    // The top fraction of shard left goes to left + 1, or the bottom fraction of left + 1 to left
+    Shard& low = *shards[left];
+    Shard& high = *shards[left + 1];
+    std::scoped_lock held(low.lock, high.lock);
+    const Layout* current = layout.load(std::memory_order_acquire);  // only replaced under rebalanceLock
+    Shard& source = fromLeft ? low : high;
+    Shard& target = fromLeft ? high : low;
+    const std::size_t count = std::min<std::size_t>(static_cast<std::size_t>(source.keys * fraction), source.keys - 1);
+    if (source.keys == 0 || count == 0) return 0;
+
+    // The new fence is the first key that ends up in high, found by walking the leaf chain
+    auto it = source.tree.begin();
+    for (std::size_t rank = fromLeft ? source.keys - count : count; rank > 0; rank--) ++it;
+    const Key fence = it.key();
+    std::vector<std::pair<Key, Value>> moving;
+    moving.reserve(count);
+    auto collect = [&moving](const Key& key, const Value& value) { moving.emplace_back(key, value); };
+    if (fromLeft)
+        low.tree.removeRange(fence, current->fences[left], collect);
+    else
+        high.tree.removeRange(current->fences[left], fence, collect);
+    if (moving.empty()) return 0;  // every key below the fence equals it, nothing to split off
+
+    target.tree.multiInsert(moving.data(), moving.size());
+    source.keys -= moving.size();
+    target.keys += moving.size();
+    std::vector<Key> fences = current->fences;
+    fences[left] = fence;
+    publish(std::move(fences));
+    rebalances++;
+    movedKeys += moving.size();
+    return moving.size();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::size_t ShardedBPTree<Key, Value, Compare, Fanout>::shardCount() const {
+    return shards.size();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::vector<Key> ShardedBPTree<Key, Value, Compare, Fanout>::getFences() const {
+    EpochManager::Guard guard(epochs);
+    return layout.load(std::memory_order_acquire)->fences;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+std::uint64_t ShardedBPTree<Key, Value, Compare, Fanout>::size() const {
+    std::uint64_t keys = 0;
+    for (const std::unique_ptr<Shard>& shard : shards) {
+        std::lock_guard<std::mutex> held(shard->lock);
+        keys += shard->keys;
+    }
+    return keys;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+ShardedStats ShardedBPTree<Key, Value, Compare, Fanout>::getStats() const {
+    ShardedStats stats;
+    stats.reroutes = reroutes.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> serial(rebalanceLock);
+        stats.rebalances = rebalances;
+        stats.movedKeys = movedKeys;
+    }
+    for (const std::unique_ptr<Shard>& shard : shards) {
+        std::lock_guard<std::mutex> held(shard->lock);
+        stats.shards.push_back({shard->keys, shard->ops});
+    }
+    return stats;
+}
+
+}  // namespace bptree
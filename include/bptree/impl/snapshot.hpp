@@ -0,0 +1,135 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bptree {
+
+// First bytes of a snapshot image, the nodes follow from SNAPSHOT_HEADER_BYTES on
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t keyBytes;
+    std::uint32_t valueBytes;
+    std::int32_t maxIntChildLimit;
+    std::int32_t maxLeafNodeLimit;
+    std::uint64_t nodes;
+    std::uint64_t root;   // offset of the root node, 0 for an empty tree
+    std::uint64_t bytes;  // of the whole image
+};
+
+inline constexpr char SNAPSHOT_MAGIC[8] = {'B', 'P', 'T', 'S', 'N', 'A', 'P', '1'};
+inline constexpr std::size_t SNAPSHOT_HEADER_BYTES = CACHE_LINE_SIZE;
+static_assert(sizeof(SnapshotHeader) <= SNAPSHOT_HEADER_BYTES, "the header has to leave the first node aligned");
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::save(const std::string& path) const {
+    /*
+		| header | root | internal nodes level by level ... | leaves in key order ... |
+
+		Every node is written as the block it is in memory, at a cache-line-aligned offset, with
+		its links turned into distances (see ::Links in node.hpp), so the image works wherever it
+		gets mapped. Level order puts the leaves last and in key order, so a scan of the opened
+		tree reads the file front to back. The image is written next to path and renamed over it
+		once complete, a crash while saving leaves the previous one in place.
+	*/
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "a snapshot stores keys and values as raw bytes");
+
+    std::vector<const Node*> nodes;
+    std::unordered_map<const Node*, std::uint64_t> offsets;
+    std::uint64_t end = SNAPSHOT_HEADER_BYTES;
+    if (root != NULL) nodes.push_back(root);
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        const Node* node = nodes[i];
+        offsets[node] = end;
+        end += Node::allocationSize(node->isLeaf, node->isLeaf ? leafCapacity() : internalCapacity());
+        if (!node->isLeaf)
+            for (int c = 0; c <= node->size; c++) nodes.push_back(node->child(c));
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.keyBytes = sizeof(Key);
+    header.valueBytes = sizeof(Value);
+    header.maxIntChildLimit = maxIntChildLimit;
+    header.maxLeafNodeLimit = maxLeafNodeLimit;
+    header.nodes = nodes.size();
+    header.root = root == NULL ? 0 : SNAPSHOT_HEADER_BYTES;
+    header.bytes = end;
+
+    const std::string partial = path + ".tmp";
+    std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+    char headerBlock[SNAPSHOT_HEADER_BYTES] = {};
+    std::memcpy(headerBlock, &header, sizeof(header));
+    out.write(headerBlock, sizeof(headerBlock));
+
+    // Each node is copied into a scratch block of its own alignment and its links rewritten there
+    NodeSlab scratch(std::max(Node::allocationSize(true, leafCapacity()), Node::allocationSize(false, internalCapacity())));
+    unsigned char* block = static_cast<unsigned char*>(scratch.allocate());
+    auto link = [&offsets](std::uint64_t from, const Node* to) {
+        if (to == NULL) return static_cast<Node*>(NULL);
+        return reinterpret_cast<Node*>(static_cast<std::uintptr_t>(offsets.at(to) - from) | Node::RELATIVE_LINK);
+    };
+    for (const Node* node : nodes) {
+        const std::uint64_t at = offsets[node];
+        const std::size_t bytes = Node::allocationSize(node->isLeaf, node->isLeaf ? leafCapacity() : internalCapacity());
+        std::memcpy(block, node, bytes);
+        Node* copy = reinterpret_cast<Node*>(block);
+        if (node->isLeaf) {
+            copy->ptr2next = link(at, node->next());
+        } else {
+            copy->ptr2next = NULL;
+            for (int c = 0; c <= copy->capacity; c++) copy->ptr2Tree()[c] = c <= node->size ? link(at, node->child(c)) : NULL;
+        }
+        out.write(reinterpret_cast<const char*>(block), static_cast<std::streamsize>(bytes));
+    }
+
+    out.close();
+    if (!out) throw std::runtime_error("could not write snapshot: " + partial);
+    std::filesystem::rename(partial, path);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::open(const std::string& path) {
+    /*
+		Maps the image and points root into it. No node is read, let alone converted, before an
+		operation gets to it, so opening takes the same time for a tree of any size. The mapping
+		is private (see MappedFile): the first write to an image node copies the page it is on,
+		the links it stores from then on are plain pointers, and the file stays as saved. Nodes
+		in the image are given up with the mapping, never to the slabs. The mapping is held by a
+		shared_ptr, whose deleter is bound here, so trees that never open() a snapshot do not
+		need mapped_file.cpp linked.
+	*/
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "a snapshot stores keys and values as raw bytes");
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+    SnapshotHeader header;
+    if (file->size() < SNAPSHOT_HEADER_BYTES) throw std::runtime_error("not a snapshot: " + path);
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.bytes != file->size() ||
+        header.root % CACHE_LINE_SIZE != 0 || header.root >= header.bytes)
+        throw std::runtime_error("not a snapshot: " + path);
+    if (header.keyBytes != sizeof(Key) || header.valueBytes != sizeof(Value))
+        throw std::runtime_error("snapshot of other key or value types: " + path);
+    if (Fanout != DYNAMIC_FANOUT && (header.maxIntChildLimit != Fanout || header.maxLeafNodeLimit != Fanout))
+        throw std::runtime_error("snapshot of another fanout: " + path);
+
+    // Trivially copyable keys and values: the old nodes need no destructor, the slabs drop them
+    root = NULL;
+    maxIntChildLimit = header.maxIntChildLimit;
+    maxLeafNodeLimit = header.maxLeafNodeLimit;
+    initSlabs();
+    image = std::move(file);
+    root = header.root == 0 ? NULL : reinterpret_cast<Node*>(image->data() + header.root);
+    if constexpr (TRACING) stats.rootChanges++;
+    if (filter != NULL) rebuildFilter(filter->getBitsPerKey());
+}
+
+}  // namespace bptree
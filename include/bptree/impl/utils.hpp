@@ -0,0 +1,175 @@
+#pragma once
+
+// Member definitions of BasicBPTree, included from bptree/basic_bptree.hpp
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+BasicBPTree<Key, Value, Compare, Fanout>::BasicBPTree() {
+    /*
+        By Default it will take the maxIntChildLimit as 4. And
+        maxLeafNodeLimit as 3 (or the compile-time Fanout for both).
+
+        ::REASON FOR TWO SEPERATE VARIABLES maxIntChildLimit & maxLeafNodeLimit !!
+        We are keeping the two seperate Orders
+        because Internal Nodes can hold more values in one disc block
+        as the size of the Tree pointer is small but the size of the
+        data pointer in the leaf nodes is large so we can only put less
+        nodes in the leafs as compared to the internal Nodes. Thats the
+        reson to reperate out these to variables.
+
+    */
+    if constexpr (Fanout != DYNAMIC_FANOUT) {
+        this->maxIntChildLimit = Fanout;
+        this->maxLeafNodeLimit = Fanout;
+    } else {
+        this->maxIntChildLimit = 4;
+        this->maxLeafNodeLimit = 3;
+    }
+    this->root = NULL;
+    initSlabs();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+BasicBPTree<Key, Value, Compare, Fanout>::BasicBPTree(int degreeInternal, int degreeLeaf) {
+    static_assert(Fanout == DYNAMIC_FANOUT, "limits of a static Fanout tree are fixed at compile time");
+    this->maxIntChildLimit = degreeInternal;
+    this->maxLeafNodeLimit = degreeLeaf;
+    this->root = NULL;
+    initSlabs();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+BasicBPTree<Key, Value, Compare, Fanout>::~BasicBPTree() {
+    // The slabs free every node at once; only keys or values with destructors need the walk first
+    if constexpr (!std::is_trivially_destructible_v<Key> || !std::is_trivially_destructible_v<Value>) destroyTree(root);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::initSlabs() {
+    leafSlab = NodeSlab(Node::allocationSize(true, leafCapacity()));
+    internalSlab = NodeSlab(Node::allocationSize(false, internalCapacity()));
+    tailLeaf = NULL;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Node* BasicBPTree<Key, Value, Compare, Fanout>::newNode(bool isLeaf) {
+    if (isLeaf) return Node::construct(leafSlab.allocate(), true, leafCapacity());
+    return Node::construct(internalSlab.allocate(), false, internalCapacity());
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::freeNode(Node* node) {
+    NodeSlab& slab = node->isLeaf ? leafSlab : internalSlab;
+    if (node == tailLeaf) tailLeaf = NULL;
+    Node::destruct(node);
+    if (image == NULL || !image->contains(node)) slab.release(node);  // image nodes go with the mapping
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::destroyTree(Node* node) {
+    if (node == NULL) return;
+
+    if (!node->isLeaf) {
+        // Recursively delete all children
+        for (int i = 0; i <= node->size; i++) {
+            destroyTree(node->child(i));
+        }
+    }
+
+    freeNode(node);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+int BasicBPTree<Key, Value, Compare, Fanout>::getMaxIntChildLimit() const {
+    if constexpr (Fanout != DYNAMIC_FANOUT)
+        return Fanout;
+    else
+        return maxIntChildLimit;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+int BasicBPTree<Key, Value, Compare, Fanout>::getMaxLeafNodeLimit() const {
+    if constexpr (Fanout != DYNAMIC_FANOUT)
+        return Fanout;
+    else
+        return maxLeafNodeLimit;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+int BasicBPTree<Key, Value, Compare, Fanout>::leafCapacity() const {
+    if constexpr (Fanout != DYNAMIC_FANOUT)
+        return Node::STATIC_CAPACITY;
+    else
+        return maxLeafNodeLimit + 1;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+int BasicBPTree<Key, Value, Compare, Fanout>::internalCapacity() const {
+    if constexpr (Fanout != DYNAMIC_FANOUT)
+        return Node::STATIC_CAPACITY;
+    else
+        return maxIntChildLimit;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Node* BasicBPTree<Key, Value, Compare, Fanout>::getRoot() {
+    return this->root;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::setRoot(Node* ptr) {
+    this->root = ptr;
+    this->tailLeaf = NULL;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::setEventHandler(EventHandler handler) {
+    this->onEvent = std::move(handler);
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+const TreeStats& BasicBPTree<Key, Value, Compare, Fanout>::getStats() const {
+    return this->stats;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::resetStats() {
+    this->stats = TreeStats();
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+MemoryStats BasicBPTree<Key, Value, Compare, Fanout>::getMemoryStats() const {
+    MemoryStats memory;
+    memory.bytesReserved = leafSlab.bytesReserved() + internalSlab.bytesReserved();
+    memory.bytesInUse = leafSlab.bytesInUse() + internalSlab.bytesInUse();
+    memory.leafNodes = leafSlab.liveCount();
+    memory.internalNodes = internalSlab.liveCount();
+    memory.chunks = leafSlab.chunkCount() + internalSlab.chunkCount();
+    memory.bytesMapped = image == NULL ? 0 : image->size();
+    return memory;
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+void BasicBPTree<Key, Value, Compare, Fanout>::trace(TreeEvent event, const Key& key) {
+    if constexpr (TRACING) {
+        stats.count(event);
+        if (onEvent) onEvent(event, key);
+    } else {
+        (void)event;
+        (void)key;
+    }
+}
+
+template <typename Key, typename Value, typename Compare, int Fanout>
+typename BasicBPTree<Key, Value, Compare, Fanout>::Node* BasicBPTree<Key, Value, Compare, Fanout>::firstLeftNode(Node* cursor) {
+    if (cursor->isLeaf)
+        return cursor;
+    for (int i = 0; i <= cursor->size; i++)
+        if (cursor->ptr2Tree()[i] != NULL)
+            return firstLeftNode(cursor->child(i));
+
+    return NULL;
+}
+
+}  // namespace bptree
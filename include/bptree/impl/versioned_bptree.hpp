@@ -0,0 +1,521 @@
+#pragma once
+
+// Member definitions of VersionedBPTree, included from bptree/versioned_bptree.hpp
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+namespace bptree {
+
+template <typename Key, typename Value, typename Compare>
+std::size_t VersionedBPTree<Key, Value, Compare>::Node::allocationSize(bool isLeaf, int capacity) {
+    std::size_t slotBytes = isLeaf ? capacity * sizeof(Value) : (capacity + 1) * sizeof(Node*);
+    return roundUp(slotsOffset(capacity) + slotBytes, CACHE_LINE_SIZE);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename VersionedBPTree<Key, Value, Compare>::Node* VersionedBPTree<Key, Value, Compare>::Node::create(
+    void* block, bool isLeaf, int capacity, std::uint64_t version) {
+    Node* node = new (block) Node();
+    node->version = version;
+    node->isLeaf = isLeaf;
+    node->size = 0;
+    node->capacity = capacity;
+    if (!isLeaf) std::fill(node->children(), node->children() + capacity + 1, nullptr);
+    return node;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename VersionedBPTree<Key, Value, Compare>::Node* VersionedBPTree<Key, Value, Compare>::createNode(bool isLeaf) {
+    void* block = isLeaf ? leafSlab.allocate() : internalSlab.allocate();
+    copied++;
+    return Node::create(block, isLeaf, isLeaf ? leafCapacity() : internalCapacity(), writing);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename VersionedBPTree<Key, Value, Compare>::Node* VersionedBPTree<Key, Value, Compare>::copyNode(const Node* node) {
+    Node* mine = createNode(node->isLeaf);
+    std::copy(node->keys(), node->keys() + node->size, mine->keys());
+    if (node->isLeaf)
+        std::copy(node->values(), node->values() + node->size, mine->values());
+    else
+        std::copy(node->children(), node->children() + node->size + 1, mine->children());
+    mine->size = node->size;
+    return mine;
+}
+
+template <typename Key, typename Value, typename Compare>
+void VersionedBPTree<Key, Value, Compare>::freeNode(Node* node) {
+    // Nodes are trivially destructible, the block goes straight back to its slab
+    (node->isLeaf ? leafSlab : internalSlab).release(node);
+}
+
+template <typename Key, typename Value, typename Compare>
+VersionedBPTree<Key, Value, Compare>::Snapshot::Snapshot(Snapshot&& other) noexcept
+    : tree(other.tree), root(other.root), version(other.version), count(other.count) {
+    other.tree = nullptr;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename VersionedBPTree<Key, Value, Compare>::Snapshot& VersionedBPTree<Key, Value, Compare>::Snapshot::operator=(
+    Snapshot&& other) noexcept {
+    if (this != &other) {
+        release();
+        tree = std::exchange(other.tree, nullptr);
+        root = other.root;
+        version = other.version;
+        count = other.count;
+    }
+    return *this;
+}
+
+template <typename Key, typename Value, typename Compare>
+VersionedBPTree<Key, Value, Compare>::Snapshot::~Snapshot() {
+    release();
+}
+
+template <typename Key, typename Value, typename Compare>
+void VersionedBPTree<Key, Value, Compare>::Snapshot::release() {
+    if (tree != nullptr) tree->close(version);
+    tree = nullptr;
+}
+
+template <typename Key, typename Value, typename Compare>
+const Value* VersionedBPTree<Key, Value, Compare>::Snapshot::find(const Key& key) const {
+    const Node* leaf = tree->findLeaf(root, key);
+    int idx = tree->lowerBound(leaf, key);
+    return idx < leaf->size && tree->equal(leaf->keys()[idx], key) ? &leaf->values()[idx] : nullptr;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool VersionedBPTree<Key, Value, Compare>::Snapshot::contains(const Key& key) const {
+    return find(key) != nullptr;
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename Visitor>
+void VersionedBPTree<Key, Value, Compare>::Snapshot::scan(const Key& lo, const Key& hi, Visitor&& visit) const {
+    /*
+		Down to lo once, remembering the child taken at every level. Past the end of a leaf the
+		scan climbs to the lowest ancestor with a child right of the one taken and goes down the
+		left edge of that child, so every internal node is entered once per scan.
+	*/
+    struct Step {
+        const Node* node;
+        int child;
+    };
+    Step stack[MAX_HEIGHT];
+    int depth = 0;
+    const Node* node = root;
+    while (!node->isLeaf) {
+        int child = tree->upperBound(node, lo);
+        stack[depth++] = {node, child};
+        node = node->children()[child];
+    }
+
+    for (int i = tree->lowerBound(node, lo);; i = 0) {
+        for (; i < node->size; i++) {
+            if (!tree->comp(node->keys()[i], hi)) return;
+            visit(node->keys()[i], node->values()[i]);
+        }
+        while (depth > 0 && stack[depth - 1].child == stack[depth - 1].node->size) depth--;
+        if (depth == 0) return;
+        Step& step = stack[depth - 1];
+        node = step.node->children()[++step.child];
+        while (!node->isLeaf) {
+            stack[depth++] = {node, 0};
+            node = node->children()[0];
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+VersionedBPTree<Key, Value, Compare>::VersionedBPTree() : VersionedBPTree(4, 3) {}
+
+template <typename Key, typename Value, typename Compare>
+VersionedBPTree<Key, Value, Compare>::VersionedBPTree(int degreeInternal, int degreeLeaf)
+    : maxIntChildLimit(degreeInternal),
+      maxLeafNodeLimit(degreeLeaf),
+      leafSlab(Node::allocationSize(true, leafCapacity())),
+      internalSlab(Node::allocationSize(false, internalCapacity())) {
+    root = Node::create(leafSlab.allocate(), true, leafCapacity(), version);
+}
+
+template <typename Key, typename Value, typename Compare>
+VersionedBPTree<Key, Value, Compare>::~VersionedBPTree() {
+    // The slabs drop every node, live and retired, with their chunks
+}
+
+template <typename Key, typename Value, typename Compare>
+typename VersionedBPTree<Key, Value, Compare>::Snapshot VersionedBPTree<Key, Value, Compare>::snapshot() const {
+    std::lock_guard<std::mutex> lock(versionMutex);
+    open[version]++;
+    return Snapshot(this, root, version, count);
+}
+
+template <typename Key, typename Value, typename Compare>
+void VersionedBPTree<Key, Value, Compare>::close(std::uint64_t snapshotVersion) const {
+    std::lock_guard<std::mutex> lock(versionMutex);
+    auto it = open.find(snapshotVersion);
+    if (--it->second == 0) open.erase(it);
+}
+
+template <typename Key, typename Value, typename Compare>
+std::optional<Value> VersionedBPTree<Key, Value, Compare>::find(const Key& key) const {
+    Snapshot pinned = snapshot();
+    const Value* value = pinned.find(key);
+    return value != nullptr ? std::optional<Value>(*value) : std::nullopt;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool VersionedBPTree<Key, Value, Compare>::contains(const Key& key) const {
+    return snapshot().contains(key);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename Visitor>
+void VersionedBPTree<Key, Value, Compare>::scan(const Key& lo, const Key& hi, Visitor&& visit) const {
+    snapshot().scan(lo, hi, std::forward<Visitor>(visit));
+}
+
+template <typename Key, typename Value, typename Compare>
+std::uint64_t VersionedBPTree<Key, Value, Compare>::size() const {
+    std::lock_guard<std::mutex> lock(versionMutex);
+    return count;
+}
+
+template <typename Key, typename Value, typename Compare>
+int VersionedBPTree<Key, Value, Compare>::getMaxIntChildLimit() const {
+    return maxIntChildLimit;
+}
+
+template <typename Key, typename Value, typename Compare>
+int VersionedBPTree<Key, Value, Compare>::getMaxLeafNodeLimit() const {
+    return maxLeafNodeLimit;
+}
+
+template <typename Key, typename Value, typename Compare>
+VersionedStats VersionedBPTree<Key, Value, Compare>::getStats() const {
+    std::lock_guard<std::mutex> lock(versionMutex);
+    VersionedStats stats;
+    stats.version = version;
+    for (const auto& entry : open) stats.openSnapshots += entry.second;
+    stats.copiedNodes = copiedCount;
+    stats.retiredNodes = retiredCount;
+    stats.freedNodes = freedCount;
+    stats.retiredBacklog = retired.size();
+    return stats;
+}
+
+template <typename Key, typename Value, typename Compare>
+std::size_t VersionedBPTree<Key, Value, Compare>::collect() {
+    std::lock_guard<std::mutex> write(writeMutex);  // the slabs are the writers'
+    std::vector<Node*> freeable;
+    {
+        std::lock_guard<std::mutex> lock(versionMutex);
+        collectLocked(freeable);
+    }
+    for (Node* node : freeable) freeNode(node);
+    return freeable.size();
+}
+
+template <typename Key, typename Value, typename Compare>
+std::size_t VersionedBPTree<Key, Value, Compare>::collectLocked(std::vector<Node*>& freeable) {
+    // A node stays if the oldest open version at or after the one that created it is older than its replacement
+    std::size_t kept = 0;
+    for (const Retired& entry : retired) {
+        auto seen = open.lower_bound(entry.node->version);
+        if (seen != open.end() && seen->first < entry.replacedBy)
+            retired[kept++] = entry;
+        else
+            freeable.push_back(entry.node);
+    }
+    freedCount += retired.size() - kept;
+    retired.resize(kept);
+    keptByLastCollect = kept;
+    return freeable.size();
+}
+
+template <typename Key, typename Value, typename Compare>
+int VersionedBPTree<Key, Value, Compare>::upperBound(const Node* node, const Key& key) const {
+    const Key* keys = node->keys();
+    if constexpr (simd::SUPPORTED<Key, Compare>)
+        return simd::upperBound(keys, node->size, key);
+    else
+        return std::upper_bound(keys, keys + node->size, key, comp) - keys;
+}
+
+template <typename Key, typename Value, typename Compare>
+int VersionedBPTree<Key, Value, Compare>::lowerBound(const Node* node, const Key& key) const {
+    const Key* keys = node->keys();
+    if constexpr (simd::SUPPORTED<Key, Compare>)
+        return simd::lowerBound(keys, node->size, key);
+    else
+        return std::lower_bound(keys, keys + node->size, key, comp) - keys;
+}
+
+template <typename Key, typename Value, typename Compare>
+const typename VersionedBPTree<Key, Value, Compare>::Node* VersionedBPTree<Key, Value, Compare>::findLeaf(
+    const Node* node, const Key& key) const {
+    while (!node->isLeaf) node = node->children()[upperBound(node, key)];
+    return node;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename VersionedBPTree<Key, Value, Compare>::Node* VersionedBPTree<Key, Value, Compare>::copyPath(const Key& key,
+                                                                                                  Path& path,
+                                                                                                  Node*& newRoot) {
+    // Only writers change root, and the caller is the only one: no versionMutex needed to read it
+    writing = version + 1;
+    newRoot = copyNode(root);
+    retire(root);
+
+    Node* node = newRoot;
+    path.depth = 0;
+    while (!node->isLeaf) {
+        int child = upperBound(node, key);
+        path.steps[path.depth++] = {node, child};
+        node = own(node, child);
+    }
+    return node;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename VersionedBPTree<Key, Value, Compare>::Node* VersionedBPTree<Key, Value, Compare>::own(Node* parent,
+                                                                                             int childIdx) {
+    Node* child = parent->children()[childIdx];
+    if (child->version == writing) return child;
+    Node* mine = copyNode(child);
+    retire(child);
+    parent->children()[childIdx] = mine;
+    return mine;
+}
+
+template <typename Key, typename Value, typename Compare>
+void VersionedBPTree<Key, Value, Compare>::retire(Node* node) {
+    if (node->version == writing) {  // never published, nobody else can have seen it
+        freeNode(node);
+        return;
+    }
+    replaced.push_back({node, writing});
+}
+
+template <typename Key, typename Value, typename Compare>
+void VersionedBPTree<Key, Value, Compare>::publish(Node* newRoot, std::uint64_t newCount) {
+    /*
+		The new version becomes visible and what it replaced is retired in one step. A collect
+		pass runs once the retirements since the last one are at least as many as that pass kept,
+		so nodes held by a long-lived snapshot are not re-examined after every write.
+	*/
+    std::vector<Node*> freeable;
+    {
+        std::lock_guard<std::mutex> lock(versionMutex);
+        root = newRoot;
+        version = writing;
+        count = newCount;
+        retired.insert(retired.end(), replaced.begin(), replaced.end());
+        retiredCount += replaced.size();
+        copiedCount += copied;
+        if (retired.size() - keptByLastCollect >= std::max(RECLAIM_BATCH, keptByLastCollect)) collectLocked(freeable);
+    }
+    replaced.clear();
+    copied = 0;
+    for (Node* node : freeable) freeNode(node);
+}
+
+template <typename Key, typename Value, typename Compare>
+bool VersionedBPTree<Key, Value, Compare>::insert(const Key& key, const Value& value) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    Path path;
+    Node* newRoot;
+    Node* leaf = copyPath(key, path, newRoot);
+
+    Key* keys = leaf->keys();
+    Value* values = leaf->values();
+    int i = lowerBound(leaf, key);
+    if (i < leaf->size && equal(keys[i], key)) {
+        values[i] = value;
+        publish(newRoot, count);
+        return false;
+    }
+
+    for (int j = leaf->size; j > i; j--) {
+        keys[j] = keys[j - 1];
+        values[j] = values[j - 1];
+    }
+    keys[i] = key;
+    values[i] = value;
+    leaf->size++;
+    if (leaf->size > maxLeafNodeLimit) splitLeaf(leaf, path, newRoot);
+    publish(newRoot, count + 1);
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+void VersionedBPTree<Key, Value, Compare>::splitLeaf(Node* leaf, Path& path, Node*& newRoot) {
+    // Same split as ConcurrentBPTree::splitLeaf, on a path that is already this version's own
+    Node* newLeaf = createNode(true);
+    int keep = maxLeafNodeLimit / 2 + 1;
+    std::copy(leaf->keys() + keep, leaf->keys() + leaf->size, newLeaf->keys());
+    std::copy(leaf->values() + keep, leaf->values() + leaf->size, newLeaf->values());
+    newLeaf->size = leaf->size - keep;
+    leaf->size = keep;
+
+    Key separator = newLeaf->keys()[0];
+    Node* left = leaf;
+    Node* right = newLeaf;
+    while (path.depth > 0) {
+        PathStep step = path.steps[--path.depth];
+        Node* cursor = step.node;
+        Key* keys = cursor->keys();
+        Node** children = cursor->children();
+        int i = step.child;
+        for (int j = cursor->size; j > i; j--) keys[j] = keys[j - 1];
+        for (int j = cursor->size + 1; j > i + 1; j--) children[j] = children[j - 1];
+        keys[i] = separator;
+        children[i + 1] = right;
+        cursor->size++;
+        if (cursor->size <= maxIntChildLimit - 1) return;
+
+        int partitionIdx = cursor->size / 2;  //right biased, the middle key moves up
+        Node* newInternalNode = createNode(false);
+        std::copy(keys + partitionIdx + 1, keys + cursor->size, newInternalNode->keys());
+        std::copy(children + partitionIdx + 1, children + cursor->size + 1, newInternalNode->children());
+        newInternalNode->size = cursor->size - partitionIdx - 1;
+        cursor->size = partitionIdx;
+
+        separator = keys[partitionIdx];
+        left = cursor;
+        right = newInternalNode;
+    }
+
+    // The split went through the root, the tree grows a level
+    newRoot = createNode(false);
+    newRoot->keys()[0] = separator;
+    newRoot->children()[0] = left;
+    newRoot->children()[1] = right;
+    newRoot->size = 1;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool VersionedBPTree<Key, Value, Compare>::removeKey(const Key& key) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    // A miss copies nothing and publishes no version
+    const Node* current = findLeaf(root, key);
+    int pos = lowerBound(current, key);
+    if (pos == current->size || !equal(current->keys()[pos], key)) return false;
+
+    Path path;
+    Node* newRoot;
+    Node* leaf = copyPath(key, path, newRoot);
+    Key* keys = leaf->keys();
+    Value* values = leaf->values();
+    for (int i = pos; i < leaf->size - 1; i++) {
+        keys[i] = keys[i + 1];
+        values[i] = values[i + 1];
+    }
+    leaf->size--;
+    rebalance(leaf, path, newRoot);
+    publish(newRoot, count - 1);
+    return true;
+}
+
+template <typename Key, typename Value, typename Compare>
+void VersionedBPTree<Key, Value, Compare>::rebalance(Node* cursor, Path& path, Node*& newRoot) {
+    /*
+		ConcurrentBPTree::rebalance, except that a sibling is copied into this version before it
+		lends an entry or takes a merge, and a node merged away is retired rather than latched.
+	*/
+    while (path.depth > 0) {
+        const int minKeys = cursor->isLeaf ? minLeafKeys() : minInternalKeys();
+        if (cursor->size >= minKeys) return;
+
+        PathStep step = path.steps[--path.depth];
+        Node* parent = step.node;
+        int pos = step.child;
+        Node* left = pos > 0 ? parent->children()[pos - 1] : nullptr;
+        Node* right = pos < parent->size ? parent->children()[pos + 1] : nullptr;
+        Key* keys = cursor->keys();
+
+        if (left != nullptr && left->size > minKeys) {
+            // Make room at the front of cursor for the largest entry of the left sibling
+            left = own(parent, pos - 1);
+            if (cursor->isLeaf) {
+                std::copy_backward(keys, keys + cursor->size, keys + cursor->size + 1);
+                std::copy_backward(cursor->values(), cursor->values() + cursor->size, cursor->values() + cursor->size + 1);
+                keys[0] = left->keys()[left->size - 1];
+                cursor->values()[0] = left->values()[left->size - 1];
+                parent->keys()[pos - 1] = keys[0];
+            } else {
+                std::copy_backward(keys, keys + cursor->size, keys + cursor->size + 1);
+                std::copy_backward(cursor->children(), cursor->children() + cursor->size + 1,
+                                   cursor->children() + cursor->size + 2);
+                keys[0] = parent->keys()[pos - 1];
+                parent->keys()[pos - 1] = left->keys()[left->size - 1];
+                cursor->children()[0] = left->children()[left->size];
+            }
+            cursor->size++;
+            left->size--;
+            return;
+        }
+
+        if (right != nullptr && right->size > minKeys) {
+            // Append the smallest entry of the right sibling
+            right = own(parent, pos + 1);
+            if (cursor->isLeaf) {
+                keys[cursor->size] = right->keys()[0];
+                cursor->values()[cursor->size] = right->values()[0];
+                std::copy(right->keys() + 1, right->keys() + right->size, right->keys());
+                std::copy(right->values() + 1, right->values() + right->size, right->values());
+                parent->keys()[pos] = right->keys()[0];
+            } else {
+                keys[cursor->size] = parent->keys()[pos];
+                parent->keys()[pos] = right->keys()[0];
+                cursor->children()[cursor->size + 1] = right->children()[0];
+                std::copy(right->keys() + 1, right->keys() + right->size, right->keys());
+                std::copy(right->children() + 1, right->children() + right->size + 1, right->children());
+            }
+            cursor->size++;
+            right->size--;
+            return;
+        }
+
+        // Merge: everything of the right node moves into the left one, the right one leaves the tree
+        Node* into = left != nullptr ? own(parent, pos - 1) : cursor;
+        Node* from = left != nullptr ? cursor : right;
+        int fromIdx = left != nullptr ? pos : pos + 1;
+        if (into->isLeaf) {
+            std::copy(from->keys(), from->keys() + from->size, into->keys() + into->size);
+            std::copy(from->values(), from->values() + from->size, into->values() + into->size);
+            into->size += from->size;
+        } else {
+            into->keys()[into->size] = parent->keys()[fromIdx - 1];
+            std::copy(from->keys(), from->keys() + from->size, into->keys() + into->size + 1);
+            std::copy(from->children(), from->children() + from->size + 1, into->children() + into->size + 1);
+            into->size += from->size + 1;
+        }
+        removeChild(parent, fromIdx);
+        retire(from);
+
+        if (path.depth == 0) {
+            if (parent->size == 0) {  // the root lost its last separator
+                newRoot = parent->children()[0];
+                retire(parent);
+            }
+            return;
+        }
+        cursor = parent;
+    }
+}
+
+template <typename Key, typename Value, typename Compare>
+void VersionedBPTree<Key, Value, Compare>::removeChild(Node* parent, int childIdx) {
+    Key* keys = parent->keys();
+    Node** children = parent->children();
+    std::copy(keys + childIdx, keys + parent->size, keys + childIdx - 1);
+    std::copy(children + childIdx + 1, children + parent->size + 1, children + childIdx);
+    parent->size--;
+}
+
+}  // namespace bptree
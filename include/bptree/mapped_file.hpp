@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace bptree {
+
+class MappedFile {
+    /*
+		A whole file mapped copy-on-write: reads come straight from the page cache, the first write
+		to a page gives the process its own copy of it and the file itself never changes. Failures
+		of the underlying calls throw std::system_error; an empty file maps to no bytes.
+	*/
+   public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    unsigned char* data() const { return base; }
+    std::size_t size() const { return bytes; }
+    bool contains(const void* address) const {
+        const unsigned char* at = static_cast<const unsigned char*>(address);
+        return bytes > 0 && at >= base && at < base + bytes;
+    }
+
+   private:
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+    unsigned char* base = nullptr;
+    std::size_t bytes = 0;
+};
+
+}  // namespace bptree
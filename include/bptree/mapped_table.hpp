@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "bptree/basic_bptree.hpp"
+#include "bptree/value_store.hpp"
+
+namespace bptree {
+
+template <typename Key, typename Compare = std::less<Key>, int Fanout = DYNAMIC_FANOUT>
+class MappedTable {
+    /*
+		Keys in a BasicBPTree, their values in a ValueStore: the leaves hold only the 8-byte
+		ValueRef, and lookup() returns a view straight into the mapped value. A hit is the descent
+		plus one load from the mapping, no syscall and no copy, whatever the size of the value.
+
+		Views stay valid until the table is destroyed, even across later puts and erases (an erased
+		or replaced value keeps its bytes, see ValueStore). Like BPTree the index only lives in
+		memory, so the value file is started afresh by every MappedTable.
+	*/
+   public:
+    using Index = BasicBPTree<Key, ValueRef, Compare, Fanout>;
+
+    explicit MappedTable(const std::string& path, std::size_t segmentSize = ValueStore::DEFAULT_SEGMENT_SIZE)
+        : store(fresh(path), segmentSize) {}
+    MappedTable(const std::string& path, int degreeInternal, int degreeLeaf,
+                std::size_t segmentSize = ValueStore::DEFAULT_SEGMENT_SIZE)
+        : index(degreeInternal, degreeLeaf), store(fresh(path), segmentSize) {}
+
+    void put(const Key& key, std::string_view value);              // replaces the value of a key that is present
+    std::optional<std::string_view> lookup(const Key& key) const;  // nullopt if the key is absent
+    bool erase(const Key& key);                                    // false if the key is absent
+
+    std::uint64_t size() const { return store.size(); }  // #of keys
+    Index& getIndex() { return index; }
+    ValueStore& getStore() { return store; }
+
+   private:
+    Index index;
+    ValueStore store;
+
+    static const std::string& fresh(const std::string& path) {
+        std::filesystem::path file(path);
+        if (file.has_parent_path()) std::filesystem::create_directories(file.parent_path());
+        std::filesystem::remove(file);
+        return path;
+    }
+};
+
+template <typename Key, typename Compare, int Fanout>
+void MappedTable<Key, Compare, Fanout>::put(const Key& key, std::string_view value) {
+    ValueRef ref = store.append(value);
+    ValueRef* existing = index.find(key);
+    if (existing != NULL) {
+        store.erase(*existing);
+        *existing = ref;
+    } else {
+        index.insert(key, ref);
+    }
+}
+
+template <typename Key, typename Compare, int Fanout>
+std::optional<std::string_view> MappedTable<Key, Compare, Fanout>::lookup(const Key& key) const {
+    const ValueRef* ref = index.find(key);
+    if (ref == NULL) return std::nullopt;
+    return store.get(*ref);
+}
+
+template <typename Key, typename Compare, int Fanout>
+bool MappedTable<Key, Compare, Fanout>::erase(const Key& key) {
+    const ValueRef* ref = index.find(key);
+    if (ref == NULL) return false;
+    store.erase(*ref);
+    return index.removeKey(key);
+}
+
+}  // namespace bptree
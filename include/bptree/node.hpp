@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace bptree {
+
+// Fanout template argument meaning "limits are given to the constructor at runtime"
+inline constexpr int DYNAMIC_FANOUT = 0;
+
+inline constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Start loading the cache line holding address, a hint only: nothing waits for it
+inline void prefetchLine(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+template <typename Key, typename Value, int Fanout = DYNAMIC_FANOUT>
+class BasicNode {
+    /*
+		Generally size of the this node should be equal to the block size. Which will limit the number of disk access and increase the accesssing time.
+		Intermediate nodes only hold the Tree pointers which is of considerably small size(so they can hold more Tree pointers) and only Leaf nodes hold
+		the data pointer directly to the disc. (These nodes live on the heap, DiskBPTree in
+		bptree/disk_bptree.hpp is the variant whose nodes really are pages of a file.)
+
+		IMPORTANT := All the data has to be present in the leaf node
+
+		::Layout:=
+			A node is ONE cache-line-aligned allocation. The header below is followed inline by
+			`capacity` keys and then by the child pointers (internal nodes, capacity+1 of them)
+			or the data pointers (leaf nodes, capacity of them):
+
+			| isLeaf size capacity ptr2next | keys[capacity] | ptr2Tree[capacity+1] OR [prefix] dataPtr[capacity] |
+
+			So visiting a node costs one block instead of node + keys vector + pointer vector. The
+			blocks come from the tree's NodeSlab (bptree/node_slab.hpp), one size class per kind.
+			The capacity is sized from maxIntChildLimit/maxLeafNodeLimit with ONE extra slot, so an
+			overflowing insert lands in place and is split from there (no temporary vectors).
+
+		::Fanout:=
+			With a compile-time Fanout every node has the same STATIC_CAPACITY, so all the offsets
+			below fold into constants and loops bounded by the capacity can be unrolled.
+
+		::Prefix:=
+			Leaves of std::string keys carry one more key slot after the keys, prefix(). When it is
+			not empty every key of the leaf starts with it and keys() hold only what follows, so a
+			leaf of URLs keeps "https://host/path/" once and suffixes short enough for the string's
+			inline buffer. The tree decides when a leaf is compressed (see key_compression.hpp).
+
+		::Links:=
+			Nodes of a snapshot image (BasicBPTree::open, see snapshot.hpp) are used where the file is
+			mapped, so their ptr2Tree/ptr2next slots hold the distance to the target instead of its
+			address, tagged with RELATIVE_LINK in the low bit (blocks are cache-line aligned, so a
+			real pointer never has it set). child()/next() follow either kind. Links moved within a
+			node stay valid, a link copied into ANOTHER node has to be read through child()/next().
+	*/
+    static_assert(alignof(Key) <= CACHE_LINE_SIZE && alignof(Value) <= CACHE_LINE_SIZE,
+                  "over-aligned keys/values are not supported");
+
+   public:
+    static constexpr int STATIC_CAPACITY = Fanout + 1;
+    static constexpr std::size_t PREFETCH_LINES = 4;
+    static constexpr bool PREFIXED = std::is_same_v<Key, std::string>;  // leaves have a prefix() slot
+    static constexpr std::uintptr_t RELATIVE_LINK = 1;                  // tag of a link that is a distance
+
+    bool isLeaf;
+    int size;      // #of keys currently stored
+    int capacity;  // #of key slots available inline
+    //Node* ptr2parent; //Pointer to go to parent node CANNOT USE check https://stackoverflow.com/questions/57831014/why-we-are-not-saving-the-parent-pointer-in-b-tree-for-easy-upward-traversal-in
+    BasicNode* ptr2next;  //Pointer to connect next node for leaf nodes
+
+    // In a cache-line-aligned block of allocationSize(isLeaf, capacity) bytes, which stays the caller's
+    static BasicNode* construct(void* block, bool isLeaf, int capacity);
+    static void destruct(BasicNode* node);  // destructors only, the block is not freed
+    static constexpr std::size_t allocationSize(bool isLeaf, int capacity);
+    // Prefetch the header and the first lines of keys of a node with room for capacity keys
+    static void prefetch(const BasicNode* node, int capacity);
+
+    Key* keys() { return reinterpret_cast<Key*>(bytes() + keysOffset()); }
+    const Key* keys() const { return reinterpret_cast<const Key*>(bytes() + keysOffset()); }
+    BasicNode** ptr2Tree() { return reinterpret_cast<BasicNode**>(bytes() + slotsOffset(slotCapacity())); }  //Array of pointers to Children sub-trees for intermediate Nodes
+    BasicNode* const* ptr2Tree() const { return reinterpret_cast<BasicNode* const*>(bytes() + slotsOffset(slotCapacity())); }
+    Value* dataPtr() { return reinterpret_cast<Value*>(bytes() + slotsOffset(slotCapacity() + PREFIX_SLOTS)); }  // Data-Pointer for the leaf node
+    const Value* dataPtr() const { return reinterpret_cast<const Value*>(bytes() + slotsOffset(slotCapacity() + PREFIX_SLOTS)); }
+    Key& prefix() { return keys()[slotCapacity()]; }  // leaves of PREFIXED nodes only
+    const Key& prefix() const { return keys()[slotCapacity()]; }
+    BasicNode* child(int i) const { return follow(ptr2Tree()[i]); }  // ptr2Tree()[i], whatever kind of link
+    BasicNode* next() const { return follow(ptr2next); }
+    BasicNode* follow(BasicNode* link) const {
+        const std::uintptr_t raw = reinterpret_cast<std::uintptr_t>(link);
+        if ((raw & RELATIVE_LINK) == 0) return link;
+        return reinterpret_cast<BasicNode*>(reinterpret_cast<std::uintptr_t>(this) + (raw ^ RELATIVE_LINK));
+    }
+
+    int slotCapacity() const {
+        if constexpr (Fanout != DYNAMIC_FANOUT)
+            return STATIC_CAPACITY;
+        else
+            return capacity;
+    }
+
+   private:
+    static constexpr std::size_t roundUp(std::size_t bytes, std::size_t alignment) {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+    static constexpr int PREFIX_SLOTS = PREFIXED ? 1 : 0;  // key slots a leaf has past its capacity
+    static constexpr std::size_t SLOT_ALIGN =
+        alignof(BasicNode*) > alignof(Value) ? alignof(BasicNode*) : alignof(Value);
+
+    // keys start right after the header; pointers start at the next pointer-aligned byte
+    static constexpr std::size_t keysOffset() { return roundUp(sizeof(BasicNode), alignof(Key)); }
+    static constexpr std::size_t slotsOffset(int capacity) {
+        return roundUp(keysOffset() + capacity * sizeof(Key), SLOT_ALIGN);
+    }
+
+    BasicNode(bool isLeaf, int capacity) : isLeaf(isLeaf), size(0), capacity(capacity), ptr2next(nullptr) {}
+
+    unsigned char* bytes() { return reinterpret_cast<unsigned char*>(this); }
+    const unsigned char* bytes() const { return reinterpret_cast<const unsigned char*>(this); }
+};
+
+template <typename Key, typename Value, int Fanout>
+constexpr std::size_t BasicNode<Key, Value, Fanout>::allocationSize(bool isLeaf, int capacity) {
+    if (isLeaf) return roundUp(slotsOffset(capacity + PREFIX_SLOTS) + capacity * sizeof(Value), CACHE_LINE_SIZE);
+    return roundUp(slotsOffset(capacity) + (capacity + 1) * sizeof(BasicNode*), CACHE_LINE_SIZE);
+}
+
+template <typename Key, typename Value, int Fanout>
+void BasicNode<Key, Value, Fanout>::prefetch(const BasicNode* node, int capacity) {
+    /*
+		The capacity comes from the tree, reading node->capacity would be the very miss this is
+		meant to hide. A search only touches a few lines of a wide node, so at most
+		PREFETCH_LINES are asked for.
+	*/
+    const std::size_t keyBytes = keysOffset() + capacity * sizeof(Key);
+    const std::size_t lines = (keyBytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE;
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(node);
+    for (std::size_t line = 0; line < lines && line < PREFETCH_LINES; line++) prefetchLine(base + line * CACHE_LINE_SIZE);
+}
+
+template <typename Key, typename Value, int Fanout>
+BasicNode<Key, Value, Fanout>* BasicNode<Key, Value, Fanout>::construct(void* block, bool isLeaf, int capacity) {
+    /*
+		One aligned block per node, so the header and the first keys share a cache line and a
+		descent touches exactly one block per level. Every key (and leaf value) slot is
+		constructed up front, so the algorithms only ever assign into them.
+	*/
+    BasicNode* node = new (block) BasicNode(isLeaf, capacity);
+    const int keySlots = capacity + (isLeaf ? PREFIX_SLOTS : 0);
+    for (int i = 0; i < keySlots; i++) new (node->keys() + i) Key();
+    if (isLeaf) {
+        for (int i = 0; i < capacity; i++) new (node->dataPtr() + i) Value();
+    } else {
+        for (int i = 0; i <= capacity; i++) node->ptr2Tree()[i] = nullptr;
+    }
+    return node;
+}
+
+template <typename Key, typename Value, int Fanout>
+void BasicNode<Key, Value, Fanout>::destruct(BasicNode* node) {
+    // NOTE: values are destroyed, not interpreted. A FILE* stored by the caller is still the caller's to fclose.
+    if constexpr (!std::is_trivially_destructible_v<Key>) {
+        const int keySlots = node->capacity + (node->isLeaf ? PREFIX_SLOTS : 0);
+        for (int i = 0; i < keySlots; i++) node->keys()[i].~Key();
+    }
+    if constexpr (!std::is_trivially_destructible_v<Value>) {
+        if (node->isLeaf)
+            for (int i = 0; i < node->capacity; i++) node->dataPtr()[i].~Value();
+    }
+    node->~BasicNode();
+}
+
+}  // namespace bptree
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "bptree/node.hpp"
+
+namespace bptree {
+
+// Node memory of one tree, see BasicBPTree::getMemoryStats()
+struct MemoryStats {
+    std::size_t bytesReserved = 0;  // chunks the slabs obtained from the system allocator
+    std::size_t bytesInUse = 0;     // blocks holding live nodes
+    std::size_t leafNodes = 0;
+    std::size_t internalNodes = 0;
+    std::size_t chunks = 0;
+    std::size_t bytesMapped = 0;  // snapshot image the tree was opened from, not counted above
+};
+
+class NodeSlab {
+    /*
+		Fixed-size, cache-line-aligned blocks for the nodes of one tree, one slab per size class
+		(BasicBPTree keeps one for leaves and one for internal nodes).
+
+		::Chunks:=
+			Blocks are cut from chunks obtained from ::operator new, a bump pointer through the
+			newest one. Chunks start at FIRST_CHUNK_BLOCKS blocks and double up to MAX_CHUNK_BYTES,
+			so a small tree reserves little and a big one asks the system allocator only a handful
+			of times.
+
+		::Free list:=
+			A released block is pushed on an intrusive free list (the link lives in the block
+			itself) and handed out again before the bump pointer moves, so splits and merges under
+			churn recycle the same memory and never reach the system allocator.
+
+		Nothing is given back before the slab dies or is reset(), which frees every chunk at once
+		without looking at a single block: whatever still lives in them must need no destructor.
+	*/
+   public:
+    NodeSlab() = default;
+    explicit NodeSlab(std::size_t blockSize) : blockBytes(roundUp(std::max(blockSize, sizeof(FreeBlock)))) {}
+    ~NodeSlab() { reset(); }
+
+    NodeSlab(const NodeSlab&) = delete;
+    NodeSlab& operator=(const NodeSlab&) = delete;
+    NodeSlab(NodeSlab&& other) noexcept { swap(other); }
+    NodeSlab& operator=(NodeSlab&& other) noexcept {
+        NodeSlab(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void* allocate();
+    void release(void* block);
+    void reset();  // drop every chunk, all blocks handed out so far are gone
+
+    std::size_t blockSize() const { return blockBytes; }
+    std::size_t bytesReserved() const { return reserved; }          // chunks obtained from the system
+    std::size_t bytesInUse() const { return liveBlocks * blockBytes; }  // blocks handed out and not released
+    std::size_t liveCount() const { return liveBlocks; }
+    std::size_t chunkCount() const { return chunks.size(); }
+
+   private:
+    static constexpr std::size_t FIRST_CHUNK_BLOCKS = 16;
+    static constexpr std::size_t MAX_CHUNK_BYTES = std::size_t{1} << 20;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr std::size_t roundUp(std::size_t bytes) {
+        return (bytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    }
+
+    std::size_t blockBytes = 0;
+    std::vector<void*> chunks;
+    unsigned char* bump = nullptr;  // next never used block in the newest chunk
+    unsigned char* bumpEnd = nullptr;
+    FreeBlock* freeList = nullptr;
+    std::size_t nextChunkBlocks = FIRST_CHUNK_BLOCKS;
+    std::size_t reserved = 0;
+    std::size_t liveBlocks = 0;
+
+    void grow();
+    void swap(NodeSlab& other) noexcept;
+};
+
+inline void* NodeSlab::allocate() {
+    liveBlocks++;
+    if (freeList != nullptr) {
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+    if (bump == bumpEnd) grow();
+    void* block = bump;
+    bump += blockBytes;
+    return block;
+}
+
+inline void NodeSlab::release(void* block) {
+    FreeBlock* freed = new (block) FreeBlock{freeList};
+    freeList = freed;
+    liveBlocks--;
+}
+
+inline void NodeSlab::grow() {
+    // Chunks hold whole blocks, so the bump pointer ends exactly at bumpEnd
+    const std::size_t blocks = std::max<std::size_t>(1, std::min(nextChunkBlocks, MAX_CHUNK_BYTES / blockBytes));
+    const std::size_t bytes = blocks * blockBytes;
+    chunks.reserve(chunks.size() + 1);
+    bump = static_cast<unsigned char*>(::operator new(bytes, std::align_val_t(CACHE_LINE_SIZE)));
+    bumpEnd = bump + bytes;
+    chunks.push_back(bump);
+    reserved += bytes;
+    nextChunkBlocks = blocks * 2;
+}
+
+inline void NodeSlab::reset() {
+    for (void* chunk : chunks) ::operator delete(chunk, std::align_val_t(CACHE_LINE_SIZE));
+    chunks.clear();
+    bump = bumpEnd = nullptr;
+    freeList = nullptr;
+    nextChunkBlocks = FIRST_CHUNK_BLOCKS;
+    reserved = 0;
+    liveBlocks = 0;
+}
+
+inline void NodeSlab::swap(NodeSlab& other) noexcept {
+    std::swap(blockBytes, other.blockBytes);
+    chunks.swap(other.chunks);
+    std::swap(bump, other.bump);
+    std::swap(bumpEnd, other.bumpEnd);
+    std::swap(freeList, other.freeList);
+    std::swap(nextChunkBlocks, other.nextChunkBlocks);
+    std::swap(reserved, other.reserved);
+    std::swap(liveBlocks, other.liveBlocks);
+}
+
+}  // namespace bptree
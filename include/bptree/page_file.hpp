@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace bptree {
+
+using PageId = std::uint32_t;
+
+// Page 0 holds the file header, so no data page ever has id 0
+inline constexpr PageId INVALID_PAGE = 0;
+inline constexpr std::size_t DEFAULT_PAGE_SIZE = 4096;
+
+struct IoStats {
+    std::uint64_t pageReads = 0;
+    std::uint64_t pageWrites = 0;
+    std::uint64_t syncs = 0;
+};
+
+class PageFile {
+    /*
+		One file of fixed-size pages addressed by PageId:
+
+			| header | page 1 | page 2 | ... |
+
+		The header page keeps the page size, the #of pages, the head of the free list (a freed page
+		stores the id of the next free one in its first bytes) and META_SLOTS integers for whoever
+		owns the file, e.g. the root page of a tree. Freed pages are handed out again before the
+		file grows. The header is written back by sync() and on destruction.
+
+		Page sizes are multiples of 64 that hold the header and fit its 32-bit field. Opening an
+		existing file keeps the page size it was created with. Failures of the
+		underlying read/write/sync throw std::system_error, a file that is not a PageFile throws
+		std::runtime_error.
+	*/
+   public:
+    static constexpr int META_SLOTS = 16;
+
+    explicit PageFile(const std::string& path, std::size_t pageSize = DEFAULT_PAGE_SIZE);
+    ~PageFile();
+
+    PageFile(const PageFile&) = delete;
+    PageFile& operator=(const PageFile&) = delete;
+
+    std::size_t getPageSize() const;
+    PageId getPageCount() const;  // including the header page
+    bool isNew() const;           // created (not reopened) by the constructor
+
+    PageId allocatePage();  // a free page if there is one, else a new one at the end
+    void freePage(PageId id);
+    void readPage(PageId id, void* buffer);  // pages never written read back as zeros
+    void writePage(PageId id, const void* buffer);
+    void sync();  // write the header and flush everything to the device
+
+    std::uint64_t getMeta(int slot) const;
+    void setMeta(int slot, std::uint64_t value);
+
+    const IoStats& getIoStats() const;
+    void resetIoStats();
+
+   private:
+    struct Header {
+        char magic[8];
+        std::uint32_t pageSize;
+        std::uint32_t pageCount;
+        PageId freeHead;
+        std::uint32_t reserved;
+        std::uint64_t meta[META_SLOTS];
+    };
+
+    int fd;
+    std::size_t pageSize;
+    Header header;
+    bool created;
+    IoStats stats;
+
+    void readAt(std::uint64_t offset, void* buffer, std::size_t bytes);
+    void writeAt(std::uint64_t offset, const void* buffer, std::size_t bytes);
+    void writeHeader();
+};
+
+}  // namespace bptree
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "bptree/basic_bptree.hpp"
+#include "bptree/epoch.hpp"
+#include "bptree/node.hpp"
+
+namespace bptree {
+
+// One shard of a ShardedBPTree, see ShardedBPTree::getStats()
+struct ShardStats {
+    std::uint64_t keys = 0;
+    std::uint64_t ops = 0;  // find/insert/removeKey routed to it since the last rebalance()
+};
+
+struct ShardedStats {
+    std::uint64_t reroutes = 0;    // operations that found the fences moved under them and routed again
+    std::uint64_t rebalances = 0;  // fences moved by rebalance()
+    std::uint64_t movedKeys = 0;   // keys those moves took to a neighbouring shard
+    std::vector<ShardStats> shards;
+};
+
+template <typename Key, typename Value, typename Compare = std::less<Key>, int Fanout = DYNAMIC_FANOUT>
+class ShardedBPTree {
+    /*
+		A front end over N independent BasicBPTrees, each owning one contiguous range of the keys:
+
+			shard 0: [.., fences[0])   shard i: [fences[i-1], fences[i])   shard N-1: [fences[N-2], ..)
+
+		::Routing:=
+			Point operations binary search the fence array and then run on that shard alone under
+			its own mutex, so threads working on different ranges never touch the same lock, node
+			or cache line. With one shard per core and keys spread over the ranges, each core
+			effectively owns a tree of its own.
+
+		::Fences:=
+			The fences form an immutable Layout behind an atomic pointer. rebalance() builds a new
+			one while it holds the two shards whose boundary moves, publishes it and retires the
+			old one to an EpochManager, so the fences are read without a lock by any key type. An
+			operation that finds the layout changed once it holds its shard routes again.
+
+		::Scans:=
+			scan walks the shards in key order, one lock at a time, restarting each from the fence
+			where the previous one ended. Every key is seen as of the moment its shard was
+			scanned; there is no snapshot across shards. The visitor runs under the shard lock and
+			must not call back into the tree.
+
+		::Rebalancing:=
+			rebalance() moves the boundary between two neighbours into the busier one, handing
+			part of its range, keys included, to the quieter one. One call evens out every pair of
+			neighbours further apart than tolerance; the caller decides when, e.g. from a
+			housekeeping thread every few seconds.
+
+		insert replaces the value of a key that is already present, as ConcurrentBPTree's does.
+	*/
+   public:
+    using Tree = BasicBPTree<Key, Value, Compare, Fanout>;
+
+    // fences.size() + 1 shards, each a Tree(treeArgs...); fences have to be sorted by Compare
+    template <typename... TreeArgs>
+    explicit ShardedBPTree(std::vector<Key> fences, const TreeArgs&... treeArgs);
+    ~ShardedBPTree();  // NOT thread-safe, every other call must have returned
+
+    ShardedBPTree(const ShardedBPTree&) = delete;
+    ShardedBPTree& operator=(const ShardedBPTree&) = delete;
+
+    std::optional<Value> find(const Key& key) const;  // a copy, the shard may change right after
+    bool contains(const Key& key) const;
+    bool insert(const Key& key, const Value& value);  // false if key was present, its value is replaced
+    bool removeKey(const Key& key);                   // false if the key is absent
+
+    // visit(key, value) for every key in [lo, hi) in order, shard by shard
+    template <typename Visitor>
+    void scan(const Key& lo, const Key& hi, Visitor&& visit) const;
+
+    // Replace the contents with (key, value) pairs sorted by Compare, fences at the quantiles; false if unsorted
+    template <typename RandomIt>
+    bool bulkLoad(RandomIt first, RandomIt last, double fillFactor = 1.0, unsigned threads = 0);
+
+    // Even out the load of neighbouring shards, #of keys moved; one call at a time, next to any operation
+    std::size_t rebalance(double tolerance = 1.25);
+
+    std::size_t shardCount() const;
+    std::vector<Key> getFences() const;
+    std::uint64_t size() const;  // #of keys
+    ShardedStats getStats() const;
+
+   private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        template <typename... TreeArgs>
+        explicit Shard(const TreeArgs&... treeArgs) : tree(treeArgs...) {}
+
+        mutable std::mutex lock;  // guards everything below
+        Tree tree;
+        std::uint64_t keys = 0;
+        mutable std::uint64_t ops = 0;
+    };
+
+    struct Layout {
+        std::vector<Key> fences;  // fences[i] is the first key of shard i + 1
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<const Layout*> layout;
+    Compare comp;
+    mutable std::atomic<std::uint64_t> reroutes{0};
+    mutable std::mutex rebalanceLock;  // one rebalance()/bulkLoad() at a time, guards the counters below
+    std::uint64_t rebalances = 0;
+    std::uint64_t movedKeys = 0;
+    mutable EpochManager epochs;  // frees the layouts rebalance() replaced
+
+    std::size_t route(const Layout& current, const Key& key) const;  // shard whose range holds key
+    template <typename Op>
+    auto withShard(const Key& key, Op&& op) const;  // op(shard) under the lock of key's shard
+    void publish(std::vector<Key> fences);          // new layout, the old one retired
+    std::size_t moveBoundary(std::size_t left, double fraction, bool fromLeft);  // #of keys moved
+};
+
+}  // namespace bptree
+
+#include "bptree/impl/sharded_bptree.hpp"
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+/*
+	Vectorized intra-node key search for signed 32/64-bit integer keys.
+
+	A node's keys are sorted, so "how many keys are <= key" is just the number of lanes of a
+	vector compare that come out true: compare a block of keys against the broadcast key, turn
+	the lanes into a bitmask and popcount it. No branch depends on the key, so nothing is
+	mispredicted, which is what hurts std::upper_bound at our fanouts.
+
+	The kernel is picked at runtime (AVX2, then SSE4.2, else scalar) from the CPU features, the
+	functions are compiled with per-function target attributes so the rest of the build needs
+	no -mavx2. Large nodes are first narrowed to a WINDOW of keys by binary search, the window is
+	then counted with the vector kernel.
+*/
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BPTREE_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BPTREE_TARGET(isa)
+#else
+#define BPTREE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define BPTREE_SIMD_X86 0
+#endif
+
+namespace bptree {
+namespace simd {
+
+enum class Isa { SCALAR, SSE42, AVX2 };
+
+// Key/Compare pairs the kernels understand, anything else keeps the generic search
+template <typename Key, typename Compare>
+inline constexpr bool SUPPORTED = std::is_integral_v<Key> && std::is_signed_v<Key> &&
+                                  (sizeof(Key) == 4 || sizeof(Key) == 8) &&
+                                  (std::is_same_v<Compare, std::less<Key>> || std::is_same_v<Compare, std::less<>>);
+
+inline constexpr int WINDOW = 32;  // keys counted by one vector pass
+
+inline Isa detectIsa() {
+#if BPTREE_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 1);
+    bool sse42 = (regs[2] & (1 << 20)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx2 = false;
+    if (osxsave && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(regs, 7, 0);
+        avx2 = (regs[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse42 = __builtin_cpu_supports("sse4.2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return Isa::AVX2;
+    if (sse42) return Isa::SSE42;
+#endif
+    return Isa::SCALAR;
+}
+
+namespace detail {
+
+inline Isa activeIsa = detectIsa();
+
+inline int popcount(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<int>(__popcnt(mask));
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+#if BPTREE_SIMD_X86
+
+// #of keys[0..n) that are greater than key
+BPTREE_TARGET("avx2")
+inline int countGreaterAvx2(const std::int32_t* keys, int n, std::int32_t key) {
+    const __m256i needle = _mm256_set1_epi32(key);
+    int i = 0, count = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        count += popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(block, needle))));
+    }
+    if (i < n) {
+        // masked load never touches the lanes past n
+        int rest = n - i;
+        __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(rest), lanes);
+        __m256i block = _mm256_maskload_epi32(keys + i, mask);
+        unsigned bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(block, needle)));
+        count += popcount(bits & ((1u << rest) - 1));
+    }
+    return count;
+}
+
+BPTREE_TARGET("avx2")
+inline int countGreaterAvx2(const std::int64_t* keys, int n, std::int64_t key) {
+    const __m256i needle = _mm256_set1_epi64x(key);
+    int i = 0, count = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        count += popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(block, needle))));
+    }
+    if (i < n) {
+        int rest = n - i;
+        __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+        __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(rest), lanes);
+        __m256i block = _mm256_maskload_epi64(reinterpret_cast<const long long*>(keys + i), mask);
+        unsigned bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(block, needle)));
+        count += popcount(bits & ((1u << rest) - 1));
+    }
+    return count;
+}
+
+// #of keys[0..n) that are less than key
+BPTREE_TARGET("avx2")
+inline int countLessAvx2(const std::int32_t* keys, int n, std::int32_t key) {
+    const __m256i needle = _mm256_set1_epi32(key);
+    int i = 0, count = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        count += popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, block))));
+    }
+    if (i < n) {
+        int rest = n - i;
+        __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(rest), lanes);
+        __m256i block = _mm256_maskload_epi32(keys + i, mask);
+        unsigned bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, block)));
+        count += popcount(bits & ((1u << rest) - 1));
+    }
+    return count;
+}
+
+BPTREE_TARGET("avx2")
+inline int countLessAvx2(const std::int64_t* keys, int n, std::int64_t key) {
+    const __m256i needle = _mm256_set1_epi64x(key);
+    int i = 0, count = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        count += popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, block))));
+    }
+    if (i < n) {
+        int rest = n - i;
+        __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+        __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(rest), lanes);
+        __m256i block = _mm256_maskload_epi64(reinterpret_cast<const long long*>(keys + i), mask);
+        unsigned bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, block)));
+        count += popcount(bits & ((1u << rest) - 1));
+    }
+    return count;
+}
+
+// SSE4.2 has no masked load, the (< one vector) tail is done in scalar code
+BPTREE_TARGET("sse4.2")
+inline int countGreaterSse42(const std::int32_t* keys, int n, std::int32_t key) {
+    const __m128i needle = _mm_set1_epi32(key);
+    int i = 0, count = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        count += popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(block, needle))));
+    }
+    for (; i < n; i++) count += keys[i] > key;
+    return count;
+}
+
+BPTREE_TARGET("sse4.2")
+inline int countGreaterSse42(const std::int64_t* keys, int n, std::int64_t key) {
+    const __m128i needle = _mm_set1_epi64x(key);
+    int i = 0, count = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        count += popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(block, needle))));
+    }
+    for (; i < n; i++) count += keys[i] > key;
+    return count;
+}
+
+BPTREE_TARGET("sse4.2")
+inline int countLessSse42(const std::int32_t* keys, int n, std::int32_t key) {
+    const __m128i needle = _mm_set1_epi32(key);
+    int i = 0, count = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        count += popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(needle, block))));
+    }
+    for (; i < n; i++) count += keys[i] < key;
+    return count;
+}
+
+BPTREE_TARGET("sse4.2")
+inline int countLessSse42(const std::int64_t* keys, int n, std::int64_t key) {
+    const __m128i needle = _mm_set1_epi64x(key);
+    int i = 0, count = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        count += popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(needle, block))));
+    }
+    for (; i < n; i++) count += keys[i] < key;
+    return count;
+}
+
+#endif  // BPTREE_SIMD_X86
+
+// The kernels take the fixed-width type, int/long/long long map onto one of them
+template <typename Key>
+using Lane = std::conditional_t<sizeof(Key) == 4, std::int32_t, std::int64_t>;
+
+}  // namespace detail
+
+// Kernel in use; AVX2/SSE42 are only reported (and honoured by forceIsa) if the CPU has them
+inline Isa activeIsa() { return detail::activeIsa; }
+
+// Pin a kernel, e.g. Isa::SCALAR to benchmark against. Requests above the CPU are capped.
+inline void forceIsa(Isa isa) {
+    Isa best = detectIsa();
+    detail::activeIsa = static_cast<int>(isa) > static_cast<int>(best) ? best : isa;
+}
+
+// Position of the first key greater than key (std::upper_bound over keys[0..n))
+template <typename Key>
+int upperBound(const Key* keys, int n, Key key) {
+    using Lane = detail::Lane<Key>;
+    const Lane* lanes = reinterpret_cast<const Lane*>(keys);
+    if (detail::activeIsa == Isa::SCALAR) {
+        return static_cast<int>(std::upper_bound(keys, keys + n, key) - keys);
+    }
+    int lo = 0, hi = n;  // the answer lies in [lo, hi]
+    while (hi - lo > WINDOW) {
+        int mid = lo + (hi - lo) / 2;
+        bool notGreater = !(key < keys[mid]);
+        lo = notGreater ? mid + 1 : lo;
+        hi = notGreater ? hi : mid;
+    }
+#if BPTREE_SIMD_X86
+    int greater = detail::activeIsa == Isa::AVX2
+                      ? detail::countGreaterAvx2(lanes + lo, hi - lo, static_cast<Lane>(key))
+                      : detail::countGreaterSse42(lanes + lo, hi - lo, static_cast<Lane>(key));
+    return hi - greater;
+#else
+    (void)lanes;
+    return static_cast<int>(std::upper_bound(keys + lo, keys + hi, key) - keys);
+#endif
+}
+
+// Position of the first key not less than key (std::lower_bound over keys[0..n))
+template <typename Key>
+int lowerBound(const Key* keys, int n, Key key) {
+    using Lane = detail::Lane<Key>;
+    const Lane* lanes = reinterpret_cast<const Lane*>(keys);
+    if (detail::activeIsa == Isa::SCALAR) {
+        return static_cast<int>(std::lower_bound(keys, keys + n, key) - keys);
+    }
+    int lo = 0, hi = n;
+    while (hi - lo > WINDOW) {
+        int mid = lo + (hi - lo) / 2;
+        bool less = keys[mid] < key;
+        lo = less ? mid + 1 : lo;
+        hi = less ? hi : mid;
+    }
+#if BPTREE_SIMD_X86
+    int less = detail::activeIsa == Isa::AVX2
+                   ? detail::countLessAvx2(lanes + lo, hi - lo, static_cast<Lane>(key))
+                   : detail::countLessSse42(lanes + lo, hi - lo, static_cast<Lane>(key));
+    return lo + less;
+#else
+    (void)lanes;
+    return static_cast<int>(std::lower_bound(keys + lo, keys + hi, key) - keys);
+#endif
+}
+
+}  // namespace simd
+}  // namespace bptree
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+	Instrumentation of BasicBPTree: operation counters and an optional per-event callback. Build
+	with BPTREE_TRACING=0 (CMake: -DBPTREE_TRACING=OFF) and every hook becomes an empty
+	if constexpr, the structural code paths carry no counting and no callback check at all.
+*/
+#ifndef BPTREE_TRACING
+#define BPTREE_TRACING 1
+#endif
+
+namespace bptree {
+
+inline constexpr bool TRACING = BPTREE_TRACING;
+
+// Structural steps reported to the event callback, with the key the step was about
+enum class TreeEvent {
+    ROOT_CREATED,           // first key went into a new root leaf
+    LEAF_INSERT,            // key placed in a leaf without a split
+    LEAF_SPLIT,             // leaf overflowed, key is the separator copied up
+    INTERNAL_INSERT,        // separator placed in an internal node without a split
+    INTERNAL_SPLIT,         // internal node overflowed, key is the separator moved up
+    ROOT_SPLIT,             // the split reached the root, the tree grew one level
+    KEY_NOT_FOUND,          // removeKey of an absent key (or of anything in an empty tree)
+    LEAF_DELETE,            // key removed from its leaf
+    TREE_EMPTIED,           // the last key is gone, the root leaf with it
+    LEAF_UNDERFLOW,         // leaf dropped below half, redistribution starts
+    LEAF_BORROW_LEFT,       // leaf took the largest key of its left sibling
+    LEAF_BORROW_RIGHT,      // leaf took the smallest key of its right sibling
+    LEAF_MERGE,             // two sibling leaves became one
+    INTERNAL_DELETE,        // separator removed from an internal node after a merge below
+    INTERNAL_UNDERFLOW,     // internal node dropped below half
+    INTERNAL_BORROW_LEFT,   // key rotated in from the left sibling through the parent
+    INTERNAL_BORROW_RIGHT,  // key rotated in from the right sibling through the parent
+    INTERNAL_MERGE,         // two sibling internal nodes became one
+    ROOT_COLLAPSED,         // the root lost its last separator, the tree shrank one level
+    RANGE_DELETE,           // removeRange took out at least one key, key is the lower bound
+};
+
+/*
+	Running totals since construction (or the last resetStats()). keyComparisons counts what the
+	intra-node searches compare, a vectorized pass counts each key in its window.
+*/
+struct TreeStats {
+    std::uint64_t nodeVisits = 0;      // nodes entered by descents
+    std::uint64_t keyComparisons = 0;  // keys compared inside nodes
+    std::uint64_t leafSplits = 0;
+    std::uint64_t internalSplits = 0;
+    std::uint64_t leafMerges = 0;
+    std::uint64_t internalMerges = 0;
+    std::uint64_t leafBorrows = 0;
+    std::uint64_t internalBorrows = 0;
+    std::uint64_t rootChanges = 0;  // root created, split, collapsed or emptied
+    std::uint64_t appends = 0;      // inserts that went straight to the cached rightmost leaf
+
+    void count(TreeEvent event) {
+        switch (event) {
+            case TreeEvent::LEAF_SPLIT: leafSplits++; break;
+            case TreeEvent::INTERNAL_SPLIT: internalSplits++; break;
+            case TreeEvent::LEAF_MERGE: leafMerges++; break;
+            case TreeEvent::INTERNAL_MERGE: internalMerges++; break;
+            case TreeEvent::LEAF_BORROW_LEFT:
+            case TreeEvent::LEAF_BORROW_RIGHT: leafBorrows++; break;
+            case TreeEvent::INTERNAL_BORROW_LEFT:
+            case TreeEvent::INTERNAL_BORROW_RIGHT: internalBorrows++; break;
+            case TreeEvent::ROOT_CREATED:
+            case TreeEvent::ROOT_SPLIT:
+            case TreeEvent::ROOT_COLLAPSED:
+            case TreeEvent::TREE_EMPTIED: rootChanges++; break;
+            default: break;
+        }
+    }
+};
+
+}  // namespace bptree
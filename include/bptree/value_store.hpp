@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bptree {
+
+// Where a value lives in a ValueStore: 8 bytes and trivially copyable, so a leaf can hold it as value
+struct ValueRef {
+    std::uint64_t offset = 0;  // 0 is the store header, never a value
+
+    bool operator==(const ValueRef& other) const { return offset == other.offset; }
+    bool operator!=(const ValueRef& other) const { return !(*this == other); }
+};
+
+class ValueStore {
+    /*
+		Values appended to one memory-mapped file, read back as std::string_view pointing straight
+		into the mapping: a get() is pointer arithmetic and a length load, no syscall, no copy.
+
+			| header | len erased bytes... pad | len erased bytes... pad | ... |
+
+		::Segments:=
+			The file grows one segment (segmentSize bytes, 64 MiB by default) at a time and every
+			segment is mapped on its own, once, for the lifetime of the store. Mapped memory never
+			moves, so a view handed out stays valid until the store is destroyed, appends included.
+			No value straddles two segments: one that does not fit in what is left of the current
+			segment starts the next one. Values larger than maxValueSize() throw
+			std::invalid_argument.
+
+		::Erasing:=
+			erase() only flags the value, get() returns nullopt for it afterwards. The bytes stay
+			where they are (views of it remain readable) and are counted in getDeadBytes(); the
+			store is append-only and never reuses space.
+
+		The header (end of the data, #of values, dead bytes) lives in the mapping as well, so it is
+		on disk with everything else after sync(). Failures of the underlying calls throw
+		std::system_error, a file that is not a ValueStore throws std::runtime_error. Not
+		thread-safe: concurrent get()s are fine, anything else needs outside locking.
+	*/
+   public:
+    static constexpr std::size_t DEFAULT_SEGMENT_SIZE = std::size_t{64} << 20;
+
+    // segmentSize: a power of two of at least 64 KiB; an existing file keeps the size it was created with
+    explicit ValueStore(const std::string& path, std::size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+    ~ValueStore();
+
+    ValueStore(const ValueStore&) = delete;
+    ValueStore& operator=(const ValueStore&) = delete;
+
+    ValueRef append(std::string_view value);
+    std::optional<std::string_view> get(ValueRef ref) const;  // nullopt for an erased value or one past the end
+    bool erase(ValueRef ref);                                 // false if there was no value
+
+    void sync();  // flush the mapped segments to the device
+
+    std::uint64_t size() const;         // #of values not erased
+    std::uint64_t getDataBytes() const; // end of the data, header and padding included
+    std::uint64_t getDeadBytes() const; // records of erased values and segment tails left unused
+    std::size_t getSegmentSize() const;
+    std::size_t getSegmentCount() const;
+    std::size_t maxValueSize() const;
+
+   private:
+    struct Header {
+        char magic[8];
+        std::uint64_t segmentSize;
+        std::uint64_t end;  // offset the next value goes to
+        std::uint64_t values;
+        std::uint64_t deadBytes;
+    };
+
+    struct RecordHeader {
+        std::uint32_t length;
+        std::uint32_t erased;
+    };
+
+    static constexpr std::size_t ALIGNMENT = 8;
+    static constexpr std::size_t DATA_START = 64;  // the header, rounded up to a cache line
+
+#ifdef _WIN32
+    void* file;
+    std::vector<void*> mappings;  // one file mapping object per segment
+#else
+    int fd;
+#endif
+    std::size_t segmentBytes;
+    int segmentShift;
+    std::vector<unsigned char*> segments;  // mapped base address of every segment
+
+    Header* header() const { return reinterpret_cast<Header*>(segments.front()); }
+    const RecordHeader* record(ValueRef ref) const;  // NULL if ref does not point at a record
+    void addSegment();                               // grow the file by one segment and map it
+    void unmapAll();
+};
+
+}  // namespace bptree
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace bptree {
+
+class VersionLatch {
+    /*
+		Optimistic latch of one node: a single word holding a version counter, a LOCKED bit and an
+		OBSOLETE bit. Readers never write it. They remember the version, read the node and then
+		validate() that the version is still the same; if it is not, a writer got in between and
+		whatever they read has to be thrown away. Writers take the LOCKED bit with a compare and
+		swap against the version they read on the way down (tryUpgrade), so a node that changed
+		since is never locked on stale information, and unlocking bumps the counter. A node cut
+		out of the tree is unlocked as OBSOLETE and fails every later readLock().
+
+		Nothing ever waits for a reader, and writers never block on a latch: a failed try means
+		"restart the operation", which keeps lock order out of the picture.
+	*/
+   public:
+    // Waits out a writer and hands out the version, false if the node was cut out of the tree
+    bool readLock(std::uint64_t& version) const {
+        for (int spins = 0;; spins++) {
+            version = word.load(std::memory_order_acquire);
+            if ((version & LOCKED) == 0) return (version & OBSOLETE) == 0;
+            if (spins >= SPINS_BEFORE_YIELD) std::this_thread::yield();
+        }
+    }
+
+    /*
+		Nothing changed since readLock() handed out version, so the reads in between were
+		consistent. The fence keeps those reads ahead of the second look at the word, and pairs
+		with the one in tryUpgrade: a reader that saw anything a writer stored after locking
+		sees the lock here. Reads of payload the caller cannot make atomic (keys and values of
+		any trivially copyable type) race with the writer by design, as in a seqlock: a torn
+		copy only lives until validate() says no, it is never dereferenced or handed out. Data
+		race detectors report them anyway, tests/tsan.supp lists exactly those readers.
+	*/
+    bool validate(std::uint64_t version) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return word.load(std::memory_order_relaxed) == version;
+    }
+
+    // Lock the node if it still is at version, the caller restarts otherwise
+    bool tryUpgrade(std::uint64_t version) {
+        if (!word.compare_exchange_strong(version, version + LOCKED, std::memory_order_acquire)) return false;
+        std::atomic_thread_fence(std::memory_order_release);  // no store of the writer shows before the LOCKED bit
+        return true;
+    }
+
+    // Lock the node if no one holds it
+    bool tryLock() {
+        std::uint64_t version = word.load(std::memory_order_relaxed);
+        return (version & (LOCKED | OBSOLETE)) == 0 && tryUpgrade(version);
+    }
+
+    void unlock() { word.fetch_add(LOCKED, std::memory_order_release); }           // next version
+    void unlockObsolete() { word.fetch_add(LOCKED | OBSOLETE, std::memory_order_release); }
+
+    bool isLocked() const { return (word.load(std::memory_order_relaxed) & LOCKED) != 0; }
+
+   private:
+    static constexpr std::uint64_t OBSOLETE = 1;
+    static constexpr std::uint64_t LOCKED = 2;  // adding it twice carries into the counter
+    static constexpr int SPINS_BEFORE_YIELD = 64;
+
+    std::atomic<std::uint64_t> word{0};
+};
+
+}  // namespace bptree
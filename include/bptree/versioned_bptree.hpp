@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "bptree/node.hpp"
+#include "bptree/node_slab.hpp"
+#include "bptree/simd_search.hpp"
+
+namespace bptree {
+
+struct VersionedStats {
+    std::uint64_t version = 0;         // of the newest tree, one per write
+    std::uint64_t openSnapshots = 0;
+    std::uint64_t copiedNodes = 0;     // written by writers: path copies and the new nodes of splits
+    std::uint64_t retiredNodes = 0;    // replaced or cut out by a later version
+    std::uint64_t freedNodes = 0;      // of those, freed once no open snapshot could see them
+    std::uint64_t retiredBacklog = 0;  // retired but not freed yet
+};
+
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class VersionedBPTree {
+    /*
+		A B+ Tree whose versions never change once published: every write copies the nodes it
+		would have changed in place (the root-to-leaf path, plus the siblings a borrow or merge
+		touches) into new ones and publishes the new root as the next version. A Snapshot pins
+		one root, and everything reachable from it stays exactly as it was for as long as the
+		snapshot is open, so a scan of any length sees the tree at one point in time while writers
+		carry on.
+
+		::Readers:=
+			snapshot() registers the newest version and hands out its root; that takes one short
+			mutex, the same one a writer holds while it swaps the root. Nothing a reader looks at
+			is ever written again, so there is no validation and no retry. find, contains and scan
+			on the tree itself run on a snapshot of their own.
+
+		::Writers:=
+			insert and removeKey are serialized by a writer mutex and never wait for a reader.
+			Nodes a write created are changed in place for the rest of that write, so one write
+			copies each node at most once. There is no leaf chain: a copied leaf would drag its
+			left neighbour into the copy, and that one its own, so scans go leaf to leaf through
+			the parents instead.
+
+		::Reclamation:=
+			A node is live from the version that created it until the version that replaced it.
+			Once replaced it is retired, and freed as soon as no open snapshot has a version inside
+			that interval: a snapshot held for minutes keeps the nodes of its own tree, not the
+			ones created and replaced by the writes after it. Writers free in batches, collect()
+			on demand, into per-tree NodeSlabs that the next writes take their copies from.
+
+		Nodes are raw blocks copied key by key, so keys and values have to be trivially copyable.
+		Snapshots must be released before the tree is destroyed. insert replaces the value of a
+		key that is already present.
+	*/
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "nodes are raw blocks, copied without constructors or destructors");
+    static_assert(alignof(Key) <= CACHE_LINE_SIZE && alignof(Value) <= CACHE_LINE_SIZE,
+                  "over-aligned keys/values are not supported");
+
+    struct Node;
+
+   public:
+    class Snapshot {
+        // One version of the tree, unchanged until the snapshot is released (destroyed or moved from)
+       public:
+        Snapshot(Snapshot&& other) noexcept;
+        Snapshot& operator=(Snapshot&& other) noexcept;
+        ~Snapshot();
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        const Value* find(const Key& key) const;  // NULL if absent, valid while the snapshot is open
+        bool contains(const Key& key) const;
+
+        // visit(key, value) for every key in [lo, hi) in order, straight out of the pinned nodes
+        template <typename Visitor>
+        void scan(const Key& lo, const Key& hi, Visitor&& visit) const;
+
+        std::uint64_t size() const { return count; }  // #of keys in this version
+        std::uint64_t getVersion() const { return version; }
+
+       private:
+        friend class VersionedBPTree;
+        Snapshot(const VersionedBPTree* tree, const Node* root, std::uint64_t version, std::uint64_t count)
+            : tree(tree), root(root), version(version), count(count) {}
+        void release();
+
+        const VersionedBPTree* tree;  // NULL once released
+        const Node* root;
+        std::uint64_t version;
+        std::uint64_t count;
+    };
+
+    VersionedBPTree();
+    VersionedBPTree(int degreeInternal, int degreeLeaf);
+    ~VersionedBPTree();  // no snapshot may be open, nothing else may be running
+
+    VersionedBPTree(const VersionedBPTree&) = delete;
+    VersionedBPTree& operator=(const VersionedBPTree&) = delete;
+
+    Snapshot snapshot() const;  // the newest version
+
+    std::optional<Value> find(const Key& key) const;
+    bool contains(const Key& key) const;
+    bool insert(const Key& key, const Value& value);  // false if key was present, its value is replaced
+    bool removeKey(const Key& key);                   // false if the key is absent
+
+    template <typename Visitor>
+    void scan(const Key& lo, const Key& hi, Visitor&& visit) const;  // on a snapshot of the newest version
+
+    std::uint64_t size() const;  // #of keys in the newest version
+    int getMaxIntChildLimit() const;
+    int getMaxLeafNodeLimit() const;
+    VersionedStats getStats() const;
+    std::size_t collect();  // free the retired nodes no open snapshot can see, #of nodes freed
+
+   private:
+    struct Node {
+        /*
+			| version isLeaf size capacity | keys[capacity] | children[capacity+1] OR values[capacity] |
+
+			One cache-line-aligned allocation like BasicNode. Only the write that created it
+			(version) ever changes it, and only before publishing.
+		*/
+        std::uint64_t version;
+        bool isLeaf;
+        int size;
+        int capacity;
+
+        static Node* create(void* block, bool isLeaf, int capacity, std::uint64_t version);
+        static std::size_t allocationSize(bool isLeaf, int capacity);
+
+        Key* keys() { return reinterpret_cast<Key*>(bytes() + keysOffset()); }
+        const Key* keys() const { return const_cast<Node*>(this)->keys(); }
+        Node** children() { return reinterpret_cast<Node**>(bytes() + slotsOffset(capacity)); }
+        Node* const* children() const { return const_cast<Node*>(this)->children(); }
+        Value* values() { return reinterpret_cast<Value*>(bytes() + slotsOffset(capacity)); }
+        const Value* values() const { return const_cast<Node*>(this)->values(); }
+
+       private:
+        static constexpr std::size_t roundUp(std::size_t bytes, std::size_t alignment) {
+            return (bytes + alignment - 1) / alignment * alignment;
+        }
+        static constexpr std::size_t SLOT_ALIGN = alignof(Node*) > alignof(Value) ? alignof(Node*) : alignof(Value);
+        static constexpr std::size_t keysOffset() { return roundUp(sizeof(Node), alignof(Key)); }
+        static constexpr std::size_t slotsOffset(int capacity) {
+            return roundUp(keysOffset() + capacity * sizeof(Key), SLOT_ALIGN);
+        }
+        unsigned char* bytes() { return reinterpret_cast<unsigned char*>(this); }
+    };
+
+    // Nodes on the way down of a write, each already copied into the version being written
+    static constexpr int MAX_HEIGHT = 64;
+    struct PathStep {
+        Node* node;
+        int child;
+    };
+    struct Path {
+        PathStep steps[MAX_HEIGHT];
+        int depth = 0;
+    };
+
+    // What one write replaced or cut out, retired when the write is published
+    struct Retired {
+        Node* node;
+        std::uint64_t replacedBy;  // the node is part of versions [node->version, replacedBy)
+    };
+    static constexpr std::size_t RECLAIM_BATCH = 64;
+
+    int maxIntChildLimit;  // Limiting #of children for internal Nodes!
+    int maxLeafNodeLimit;  // Limiting #of keys for leaf Nodes!!!
+    Compare comp;
+
+    std::mutex writeMutex;  // one write at a time, and every node allocated or freed
+    NodeSlab leafSlab, internalSlab;
+    // The write in progress, only touched under writeMutex
+    std::uint64_t writing = 0;
+    std::vector<Retired> replaced;
+    std::uint64_t copied = 0;
+
+    // Everything below is guarded by versionMutex
+    mutable std::mutex versionMutex;
+    Node* root;  // never NULL, an empty tree is one empty leaf
+    std::uint64_t version = 1;
+    std::uint64_t count = 0;
+    mutable std::map<std::uint64_t, std::uint64_t> open;  // version -> #of open snapshots of it
+    std::vector<Retired> retired;                         // in retirement order
+    std::size_t keptByLastCollect = 0;
+    std::uint64_t copiedCount = 0;
+    std::uint64_t retiredCount = 0;
+    std::uint64_t freedCount = 0;
+
+    int leafCapacity() const { return maxLeafNodeLimit + 1; }  // one spare slot for the overflowing key
+    int internalCapacity() const { return maxIntChildLimit; }  // maxIntChildLimit-1 keys + one spare
+    int minLeafKeys() const { return (maxLeafNodeLimit + 1) / 2; }
+    int minInternalKeys() const { return (maxIntChildLimit + 1) / 2 - 1; }
+
+    int upperBound(const Node* node, const Key& key) const;  //#of keys <= key
+    int lowerBound(const Node* node, const Key& key) const;  //#of keys <  key
+    bool equal(const Key& a, const Key& b) const { return !comp(a, b) && !comp(b, a); }
+    const Node* findLeaf(const Node* root, const Key& key) const;
+
+    Node* createNode(bool isLeaf);  // in the version being written
+    Node* copyNode(const Node* node);
+    void freeNode(Node* node);
+
+    // A write: copy the path to key into the next version, change it, publish it
+    Node* copyPath(const Key& key, Path& path, Node*& newRoot);  // the leaf
+    Node* own(Node* parent, int childIdx);  // parent's child, copied into the version being written
+    void retire(Node* node);
+    void publish(Node* newRoot, std::uint64_t newCount);
+    void splitLeaf(Node* leaf, Path& path, Node*& newRoot);
+    void rebalance(Node* cursor, Path& path, Node*& newRoot);
+    void removeChild(Node* parent, int childIdx);  // children()[childIdx] and the key left of it
+
+    void close(std::uint64_t snapshotVersion) const;
+    std::size_t collectLocked(std::vector<Node*>& freeable);
+};
+
+}  // namespace bptree
+
+#include "bptree/impl/versioned_bptree.hpp"
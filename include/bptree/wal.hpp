@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bptree {
+
+struct LogStats {
+    std::uint64_t records = 0;   // appended since the log was opened
+    std::uint64_t syncs = 0;     // group commits, one write and one fdatasync each
+    std::uint64_t bytes = 0;     // written by those commits
+    std::uint64_t replayed = 0;  // records found by replay()
+};
+
+class WriteAheadLog {
+    /*
+		Append-only log of opaque records, each framed as
+
+			| crc32 | length | lsn | type | payload[length] |
+
+		after an 8 byte file magic. append() only buffers the record and hands out its log sequence
+		number; waitDurable(lsn) returns once the record is on the device. Whoever waits first while
+		no flush is running becomes the leader: it takes every record buffered so far, writes them
+		with one write and one fdatasync, then wakes the others. Writers arriving during that sync
+		queue up for the next batch, so N concurrent committers share a handful of syncs instead of
+		paying N.
+
+		Opening the log checks every record and cuts the file at the first torn or corrupt one (a
+		crash in the middle of a batch), new records continue after the last intact LSN. replay()
+		hands the intact records back in LSN order; call it before appending. Nothing is ever
+		removed from the log, callers that checkpoint start a new file. I/O failures throw
+		std::system_error, a failed commit also fails every later one.
+	*/
+   public:
+    using Visitor = std::function<void(std::uint64_t lsn, std::uint8_t type, std::string_view payload)>;
+
+    explicit WriteAheadLog(const std::string& path);
+    ~WriteAheadLog();  // syncs what is still buffered
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    std::uint64_t replay(const Visitor& visit);  // #of records visited
+
+    std::uint64_t append(std::uint8_t type, std::string_view payload);  // buffered, not durable yet
+    void waitDurable(std::uint64_t lsn);
+    std::uint64_t commit(std::uint8_t type, std::string_view payload);  // append + waitDurable
+
+    std::uint64_t getDurableLsn() const;
+    LogStats getStats() const;
+
+   private:
+    static constexpr std::size_t RECORD_HEADER = 4 + 4 + 8 + 1;
+
+    int fd;
+    std::string path;
+    mutable std::mutex mutex;
+    std::condition_variable flushed;
+    std::vector<char> pending;  // encoded records not handed to a leader yet
+    std::uint64_t nextLsn = 1;
+    std::uint64_t durableLsn = 0;
+    bool flushing = false;
+    bool failed = false;
+    LogStats stats;
+
+    // Reads the file, visits (if asked) and counts the intact records, returns where they end
+    std::uint64_t scan(const Visitor* visit, std::uint64_t& lastLsn, std::uint64_t& count);
+    void writeAll(const char* data, std::size_t bytes);
+    void datasync();
+};
+
+}  // namespace bptree
@@ -0,0 +1,204 @@
+#include <cstring>
+#include <stdexcept>
+#include "bptree/buffer_pool.hpp"
+
+using namespace std;
+using namespace bptree;
+
+BufferPool::PageGuard::PageGuard(PageGuard&& other) noexcept : pool(other.pool), frame(other.frame) {
+    other.pool = nullptr;
+    other.frame = -1;
+}
+
+BufferPool::PageGuard& BufferPool::PageGuard::operator=(PageGuard&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        frame = other.frame;
+        other.pool = nullptr;
+        other.frame = -1;
+    }
+    return *this;
+}
+
+BufferPool::PageGuard::~PageGuard() {
+    release();
+}
+
+PageId BufferPool::PageGuard::id() const {
+    return pool->frames[frame].id;
+}
+
+unsigned char* BufferPool::PageGuard::data() const {
+    return pool->frameData(frame);
+}
+
+void BufferPool::PageGuard::markDirty() {
+    pool->frames[frame].dirty = true;
+}
+
+void BufferPool::PageGuard::release() {
+    if (pool != nullptr) {
+        pool->unpin(frame);
+        pool = nullptr;
+        frame = -1;
+    }
+}
+
+BufferPool::BufferPool(PageFile& file, size_t frameCount, EvictionPolicy policy)
+    : file(file), policy(policy), pageSize(file.getPageSize()), frames(frameCount) {
+    if (frameCount == 0) throw invalid_argument("a buffer pool needs at least one frame");
+    memory.reset(new unsigned char[frameCount * pageSize]);
+    for (int i = static_cast<int>(frameCount) - 1; i >= 0; i--) freeFrames.push_back(i);
+}
+
+BufferPool::~BufferPool() {
+    try {
+        for (size_t i = 0; i < frames.size(); i++)
+            if (frames[i].id != INVALID_PAGE && frames[i].dirty) writeBack(static_cast<int>(i));
+    } catch (const exception&) {
+        // flush() is the place to see write errors
+    }
+}
+
+BufferPool::PageGuard BufferPool::fetch(PageId id) {
+    auto it = pageTable.find(id);
+    if (it != pageTable.end()) {
+        stats.hits++;
+        pin(it->second);
+        return PageGuard(this, it->second);
+    }
+
+    stats.misses++;
+    int frame = takeFrame();
+    try {
+        file.readPage(id, frameData(frame));
+    } catch (...) {
+        freeFrames.push_back(frame);
+        throw;
+    }
+    frames[frame].id = id;
+    frames[frame].dirty = false;
+    pageTable[id] = frame;
+    pin(frame);
+    return PageGuard(this, frame);
+}
+
+BufferPool::PageGuard BufferPool::create() {
+    int frame = takeFrame();
+    PageId id = file.allocatePage();
+    memset(frameData(frame), 0, pageSize);
+    frames[frame].id = id;
+    frames[frame].dirty = true;
+    pageTable[id] = frame;
+    pin(frame);
+    return PageGuard(this, frame);
+}
+
+void BufferPool::release(PageId id) {
+    auto it = pageTable.find(id);
+    if (it != pageTable.end()) {
+        int frame = it->second;
+        if (frames[frame].pins > 0) throw logic_error("releasing a pinned page");
+        if (frames[frame].inLru) {
+            lru.erase(frames[frame].lruPos);
+            frames[frame].inLru = false;
+        }
+        frames[frame] = Frame();
+        freeFrames.push_back(frame);
+        pageTable.erase(it);
+    }
+    file.freePage(id);
+}
+
+void BufferPool::flush() {
+    for (size_t i = 0; i < frames.size(); i++)
+        if (frames[i].id != INVALID_PAGE && frames[i].dirty) writeBack(static_cast<int>(i));
+    file.sync();
+}
+
+PageFile& BufferPool::getFile() {
+    return file;
+}
+
+size_t BufferPool::getFrameCount() const {
+    return frames.size();
+}
+
+EvictionPolicy BufferPool::getPolicy() const {
+    return policy;
+}
+
+const PoolStats& BufferPool::getStats() const {
+    return stats;
+}
+
+void BufferPool::resetStats() {
+    stats = PoolStats();
+}
+
+unsigned char* BufferPool::frameData(int frame) const {
+    return memory.get() + static_cast<size_t>(frame) * pageSize;
+}
+
+int BufferPool::takeFrame() {
+    if (!freeFrames.empty()) {
+        int frame = freeFrames.back();
+        freeFrames.pop_back();
+        return frame;
+    }
+
+    int victim = -1;
+    if (policy == EvictionPolicy::LRU) {
+        if (!lru.empty()) {
+            victim = lru.front();
+            lru.pop_front();
+            frames[victim].inLru = false;
+        }
+    } else {
+        // One sweep clears every reference bit, if the next one finds nothing all frames are pinned
+        for (size_t step = 0; step < 2 * frames.size() + 1; step++) {
+            Frame& candidate = frames[hand];
+            int at = static_cast<int>(hand);
+            hand = (hand + 1) % frames.size();
+            if (candidate.pins > 0) continue;
+            if (candidate.referenced) {
+                candidate.referenced = false;
+                continue;
+            }
+            victim = at;
+            break;
+        }
+    }
+    if (victim < 0) throw runtime_error("buffer pool exhausted: every frame is pinned");
+
+    if (frames[victim].dirty) writeBack(victim);
+    pageTable.erase(frames[victim].id);
+    frames[victim] = Frame();
+    stats.evictions++;
+    return victim;
+}
+
+void BufferPool::pin(int frame) {
+    Frame& f = frames[frame];
+    if (f.inLru) {
+        lru.erase(f.lruPos);
+        f.inLru = false;
+    }
+    f.pins++;
+    f.referenced = true;
+}
+
+void BufferPool::unpin(int frame) {
+    Frame& f = frames[frame];
+    if (--f.pins == 0 && policy == EvictionPolicy::LRU) {
+        f.lruPos = lru.insert(lru.end(), frame);
+        f.inLru = true;
+    }
+}
+
+void BufferPool::writeBack(int frame) {
+    file.writePage(frames[frame].id, frameData(frame));
+    frames[frame].dirty = false;
+    stats.writeBacks++;
+}
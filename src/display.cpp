@@ -11,12 +11,12 @@ void BPTree::display(Node* cursor) {
 		Depth First Display
 
     if (cursor != NULL) {
-        for (int i = 0; i < cursor->keys.size(); i++)
-            cout << cursor->keys[i] << " ";
+        for (int i = 0; i < cursor->size; i++)
+            cout << cursor->keys()[i] << " ";
         cout << endl;
         if (cursor->isLeaf != true) {
-            for (int i = 0; i < cursor->ptr2TreeOrData.ptr2Tree.size(); i++)
-                display(cursor->ptr2TreeOrData.ptr2Tree[i]);
+            for (int i = 0; i <= cursor->size; i++)
+                display(cursor->child(i));
         }
     }
     */
@@ -34,14 +34,14 @@ void BPTree::display(Node* cursor) {
             Node* u = q.front(); q.pop();
 
             //printing keys in self
-            for (int val : u->keys)
-                cout << val << " ";
+            for (int j = 0; j < u->size; j++)
+                cout << u->keys()[j] << " ";
 
             cout << "|| ";//to seperate next adjacent nodes
             
             if (u->isLeaf != true) {
-                for (Node* v : u->ptr2TreeOrData.ptr2Tree) {
-                    q.push(v);
+                for (int j = 0; j <= u->size; j++) {
+                    q.push(u->child(j));
                 }
             }
         }
@@ -57,11 +57,11 @@ void BPTree::seqDisplay(Node* cursor) {
         return;
     }
     while (firstLeft != NULL) {
-        for (int i = 0; i < firstLeft->keys.size(); i++) {
-            cout << firstLeft->keys[i] << " ";
+        for (int i = 0; i < firstLeft->size; i++) {
+            cout << firstLeft->keys()[i] << " ";
         }
 
-        firstLeft = firstLeft->ptr2next;
+        firstLeft = firstLeft->next();
     }
     cout << endl;
 }
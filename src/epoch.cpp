@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include "bptree/epoch.hpp"
+
+using namespace std;
+using namespace bptree;
+
+EpochManager::EpochManager() : slots(new Slot[SLOTS]) {}
+
+EpochManager::~EpochManager() {
+    for (const Retired& r : retired) r.deleter(r.object);
+}
+
+EpochManager::Guard::Guard(EpochManager& manager) : slot(manager.pin()) {}
+
+EpochManager::Guard::~Guard() {
+    slot->store(IDLE, memory_order_release);
+}
+
+atomic<uint64_t>* EpochManager::pin() {
+    /*
+		Claim an idle slot, starting from the one this thread used last so threads keep to their
+		own cache lines. The epoch is announced and then checked again: had it moved in between, a
+		collect() could have skipped the slot, so the newer epoch is announced instead.
+	*/
+    thread_local size_t hint = hash<thread::id>()(this_thread::get_id());
+    for (;;) {
+        for (int i = 0; i < SLOTS; i++) {
+            size_t at = (hint + i) % SLOTS;
+            atomic<uint64_t>& slot = slots[at].pinned;
+            uint64_t idle = IDLE;
+            uint64_t current = epoch.load();
+            if (slot.load(memory_order_relaxed) != IDLE || !slot.compare_exchange_strong(idle, current)) continue;
+
+            for (uint64_t now = epoch.load(); now != current; now = epoch.load()) {
+                slot.store(now);
+                current = now;
+            }
+            hint = at;
+            return &slot;
+        }
+        this_thread::yield();  // every slot is taken, wait for a guard to close
+    }
+}
+
+bool EpochManager::tryAdvance() {
+    // Only once no open guard is still in an older epoch
+    uint64_t current = epoch.load();
+    for (int i = 0; i < SLOTS; i++) {
+        uint64_t pinned = slots[i].pinned.load();
+        if (pinned != IDLE && pinned != current) return false;
+    }
+    return epoch.compare_exchange_strong(current, current + 1);
+}
+
+void EpochManager::retire(void* object, Deleter deleter) {
+    bool due;
+    {
+        lock_guard<mutex> lock(retiredMutex);
+        retired.push_back({object, deleter, epoch.load()});
+        retiredCount++;
+        due = ++sinceCollect >= RECLAIM_BATCH;
+    }
+    if (due) collect();
+}
+
+size_t EpochManager::collect() {
+    unique_lock<mutex> pass(collectMutex, try_to_lock);
+    if (!pass.owns_lock()) return 0;
+
+    // Two steps if the readers allow, so this batch is not just tagged but freed in the same pass
+    if (tryAdvance()) tryAdvance();
+    const uint64_t current = epoch.load();
+
+    vector<Retired> ready;
+    {
+        lock_guard<mutex> lock(retiredMutex);
+        auto stillVisible = find_if(retired.begin(), retired.end(), [&](const Retired& r) { return r.epoch + 2 > current; });
+        ready.assign(retired.begin(), stillVisible);
+        retired.erase(retired.begin(), stillVisible);
+        sinceCollect = 0;
+        collections++;
+    }
+    for (const Retired& r : ready) r.deleter(r.object);
+
+    lock_guard<mutex> lock(retiredMutex);
+    freedCount += ready.size();
+    return ready.size();
+}
+
+EpochStats EpochManager::getStats() const {
+    lock_guard<mutex> lock(retiredMutex);
+    EpochStats stats;
+    stats.epoch = epoch.load(memory_order_relaxed);
+    stats.retired = retiredCount;
+    stats.freed = freedCount;
+    stats.backlog = retiredCount - freedCount;
+    stats.collections = collections;
+    return stats;
+}
@@ -0,0 +1,236 @@
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "bptree/heap_file.hpp"
+
+using namespace std;
+using namespace bptree;
+
+namespace {
+
+const uint64_t HEAP_SIGNATURE = (uint64_t{0x4850} << 48) | 1;  // "HP", layout version 1
+const size_t MAX_HEAP_PAGE_SIZE = 32768;                      // freeEnd has to fit 16 bits
+
+}  // namespace
+
+HeapFile::HeapFile(const string& path, size_t poolPages, EvictionPolicy eviction, size_t pageSize)
+    : file(path, pageSize), pool(file, poolPages, eviction) {
+    // Moving a page between lists pins it together with one neighbour at a time
+    if (poolPages < 4) throw invalid_argument("a heap file needs a pool of at least 4 pages");
+    if (file.getPageSize() > MAX_HEAP_PAGE_SIZE) throw invalid_argument("heap pages can be at most 32K");
+
+    if (file.isNew()) {
+        for (PageId& head : freeHead) head = INVALID_PAGE;
+        count = 0;
+        file.setMeta(META_SIGNATURE, HEAP_SIGNATURE);
+        saveMeta();
+    } else {
+        if (file.getMeta(META_SIGNATURE) != HEAP_SIGNATURE) throw runtime_error("not a heap file: " + path);
+        for (int c = 0; c < FREE_CLASSES; c++) freeHead[c] = static_cast<PageId>(file.getMeta(META_FREE_HEAD + c));
+        count = file.getMeta(META_RECORDS);
+    }
+}
+
+HeapFile::~HeapFile() {
+    try {
+        flush();
+    } catch (const exception&) {
+        // Call flush() first to see write errors
+    }
+}
+
+RecordId HeapFile::insert(string_view record) {
+    /*
+		Small records go to the fullest pages that surely take them. A record larger than every
+		list promises tries the head of the roomiest list, failing that it opens a new page.
+	*/
+    if (record.size() > maxRecordSize()) throw invalid_argument("record does not fit a heap page");
+
+    const size_t needed = record.size() + sizeof(Slot);
+    PageGuard page;
+    for (int c = 0; c < FREE_CLASSES && !page; c++)
+        if (freeHead[c] != INVALID_PAGE && classFloor(c) >= needed) page = pool.fetch(freeHead[c]);
+    for (int c = FREE_CLASSES - 1; c >= 0 && !page; c--) {
+        if (freeHead[c] == INVALID_PAGE) continue;
+        PageGuard head = pool.fetch(freeHead[c]);
+        if (fits(head, record.size())) page = std::move(head);
+        break;
+    }
+
+    if (!page) {
+        page = pool.create();
+        header(page)->freeEnd = static_cast<uint16_t>(file.getPageSize());
+    }
+
+    RecordId rid{page.id(), place(page, record)};
+    relist(page);
+    page.markDirty();
+    count++;
+    return rid;
+}
+
+optional<string> HeapFile::read(RecordId rid) {
+    if (rid.page == INVALID_PAGE || rid.page >= file.getPageCount()) return nullopt;
+
+    PageGuard page = pool.fetch(rid.page);
+    if (rid.slot >= header(page)->slotCount) return nullopt;
+    const Slot& slot = slots(page)[rid.slot];
+    if (slot.offset == 0) return nullopt;
+    return string(reinterpret_cast<const char*>(page.data() + slot.offset), slot.length);
+}
+
+bool HeapFile::erase(RecordId rid) {
+    if (rid.page == INVALID_PAGE || rid.page >= file.getPageCount()) return false;
+
+    PageGuard page = pool.fetch(rid.page);
+    PageHeader* h = header(page);
+    if (rid.slot >= h->slotCount) return false;
+    Slot* slot = slots(page);
+    if (slot[rid.slot].offset == 0) return false;
+
+    // Bytes right at the start of the record area go back to the gap, others wait for compact()
+    if (slot[rid.slot].offset == h->freeEnd)
+        h->freeEnd = static_cast<uint16_t>(h->freeEnd + slot[rid.slot].length);
+    else
+        h->fragmented = static_cast<uint16_t>(h->fragmented + slot[rid.slot].length);
+    slot[rid.slot] = Slot{0, 0};
+
+    while (h->slotCount > 0 && slot[h->slotCount - 1].offset == 0) h->slotCount--;
+    if (h->slotCount == 0) {
+        h->freeEnd = static_cast<uint16_t>(file.getPageSize());
+        h->fragmented = 0;
+    }
+
+    relist(page);
+    page.markDirty();
+    count--;
+    return true;
+}
+
+void HeapFile::flush() {
+    saveMeta();
+    pool.flush();
+}
+
+uint64_t HeapFile::size() const {
+    return count;
+}
+
+size_t HeapFile::maxRecordSize() const {
+    return file.getPageSize() - sizeof(PageHeader) - sizeof(Slot);
+}
+
+BufferPool& HeapFile::getPool() {
+    return pool;
+}
+
+PageFile& HeapFile::getFile() {
+    return file;
+}
+
+size_t HeapFile::classFloor(int freeClass) const {
+    return (file.getPageSize() / 8) << freeClass;
+}
+
+int HeapFile::classOf(const PageGuard& page) const {
+    size_t free = freeSpace(page);
+    for (int c = FREE_CLASSES - 1; c >= 0; c--)
+        if (free >= classFloor(c)) return c;
+    return -1;
+}
+
+size_t HeapFile::gap(const PageGuard& page) const {
+    const PageHeader* h = header(page);
+    return h->freeEnd - sizeof(PageHeader) - h->slotCount * sizeof(Slot);
+}
+
+size_t HeapFile::freeSpace(const PageGuard& page) const {
+    return gap(page) + header(page)->fragmented;
+}
+
+int HeapFile::freeSlot(const PageGuard& page) const {
+    const Slot* slot = slots(page);
+    for (int i = 0; i < header(page)->slotCount; i++)
+        if (slot[i].offset == 0) return i;
+    return -1;
+}
+
+bool HeapFile::fits(const PageGuard& page, size_t length) const {
+    size_t needed = length + (freeSlot(page) < 0 ? sizeof(Slot) : 0);
+    return needed <= freeSpace(page);
+}
+
+void HeapFile::compact(PageGuard& page) {
+    // Repack the live records against the end of the page, slot numbers stay as they are
+    const size_t pageSize = file.getPageSize();
+    vector<unsigned char> copy(page.data(), page.data() + pageSize);
+    PageHeader* h = header(page);
+    Slot* slot = slots(page);
+    size_t end = pageSize;
+    for (int i = 0; i < h->slotCount; i++) {
+        if (slot[i].offset == 0) continue;
+        end -= slot[i].length;
+        memcpy(page.data() + end, copy.data() + slot[i].offset, slot[i].length);
+        slot[i].offset = static_cast<uint16_t>(end);
+    }
+    h->freeEnd = static_cast<uint16_t>(end);
+    h->fragmented = 0;
+}
+
+uint32_t HeapFile::place(PageGuard& page, string_view record) {
+    // The caller checked fits()
+    int idx = freeSlot(page);
+    size_t needed = record.size() + (idx < 0 ? sizeof(Slot) : 0);
+    if (gap(page) < needed) compact(page);
+
+    PageHeader* h = header(page);
+    if (idx < 0) idx = h->slotCount++;
+    h->freeEnd = static_cast<uint16_t>(h->freeEnd - record.size());
+    if (!record.empty()) memcpy(page.data() + h->freeEnd, record.data(), record.size());
+    slots(page)[idx] = Slot{h->freeEnd, static_cast<uint16_t>(record.size())};
+    return static_cast<uint32_t>(idx);
+}
+
+void HeapFile::link(PageGuard& page, int freeClass) {
+    PageHeader* h = header(page);
+    h->freeClass = static_cast<uint16_t>(freeClass + 1);
+    h->prevFree = INVALID_PAGE;
+    h->nextFree = freeHead[freeClass];
+    if (h->nextFree != INVALID_PAGE) {
+        PageGuard next = pool.fetch(h->nextFree);
+        header(next)->prevFree = page.id();
+        next.markDirty();
+    }
+    freeHead[freeClass] = page.id();
+}
+
+void HeapFile::unlink(PageGuard& page) {
+    PageHeader* h = header(page);
+    if (h->prevFree != INVALID_PAGE) {
+        PageGuard prev = pool.fetch(h->prevFree);
+        header(prev)->nextFree = h->nextFree;
+        prev.markDirty();
+    } else {
+        freeHead[h->freeClass - 1] = h->nextFree;
+    }
+    if (h->nextFree != INVALID_PAGE) {
+        PageGuard next = pool.fetch(h->nextFree);
+        header(next)->prevFree = h->prevFree;
+        next.markDirty();
+    }
+    h->freeClass = 0;
+    h->prevFree = INVALID_PAGE;
+    h->nextFree = INVALID_PAGE;
+}
+
+void HeapFile::relist(PageGuard& page) {
+    int freeClass = classOf(page);
+    if (freeClass + 1 == header(page)->freeClass) return;
+    if (header(page)->freeClass != 0) unlink(page);
+    if (freeClass >= 0) link(page, freeClass);
+}
+
+void HeapFile::saveMeta() {
+    file.setMeta(META_RECORDS, count);
+    for (int c = 0; c < FREE_CLASSES; c++) file.setMeta(META_FREE_HEAD + c, freeHead[c]);
+}
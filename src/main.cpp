@@ -21,19 +21,8 @@ void insertionMethod(BPTree** bPTree) {
     cout << "\nWhat's the Name, Age and Marks acquired?: ";
     cin >> name >> age >> marks;
 
-    string fileName = "DBFiles/";
-    fileName += to_string(rollNo) + ".txt";
-    FILE* filePtr = fopen(fileName.c_str(), "w");
-    if (filePtr == NULL) {
-        cout << "Error: Could not create file " << fileName << endl;
-        return;
-    }
-    string userTuple = name + " " + to_string(age) + " " + to_string(marks) + "\n";
-    fprintf(filePtr, "%s", userTuple.c_str());
-    //fclose(filePtr);
-
-    (*bPTree)->insert(rollNo, filePtr);
-    fclose(filePtr);
+    string userTuple = name + " " + to_string(age) + " " + to_string(marks);
+    (*bPTree)->insertTuple(rollNo, userTuple);
     cout << "Insertion of roll No: " << rollNo << " Successful"<<endl;
 }
 
@@ -70,11 +59,28 @@ void deleteMethod(BPTree* bPTree) {
     bPTree->display(bPTree->getRoot());
 }
 
-int main() {
+void rangeDeleteMethod(BPTree* bPTree) {
+    int lo, hi;
+    cout << "Enter the first key to delete and the key to stop before: " << endl;
+    cin >> lo >> hi;
+    bPTree->removeRange(lo, hi);
+
+    //Displaying
+    bPTree->display(bPTree->getRoot());
+}
+
+int main(int argc, char* argv[]) {
     /*
 		Please have a look at the default schema to get to know about the table
 		Reference - img/database.jpg
+
+		With --wal every insert and delete is logged to DBFiles/tuples.wal first and the next
+		start replays the log, otherwise each run begins with an empty table. Every run saves the
+		index to DBFiles/tuples.idx on the way out, and --open starts from that instead (the
+		limits are the saved ones then).
 	*/
+    bool durable = argc > 1 && string(argv[1]) == "--wal";
+    bool reopen = argc > 1 && string(argv[1]) == "--open";
 
     cout << "\n***Welcome to DATABASE SERVER**\n"
          << endl;
@@ -82,17 +88,30 @@ int main() {
     bool flag = true;
     int option;
 
-    int maxChildInt = 4, maxNodeLeaf = 3;
-    cout << "Please provide the value to limit maximum child Internal Nodes can have: ";
-    cin >> maxChildInt;
-    cout << "\nAnd Now Limit the value to limit maximum Nodes Leaf Nodes can have: ";
-    cin >> maxNodeLeaf;
-
-    BPTree* bPTree = new BPTree(maxChildInt, maxNodeLeaf);
+    BPTree* bPTree = NULL;
+    if (reopen) {
+        try {
+            bPTree = BPTree::open().release();
+        } catch (const exception& e) {
+            cout << "Could not open " << BPTree::INDEX_FILE << ": " << e.what() << endl;
+            return 1;
+        }
+        cout << "Opened the index saved in " << BPTree::INDEX_FILE << endl;
+    } else {
+        int maxChildInt = 4, maxNodeLeaf = 3;
+        cout << "Please provide the value to limit maximum child Internal Nodes can have: ";
+        cin >> maxChildInt;
+        cout << "\nAnd Now Limit the value to limit maximum Nodes Leaf Nodes can have: ";
+        cin >> maxNodeLeaf;
+
+        bPTree = new BPTree(maxChildInt, maxNodeLeaf, BPTree::TUPLE_FILE, durable ? BPTree::LOG_FILE : "");
+        if (durable)
+            cout << "\nRecovered " << bPTree->getLog()->getStats().replayed << " logged changes from " << BPTree::LOG_FILE << endl;
+    }
 
     do {
         cout << "\nPlease provide the queries with respective keys : " << endl;
-        cout << "\tPress 1: Insertion \n\tPress 2: Search \n\tPress 3: Print Tree\n\tPress 4: Delete Key In Tree\n\tPress 5: ABORT!" << endl;
+        cout << "\tPress 1: Insertion \n\tPress 2: Search \n\tPress 3: Print Tree\n\tPress 4: Delete Key In Tree\n\tPress 5: ABORT!\n\tPress 6: Delete Keys In A Range" << endl;
         cin >> option;
 
         switch (option) {
@@ -108,11 +127,17 @@ int main() {
             case 4:
                 deleteMethod(bPTree);
                 break;
+            case 6:
+                rangeDeleteMethod(bPTree);
+                break;
             default:
                 flag = false;
                 break;
         }
     }while (flag);
 
+    bPTree->save();  // writes the tuple pages back to DBFiles/tuples.db, then the index next to them
+    cout << "Saved the index to " << BPTree::INDEX_FILE << endl;
+    delete bPTree;
     return 0;
 }
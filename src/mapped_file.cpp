@@ -0,0 +1,85 @@
+#include <cerrno>
+#include <system_error>
+#include "bptree/mapped_file.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace bptree;
+
+namespace {
+
+[[noreturn]] void ioError(const char* what) {
+#ifdef _WIN32
+    throw system_error(static_cast<int>(GetLastError()), system_category(), what);
+#else
+    throw system_error(errno, generic_category(), what);
+#endif
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const string& path) {
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) ioError("open mapped file");
+    mapping = NULL;
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(file, &length)) {
+        CloseHandle(file);
+        ioError("stat mapped file");
+    }
+    bytes = static_cast<size_t>(length.QuadPart);
+    if (bytes == 0) return;
+    mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    void* view = mapping == NULL ? NULL : MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (view == NULL) {
+        const DWORD error = GetLastError();
+        if (mapping != NULL) CloseHandle(mapping);
+        CloseHandle(file);
+        throw system_error(static_cast<int>(error), system_category(), "map file");
+    }
+    base = static_cast<unsigned char*>(view);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) ioError("open mapped file");
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw system_error(error, generic_category(), "stat mapped file");
+    }
+    bytes = static_cast<size_t>(info.st_size);
+    if (bytes > 0) {
+        // MAP_PRIVATE: writes land in pages of our own, the mapping outlives the descriptor
+        void* view = ::mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            const int error = errno;
+            ::close(fd);
+            throw system_error(error, generic_category(), "map file");
+        }
+        base = static_cast<unsigned char*>(view);
+    }
+    ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (base != nullptr) UnmapViewOfFile(base);
+    if (mapping != NULL) CloseHandle(mapping);
+    CloseHandle(file);
+#else
+    if (base != nullptr) ::munmap(base, bytes);
+#endif
+}
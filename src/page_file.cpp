@@ -0,0 +1,193 @@
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include "bptree/page_file.hpp"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace bptree;
+
+namespace {
+
+const char PAGE_FILE_MAGIC[8] = {'B', 'P', 'T', 'P', 'A', 'G', 'E', '1'};
+
+[[noreturn]] void ioError(const char* what) {
+    throw system_error(errno, generic_category(), what);
+}
+
+}  // namespace
+
+PageFile::PageFile(const string& path, size_t pageSize) : pageSize(pageSize), header(), created(false) {
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+#endif
+    if (fd < 0) ioError("open page file");
+
+    try {
+        readAt(0, &header, sizeof(header));
+        if (header.pageCount == 0) {
+            // Nothing there yet: lay down a fresh header, which keeps the page size in 32 bits
+            if (pageSize < sizeof(Header) || pageSize % 64 != 0 || pageSize > UINT32_MAX)
+                throw invalid_argument(
+                    "page size must be a multiple of 64 below 4 GiB and hold the file header");
+            memcpy(header.magic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC));
+            header.pageSize = static_cast<uint32_t>(pageSize);
+            header.pageCount = 1;
+            header.freeHead = INVALID_PAGE;
+            created = true;
+            writeHeader();
+        } else if (memcmp(header.magic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC)) != 0 ||
+                   header.pageSize < sizeof(Header) || header.pageSize % 64 != 0) {
+            throw runtime_error("not a page file: " + path);
+        } else {
+            this->pageSize = header.pageSize;
+        }
+    } catch (...) {
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+        throw;
+    }
+}
+
+PageFile::~PageFile() {
+    try {
+        writeHeader();
+    } catch (const system_error&) {
+        // Nothing sensible to do about it in a destructor, sync() reports it to callers that care
+    }
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+size_t PageFile::getPageSize() const {
+    return pageSize;
+}
+
+PageId PageFile::getPageCount() const {
+    return header.pageCount;
+}
+
+bool PageFile::isNew() const {
+    return created;
+}
+
+PageId PageFile::allocatePage() {
+    if (header.freeHead == INVALID_PAGE) {
+        return header.pageCount++;
+    }
+
+    // Pop the free list, the next link is the first thing in the freed page
+    PageId id = header.freeHead;
+    PageId next;
+    readAt(static_cast<uint64_t>(id) * pageSize, &next, sizeof(next));
+    stats.pageReads++;
+    header.freeHead = next;
+    return id;
+}
+
+void PageFile::freePage(PageId id) {
+    unique_ptr<unsigned char[]> page(new unsigned char[pageSize]());
+    memcpy(page.get(), &header.freeHead, sizeof(header.freeHead));
+    writePage(id, page.get());
+    header.freeHead = id;
+}
+
+void PageFile::readPage(PageId id, void* buffer) {
+    readAt(static_cast<uint64_t>(id) * pageSize, buffer, pageSize);
+    stats.pageReads++;
+}
+
+void PageFile::writePage(PageId id, const void* buffer) {
+    writeAt(static_cast<uint64_t>(id) * pageSize, buffer, pageSize);
+    stats.pageWrites++;
+}
+
+void PageFile::sync() {
+    writeHeader();
+#ifdef _WIN32
+    if (_commit(fd) != 0) ioError("sync page file");
+#else
+    if (::fsync(fd) != 0) ioError("sync page file");
+#endif
+    stats.syncs++;
+}
+
+uint64_t PageFile::getMeta(int slot) const {
+    return header.meta[slot];
+}
+
+void PageFile::setMeta(int slot, uint64_t value) {
+    header.meta[slot] = value;
+}
+
+const IoStats& PageFile::getIoStats() const {
+    return stats;
+}
+
+void PageFile::resetIoStats() {
+    stats = IoStats();
+}
+
+void PageFile::readAt(uint64_t offset, void* buffer, size_t bytes) {
+    /*
+		Short reads past the end of the file are not an error: a page that was allocated but never
+		written reads back as zeros.
+	*/
+    unsigned char* out = static_cast<unsigned char*>(buffer);
+    size_t done = 0;
+    while (done < bytes) {
+#ifdef _WIN32
+        if (_lseeki64(fd, static_cast<__int64>(offset + done), SEEK_SET) < 0) ioError("seek page file");
+        int n = _read(fd, out + done, static_cast<unsigned>(bytes - done));
+#else
+        ssize_t n = ::pread(fd, out + done, bytes - done, static_cast<off_t>(offset + done));
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ioError("read page file");
+        }
+        if (n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    memset(out + done, 0, bytes - done);
+}
+
+void PageFile::writeAt(uint64_t offset, const void* buffer, size_t bytes) {
+    const unsigned char* in = static_cast<const unsigned char*>(buffer);
+    size_t done = 0;
+    while (done < bytes) {
+#ifdef _WIN32
+        if (_lseeki64(fd, static_cast<__int64>(offset + done), SEEK_SET) < 0) ioError("seek page file");
+        int n = _write(fd, in + done, static_cast<unsigned>(bytes - done));
+#else
+        ssize_t n = ::pwrite(fd, in + done, bytes - done, static_cast<off_t>(offset + done));
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ioError("write page file");
+        }
+        done += static_cast<size_t>(n);
+    }
+}
+
+void PageFile::writeHeader() {
+    writeAt(0, &header, sizeof(header));
+}
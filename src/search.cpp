@@ -1,5 +1,6 @@
 #include <iostream>
 #include <algorithm>
+#include <optional>
 #include <string>
 #include "bptree/bptree.hpp"
 
@@ -8,49 +9,23 @@ using namespace bptree;
 
 
 void BPTree::search(int key) {
-    if (root == NULL) {
+    if (getRoot() == NULL) {
         cout << "NO Tuples Inserted yet" << endl;
         return;
     } else {
-        Node* cursor = root;
-        while (cursor->isLeaf == false) {
-            /*
-				upper_bound returns an iterator pointing to the first element in the range
-				[first,last) which has a value greater than �val�.(Because we are storing the
-				same value in the right node;(STL is doing Binary search at back end)
-			*/
-            int idx = std::upper_bound(cursor->keys.begin(), cursor->keys.end(), key) - cursor->keys.begin();
-            cursor = cursor->ptr2TreeOrData.ptr2Tree[idx];  //upper_bound takes care of all the edge cases
-        }
-
-        int idx = std::lower_bound(cursor->keys.begin(), cursor->keys.end(), key) - cursor->keys.begin();  //Binary search
-
-        if (idx == cursor->keys.size() || cursor->keys[idx] != key) {
+        const RecordId* rid = find(key);
+        if (rid == NULL) {
             cout << "HUH!! Key NOT FOUND" << endl;
             return;
         }
 
-        /*
-			We can fetch the data from the disc in main memory using data-ptr
-			using cursor->dataPtr[idx]
-		*/
-
-        string fileName = "DBFiles/";
-        string data;
-        fileName += to_string(key) + ".txt";
-        FILE* filePtr = fopen(fileName.c_str(), "r");
-        if (filePtr == NULL) {
-            cout << "Error: Could not open file " << fileName << endl;
+        // The leaf holds where the tuple is, reading it is one page fetch from the heap file
+        optional<string> tuple = tuples.read(*rid);
+        if (!tuple) {
+            cout << "Error: No tuple stored at page " << rid->page << ", slot " << rid->slot << endl;
             return;
         }
         cout << "Hurray!! Key FOUND" << endl;
-        cout << "Corresponding Tuple Data is: ";
-        char ch = fgetc(filePtr);
-        while (ch != EOF) {
-            printf("%c", ch);
-            ch = fgetc(filePtr);
-        }
-        fclose(filePtr);
-        cout << endl;
+        cout << "Corresponding Tuple Data is: " << *tuple << endl;
     }
-}
\ No newline at end of file
+}
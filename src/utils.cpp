@@ -1,148 +1,126 @@
 #include <iostream>
+#include <cstring>
+#include <filesystem>
 #include "bptree/bptree.hpp"
 
 using namespace std;
 using namespace bptree;
 
-Node* parent = NULL;
+template class bptree::BasicBPTree<int, RecordId>;
 
-Node::ptr::ptr() {
-}
-
-Node::ptr::~ptr() {
-}
+namespace {
 
-Node::Node() {
-    this->isLeaf = false;
-    this->ptr2next = NULL;
+// A new tree starts with an empty heap file, tuples of an earlier run have no index left
+string freshTupleFile(const string& tupleFile) {
+    filesystem::path path(tupleFile);
+    if (path.has_parent_path()) filesystem::create_directories(path.parent_path());
+    filesystem::remove(path);
+    return path.string();
 }
 
-Node::~Node() {
-    // Clean up file pointers if this is a leaf node
-    if (isLeaf) {
-        for (size_t i = 0; i < ptr2TreeOrData.dataPtr.size(); i++) {
-            if (ptr2TreeOrData.dataPtr[i] != NULL) {
-                fclose(ptr2TreeOrData.dataPtr[i]);
-                ptr2TreeOrData.dataPtr[i] = NULL;
-            }
-        }
-        ptr2TreeOrData.dataPtr.~vector<FILE*>();
-    } else {
-        // Clean up child pointers for internal nodes
-        ptr2TreeOrData.ptr2Tree.~vector<Node*>();
+// The demo narrates every structural step of the tree on cout
+void narrate(TreeEvent event, const int& key) {
+    switch (event) {
+        case TreeEvent::ROOT_CREATED: cout << key << ": I AM ROOT!!" << endl; break;
+        case TreeEvent::LEAF_INSERT: cout << "Inserted successfully: " << key << endl; break;
+        case TreeEvent::LEAF_SPLIT: cout << "Overflow in leaf:( HAIYYA! Splitting the Node" << endl; break;
+        case TreeEvent::INTERNAL_INSERT: cout << "Inserted key in the internal node :)" << endl; break;
+        case TreeEvent::INTERNAL_SPLIT: cout << "Overflow in internal:( HAIYAA! splitting internal nodes" << endl; break;
+        case TreeEvent::ROOT_SPLIT: cout << "Created new Root!" << endl; break;
+        case TreeEvent::KEY_NOT_FOUND: cout << "Key Not Found in the Tree" << endl; break;
+        case TreeEvent::LEAF_DELETE: cout << "Deleted " << key << " From Leaf Node successfully" << endl; break;
+        case TreeEvent::TREE_EMPTIED: cout << "Ohh!! Our Tree is Empty Now :(" << endl; break;
+        case TreeEvent::LEAF_UNDERFLOW: cout << "UnderFlow in the leaf Node Happended" << endl
+                                             << "Starting Redistribution..." << endl; break;
+        case TreeEvent::LEAF_BORROW_LEFT: cout << "Transferred from left sibling of leaf node" << endl; break;
+        case TreeEvent::LEAF_BORROW_RIGHT: cout << "Transferred from right sibling of leaf node" << endl; break;
+        case TreeEvent::LEAF_MERGE: cout << "Merging two leaf Nodes" << endl; break;
+        case TreeEvent::INTERNAL_DELETE: cout << "Deleted " << key << " from internal node successfully" << endl; break;
+        case TreeEvent::INTERNAL_UNDERFLOW: cout << "UnderFlow in internal Node! What did you do :/" << endl; break;
+        case TreeEvent::INTERNAL_BORROW_LEFT: cout << "Transferred from left sibling of internal node" << endl; break;
+        case TreeEvent::INTERNAL_BORROW_RIGHT: cout << "Transferred from right sibling of internal node" << endl; break;
+        case TreeEvent::INTERNAL_MERGE: cout << "Merged two internal Nodes" << endl; break;
+        case TreeEvent::ROOT_COLLAPSED: cout << "Wow! New Changed Root" << endl; break;
+        case TreeEvent::RANGE_DELETE: cout << "Deleted every key from " << key << " on in one sweep" << endl; break;
     }
 }
 
-BPTree::BPTree() {
-    /*
-        By Default it will take the maxIntChildLimit as 4. And
-        maxLeafNodeLimit as 3.
-
-        ::REASON FOR TWO SEPERATE VARIABLES maxIntChildLimit & maxLeafNodeLimit !!
-        We are keeping the two seperate Orders
-        because Internal Nodes can hold more values in one disc block
-        as the size of the Tree pointer is small but the size of the
-        data pointer in the leaf nodes is large so we can only put less
-        nodes in the leafs as compared to the internal Nodes. Thats the
-        reson to reperate out these to variables.
-
-    */
-    this->maxIntChildLimit = 4;
-    this->maxLeafNodeLimit = 3;
-    this->root = NULL;
-}
+}  // namespace
 
-BPTree::BPTree(int degreeInternal, int degreeLeaf) {
-    this->maxIntChildLimit = degreeInternal;
-    this->maxLeafNodeLimit = degreeLeaf;
-    this->root = NULL;
+BPTree::BPTree() : tuples(freshTupleFile(TUPLE_FILE)) {
+    setEventHandler(narrate);
 }
 
-BPTree::~BPTree() {
-    destroyTree(root);
+BPTree::BPTree(int degreeInternal, int degreeLeaf, const string& tupleFile, const string& logFile)
+    : BasicBPTree(degreeInternal, degreeLeaf), tuples(freshTupleFile(tupleFile)) {
+    if (!logFile.empty()) recover(logFile);  // before the narration, replaying stays quiet
+    setEventHandler(narrate);
 }
 
-void BPTree::destroyTree(Node* node) {
-    if (node == NULL) return;
-    
-    if (!node->isLeaf) {
-        // Recursively delete all children
-        for (size_t i = 0; i < node->ptr2TreeOrData.ptr2Tree.size(); i++) {
-            destroyTree(node->ptr2TreeOrData.ptr2Tree[i]);
-        }
-    }
-    
-    delete node;
+BPTree::BPTree(KeepTuples, const string& tupleFile) : tuples(tupleFile) {
+    setEventHandler(narrate);
 }
 
-int BPTree::getMaxIntChildLimit() {
-    return maxIntChildLimit;
+unique_ptr<BPTree> BPTree::open(const string& indexFile, const string& tupleFile) {
+    unique_ptr<BPTree> tree(new BPTree(KeepTuples(), tupleFile));
+    tree->BasicBPTree::open(indexFile);
+    return tree;
 }
 
-int BPTree::getMaxLeafNodeLimit() {
-    return maxLeafNodeLimit;
+void BPTree::save(const string& indexFile) {
+    // Tuples first: an image must never point at records the heap file does not have yet
+    tuples.flush();
+    BasicBPTree::save(indexFile);
 }
 
-Node* BPTree::getRoot() {
-    return this->root;
+void BPTree::insertTuple(int key, const string& tuple) {
+    if (log) log->commit(LOG_INSERT, logPayload(key, tuple));
+    applyInsert(key, tuple);
 }
 
-void BPTree::setRoot(Node *ptr) {
-    this->root = ptr;
+void BPTree::applyInsert(int key, const string& tuple) {
+    // Roll numbers are a primary key: a second insert replaces the tuple instead of adding a copy
+    RecordId rid = tuples.insert(tuple);
+    RecordId* existing = find(key);
+    if (existing != NULL) {
+        tuples.erase(*existing);
+        *existing = rid;
+    } else {
+        insert(key, rid);
+    }
 }
 
-Node* BPTree::firstLeftNode(Node* cursor) {
-    if (cursor->isLeaf)
-        return cursor;
-    for (int i = 0; i < cursor->ptr2TreeOrData.ptr2Tree.size(); i++)
-        if (cursor->ptr2TreeOrData.ptr2Tree[i] != NULL)
-            return firstLeftNode(cursor->ptr2TreeOrData.ptr2Tree[i]);
-
-    return NULL;
+HeapFile& BPTree::getTuples() {
+    return tuples;
 }
 
-Node** BPTree::findParent(Node* cursor, Node* child) {
-    /*
-		Finds parent using depth first traversal and ignores leaf nodes as they cannot be parents
-		also ignores second last level because we will never find parent of a leaf node during insertion using this function
-	*/
-
-    // Safety checks
-    if (cursor == NULL || child == NULL) {
-        return NULL;
-    }
-
-    if (cursor->isLeaf) {
-        return NULL;
-    }
-
-    // Check if cursor's children are empty or if first child is leaf
-    if (cursor->ptr2TreeOrData.ptr2Tree.empty()) {
-        return NULL;
-    }
-
-    if (cursor->ptr2TreeOrData.ptr2Tree[0] == NULL || cursor->ptr2TreeOrData.ptr2Tree[0]->isLeaf) {
-        return NULL;
-    }
+WriteAheadLog* BPTree::getLog() {
+    return log.get();
+}
 
-    // Check direct children first
-    for (int i = 0; i < cursor->ptr2TreeOrData.ptr2Tree.size(); i++) {
-        if (cursor->ptr2TreeOrData.ptr2Tree[i] == child) {
-            parent = cursor;
-            return &parent;
-        }
-    }
+string BPTree::logPayload(int key, const string& tuple) {
+    string payload(sizeof(key), '\0');
+    memcpy(&payload[0], &key, sizeof(key));
+    return payload + tuple;
+}
 
-    // Recursively search in children
-    for (int i = 0; i < cursor->ptr2TreeOrData.ptr2Tree.size(); i++) {
-        Node* tmpCursor = cursor->ptr2TreeOrData.ptr2Tree[i];
-        if (tmpCursor != NULL && !tmpCursor->isLeaf) {
-            Node** result = findParent(tmpCursor, child);
-            if (result != NULL) {
-                return result;
-            }
+void BPTree::recover(const string& logFile) {
+    // The log is the whole history of the table, replaying it rebuilds heap file and tree alike
+    log.reset(new WriteAheadLog(logFile));
+    log->replay([this](uint64_t, uint8_t type, string_view payload) {
+        int key;
+        if (payload.size() < sizeof(key)) return;
+        memcpy(&key, payload.data(), sizeof(key));
+        if (type == LOG_INSERT) {
+            applyInsert(key, string(payload.substr(sizeof(key))));
+        } else if (type == LOG_REMOVE) {
+            RecordId erased;
+            applyRemove(key, erased);
+        } else if (type == LOG_REMOVE_RANGE && payload.size() >= 2 * sizeof(key)) {
+            int hi;
+            memcpy(&hi, payload.data() + sizeof(key), sizeof(hi));
+            size_t keys;
+            applyRemoveRange(key, hi, keys);
         }
-    }
-
-    return NULL;
-}
\ No newline at end of file
+    });
+}
@@ -0,0 +1,224 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include "bptree/value_store.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace bptree;
+
+namespace {
+
+const char VALUE_STORE_MAGIC[8] = {'B', 'P', 'T', 'V', 'A', 'L', 'S', '1'};
+
+constexpr size_t MIN_SEGMENT_SIZE = size_t{64} << 10;  // Windows maps at 64 KiB granularity
+
+[[noreturn]] void ioError(const char* what) {
+#ifdef _WIN32
+    throw system_error(static_cast<int>(GetLastError()), system_category(), what);
+#else
+    throw system_error(errno, generic_category(), what);
+#endif
+}
+
+constexpr uint64_t roundUp(uint64_t bytes, uint64_t alignment) {
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+ValueStore::ValueStore(const string& path, size_t segmentSize) : segmentBytes(segmentSize), segmentShift(0) {
+    uint64_t fileBytes = 0;
+    char stored[sizeof(Header)] = {};
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS,
+                       FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) ioError("open value store");
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) ioError("open value store");
+#endif
+
+    try {
+#ifdef _WIN32
+        LARGE_INTEGER length;
+        if (!GetFileSizeEx(file, &length)) ioError("stat value store");
+        fileBytes = static_cast<uint64_t>(length.QuadPart);
+        DWORD got = 0;
+        if (fileBytes >= sizeof(Header) && !ReadFile(file, stored, sizeof(Header), &got, NULL)) ioError("read value store");
+#else
+        struct stat info;
+        if (::fstat(fd, &info) != 0) ioError("stat value store");
+        fileBytes = static_cast<uint64_t>(info.st_size);
+        if (fileBytes >= sizeof(Header) && ::pread(fd, stored, sizeof(Header), 0) != static_cast<ssize_t>(sizeof(Header)))
+            ioError("read value store");
+#endif
+
+        const bool created = fileBytes == 0;
+        if (!created) {
+            // The segment size is whatever the file was created with
+            Header existing;
+            memcpy(&existing, stored, sizeof(existing));
+            if (fileBytes < sizeof(Header) || memcmp(existing.magic, VALUE_STORE_MAGIC, sizeof(VALUE_STORE_MAGIC)) != 0)
+                throw runtime_error("not a value store: " + path);
+            segmentBytes = static_cast<size_t>(existing.segmentSize);
+            if (fileBytes < segmentBytes) throw runtime_error("value store cut short: " + path);
+        }
+        if (segmentBytes < MIN_SEGMENT_SIZE || (segmentBytes & (segmentBytes - 1)) != 0)
+            throw invalid_argument("segment size must be a power of two of at least 64 KiB");
+        while ((size_t{1} << segmentShift) < segmentBytes) segmentShift++;
+
+        const size_t count = created ? 1 : static_cast<size_t>(fileBytes / segmentBytes);
+        for (size_t i = 0; i < count; i++) addSegment();
+        if (created) {
+            Header* fresh = header();
+            memcpy(fresh->magic, VALUE_STORE_MAGIC, sizeof(VALUE_STORE_MAGIC));
+            fresh->segmentSize = segmentBytes;
+            fresh->end = DATA_START;
+            fresh->values = 0;
+            fresh->deadBytes = 0;
+        }
+    } catch (...) {
+        unmapAll();
+        throw;
+    }
+}
+
+ValueStore::~ValueStore() {
+    unmapAll();
+}
+
+ValueRef ValueStore::append(string_view value) {
+    if (value.size() > maxValueSize()) throw invalid_argument("value larger than a segment");
+
+    Header* meta = header();
+    const uint64_t bytes = roundUp(sizeof(RecordHeader) + value.size(), ALIGNMENT);
+    uint64_t at = meta->end;
+    const uint64_t segmentEnd = roundUp(at + 1, segmentBytes);
+    if (at + bytes > segmentEnd) {
+        // The tail of this segment stays unused, the value starts the next one
+        meta->deadBytes += segmentEnd - at;
+        at = segmentEnd;
+    }
+    while ((at + bytes - 1) >> segmentShift >= segments.size()) addSegment();
+
+    unsigned char* place = segments[at >> segmentShift] + (at & (segmentBytes - 1));
+    RecordHeader record{static_cast<uint32_t>(value.size()), 0};
+    memcpy(place, &record, sizeof(record));
+    if (!value.empty()) memcpy(place + sizeof(record), value.data(), value.size());
+    meta->end = at + bytes;
+    meta->values++;
+    return ValueRef{at};
+}
+
+optional<string_view> ValueStore::get(ValueRef ref) const {
+    const RecordHeader* found = record(ref);
+    if (found == NULL || found->erased != 0) return nullopt;
+    return string_view(reinterpret_cast<const char*>(found + 1), found->length);
+}
+
+bool ValueStore::erase(ValueRef ref) {
+    RecordHeader* found = const_cast<RecordHeader*>(record(ref));
+    if (found == NULL || found->erased != 0) return false;
+    found->erased = 1;
+    Header* meta = header();
+    meta->values--;
+    meta->deadBytes += roundUp(sizeof(RecordHeader) + found->length, ALIGNMENT);
+    return true;
+}
+
+void ValueStore::sync() {
+    for (unsigned char* segment : segments) {
+#ifdef _WIN32
+        if (!FlushViewOfFile(segment, segmentBytes)) ioError("sync value store");
+#else
+        if (::msync(segment, segmentBytes, MS_SYNC) != 0) ioError("sync value store");
+#endif
+    }
+#ifdef _WIN32
+    if (!FlushFileBuffers(file)) ioError("sync value store");
+#endif
+}
+
+uint64_t ValueStore::size() const {
+    return header()->values;
+}
+
+uint64_t ValueStore::getDataBytes() const {
+    return header()->end;
+}
+
+uint64_t ValueStore::getDeadBytes() const {
+    return header()->deadBytes;
+}
+
+size_t ValueStore::getSegmentSize() const {
+    return segmentBytes;
+}
+
+size_t ValueStore::getSegmentCount() const {
+    return segments.size();
+}
+
+size_t ValueStore::maxValueSize() const {
+    // A whole segment minus the record header, the first one also holds the store header
+    return segmentBytes - DATA_START - sizeof(RecordHeader);
+}
+
+const ValueStore::RecordHeader* ValueStore::record(ValueRef ref) const {
+    if (ref.offset < DATA_START || ref.offset >= header()->end || ref.offset % ALIGNMENT != 0) return NULL;
+    return reinterpret_cast<const RecordHeader*>(segments[ref.offset >> segmentShift] + (ref.offset & (segmentBytes - 1)));
+}
+
+void ValueStore::addSegment() {
+    const uint64_t offset = static_cast<uint64_t>(segments.size()) * segmentBytes;
+    const uint64_t fileBytes = offset + segmentBytes;
+#ifdef _WIN32
+    // A mapping object as large as the file so far grows the file to that size
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, static_cast<DWORD>(fileBytes >> 32),
+                                        static_cast<DWORD>(fileBytes), NULL);
+    if (mapping == NULL) ioError("grow value store");
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset),
+                               segmentBytes);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        ioError("map value store");
+    }
+    mappings.push_back(mapping);
+#else
+    struct stat info;
+    if (::fstat(fd, &info) != 0) ioError("stat value store");
+    if (static_cast<uint64_t>(info.st_size) < fileBytes && ::ftruncate(fd, static_cast<off_t>(fileBytes)) != 0)
+        ioError("grow value store");
+    void* view = ::mmap(NULL, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(offset));
+    if (view == MAP_FAILED) ioError("map value store");
+#endif
+    segments.push_back(static_cast<unsigned char*>(view));
+}
+
+void ValueStore::unmapAll() {
+#ifdef _WIN32
+    for (unsigned char* segment : segments) UnmapViewOfFile(segment);
+    for (void* mapping : mappings) CloseHandle(mapping);
+    mappings.clear();
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+#else
+    for (unsigned char* segment : segments) ::munmap(segment, segmentBytes);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+    segments.clear();
+}
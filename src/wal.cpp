@@ -0,0 +1,245 @@
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include "bptree/wal.hpp"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace bptree;
+
+namespace {
+
+const char WAL_MAGIC[8] = {'B', 'P', 'T', 'W', 'A', 'L', '0', '1'};
+
+[[noreturn]] void ioError(const char* what) {
+    throw system_error(errno, generic_category(), what);
+}
+
+// CRC-32 (IEEE 802.3, reflected), enough to tell a torn tail from a record
+uint32_t crc32(const char* data, size_t bytes) {
+    static const array<uint32_t, 256> table = [] {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; bit++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < bytes; i++) crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+}  // namespace
+
+WriteAheadLog::WriteAheadLog(const string& path) : path(path) {
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+#endif
+    if (fd < 0) ioError("open write-ahead log");
+
+    try {
+        uint64_t count = 0;
+        uint64_t end = scan(nullptr, durableLsn, count);
+        nextLsn = durableLsn + 1;
+        if (end == 0) {
+            writeAll(WAL_MAGIC, sizeof(WAL_MAGIC));
+            datasync();
+        }
+    } catch (...) {
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+        throw;
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    try {
+        waitDurable(nextLsn - 1);
+    } catch (const exception&) {
+        // Records that did not make it were never acknowledged to anyone
+    }
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+uint64_t WriteAheadLog::replay(const Visitor& visit) {
+    uint64_t lastLsn = 0, count = 0;
+    scan(&visit, lastLsn, count);
+    lock_guard<std::mutex> lock(mutex);
+    stats.replayed = count;
+    return count;
+}
+
+uint64_t WriteAheadLog::append(uint8_t type, string_view payload) {
+    lock_guard<std::mutex> lock(mutex);
+    uint64_t lsn = nextLsn++;
+    uint32_t length = static_cast<uint32_t>(payload.size());
+
+    size_t at = pending.size();
+    pending.resize(at + RECORD_HEADER + payload.size());
+    char* record = pending.data() + at;
+    memcpy(record + 4, &length, 4);
+    memcpy(record + 8, &lsn, 8);
+    record[16] = static_cast<char>(type);
+    if (!payload.empty()) memcpy(record + RECORD_HEADER, payload.data(), payload.size());
+    uint32_t crc = crc32(record + 4, RECORD_HEADER - 4 + payload.size());
+    memcpy(record, &crc, 4);
+
+    stats.records++;
+    return lsn;
+}
+
+void WriteAheadLog::waitDurable(uint64_t lsn) {
+    unique_lock<std::mutex> lock(mutex);
+    while (durableLsn < lsn) {
+        if (failed) throw runtime_error("write-ahead log failed, commit " + to_string(lsn) + " is lost");
+        if (flushing) {
+            flushed.wait(lock);
+            continue;
+        }
+
+        // Leader: everything buffered so far goes out with one write and one sync
+        flushing = true;
+        vector<char> batch;
+        batch.swap(pending);
+        uint64_t upTo = nextLsn - 1;
+        lock.unlock();
+        try {
+            writeAll(batch.data(), batch.size());
+            datasync();
+        } catch (...) {
+            lock.lock();
+            failed = true;
+            flushing = false;
+            flushed.notify_all();
+            throw;
+        }
+        lock.lock();
+        durableLsn = upTo;
+        flushing = false;
+        stats.syncs++;
+        stats.bytes += batch.size();
+        flushed.notify_all();
+    }
+}
+
+uint64_t WriteAheadLog::commit(uint8_t type, string_view payload) {
+    uint64_t lsn = append(type, payload);
+    waitDurable(lsn);
+    return lsn;
+}
+
+uint64_t WriteAheadLog::getDurableLsn() const {
+    lock_guard<std::mutex> lock(mutex);
+    return durableLsn;
+}
+
+LogStats WriteAheadLog::getStats() const {
+    lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+uint64_t WriteAheadLog::scan(const Visitor* visit, uint64_t& lastLsn, uint64_t& count) {
+    /*
+		Records are only trusted up to the first one that is cut short, fails its checksum or does
+		not continue the LSN sequence; whatever follows is a torn batch and gets truncated away.
+		Returns 0 for an empty file.
+	*/
+    vector<char> data;
+    char chunk[1 << 16];
+#ifdef _WIN32
+    if (_lseeki64(fd, 0, SEEK_SET) < 0) ioError("seek write-ahead log");
+#else
+    if (::lseek(fd, 0, SEEK_SET) < 0) ioError("seek write-ahead log");
+#endif
+    for (;;) {
+#ifdef _WIN32
+        int n = _read(fd, chunk, sizeof(chunk));
+#else
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ioError("read write-ahead log");
+        }
+        if (n == 0) break;
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    if (data.empty()) return 0;
+    if (data.size() < sizeof(WAL_MAGIC) || memcmp(data.data(), WAL_MAGIC, sizeof(WAL_MAGIC)) != 0)
+        throw runtime_error("not a write-ahead log: " + path);
+
+    size_t at = sizeof(WAL_MAGIC);
+    while (data.size() - at >= RECORD_HEADER) {
+        const char* record = data.data() + at;
+        uint32_t crc, length;
+        uint64_t lsn;
+        memcpy(&crc, record, 4);
+        memcpy(&length, record + 4, 4);
+        memcpy(&lsn, record + 8, 8);
+        if (length > data.size() - at - RECORD_HEADER) break;
+        if (crc32(record + 4, RECORD_HEADER - 4 + length) != crc) break;
+        if (count > 0 && lsn != lastLsn + 1) break;
+
+        if (visit != nullptr) (*visit)(lsn, static_cast<uint8_t>(record[16]), string_view(record + RECORD_HEADER, length));
+        lastLsn = lsn;
+        count++;
+        at += RECORD_HEADER + length;
+    }
+
+    if (at < data.size()) {
+#ifdef _WIN32
+        if (_chsize_s(fd, static_cast<__int64>(at)) != 0) ioError("truncate write-ahead log");
+#else
+        if (::ftruncate(fd, static_cast<off_t>(at)) != 0) ioError("truncate write-ahead log");
+#endif
+        datasync();
+    }
+    return at;
+}
+
+void WriteAheadLog::writeAll(const char* data, size_t bytes) {
+    size_t done = 0;
+    while (done < bytes) {
+#ifdef _WIN32
+        int n = _write(fd, data + done, static_cast<unsigned>(bytes - done));
+#else
+        ssize_t n = ::write(fd, data + done, bytes - done);
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ioError("write write-ahead log");
+        }
+        done += static_cast<size_t>(n);
+    }
+}
+
+void WriteAheadLog::datasync() {
+#if defined(_WIN32)
+    if (_commit(fd) != 0) ioError("sync write-ahead log");
+#elif defined(__APPLE__)
+    if (::fsync(fd) != 0) ioError("sync write-ahead log");
+#else
+    if (::fdatasync(fd) != 0) ioError("sync write-ahead log");
+#endif
+}
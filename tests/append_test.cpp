@@ -0,0 +1,116 @@
+// Appends: ascending inserts skip the descent and split 100/0, leaving full nodes behind them
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+
+#include "bptree/basic_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+namespace {
+
+template <typename Tree>
+void checkFull(Tree& tree) {
+    // Every leaf but the rightmost is full, every internal node off the right edge all but full
+    using Node = typename Tree::Node;
+    std::function<void(const Node*, bool)> walk = [&](const Node* node, bool rightEdge) {
+        if (node->isLeaf) {
+            if (!rightEdge) CHECK(node->size == tree.getMaxLeafNodeLimit());
+            return;
+        }
+        if (!rightEdge) CHECK(node->size >= tree.getMaxIntChildLimit() - 2);
+        for (int c = 0; c <= node->size; c++) walk(node->child(c), rightEdge && c == node->size);
+    };
+    walk(tree.getRoot(), true);
+}
+
+void ascending(int fanout) {
+    bptree::BasicBPTree<long, long> tree(fanout, fanout);
+    std::map<long, long> ref;
+    const long n = 20000;
+    for (long key = 0; key < n; key++) {
+        tree.insert(key * 2, key);
+        ref[key * 2] = key;
+        if (key == fanout) {
+            // the first leaf split left the old leaf full and the new one with the key alone
+            CHECK(tree.getRoot()->child(0)->size == fanout);
+            CHECK(tree.getRoot()->child(1)->size == 1);
+        }
+    }
+    checkTree(tree, ref);
+    checkFull(tree);
+    const bptree::TreeStats& stats = tree.getStats();
+    CHECK(stats.leafSplits == static_cast<std::uint64_t>((n - 1) / fanout));
+    // one descent per leaf split, every other insert an append
+    CHECK(stats.appends + stats.leafSplits + 1 == static_cast<std::uint64_t>(n));
+
+    // An equal key goes after the largest while the rightmost leaf has room, a smaller one takes the descent
+    const bptree::BasicBPTree<long, long>::Node* tail = tree.getRoot();
+    while (!tail->isLeaf) tail = tail->child(tail->size);
+    const std::uint64_t appends = stats.appends + (tail->size < fanout ? 1 : 0);
+    tree.insert((n - 1) * 2, -1);
+    CHECK(tree.getStats().appends == appends);
+    tree.insert(1, -2);
+    CHECK(tree.getStats().appends == appends);
+    auto last = tree.begin();
+    for (auto it = tree.begin(); it != tree.end(); ++it) last = it;
+    CHECK(last.key() == (n - 1) * 2 && last.value() == -1);
+}
+
+void mixed(int fanout, std::mt19937_64& rng) {
+    // Random inserts, deletes and ranges in between runs of appends keep the shape
+    bptree::BasicBPTree<long, long> tree(fanout, fanout);
+    std::map<long, long> ref;
+    long next = 0;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 500; i++, next++) {
+            tree.insert(next, i);
+            ref[next] = i;
+        }
+        for (int i = 0; i < 300; i++) {
+            const long key = static_cast<long>(rng() % next);
+            if (i % 2 == 0) {
+                CHECK(tree.removeKey(key) == (ref.erase(key) > 0));
+            } else if (ref.count(key) == 0) {
+                tree.insert(key, i);
+                ref[key] = i;
+            }
+        }
+        for (long key = next - 1; key > next - 40; key--) CHECK(tree.removeKey(key) == (ref.erase(key) > 0));
+        if (round % 5 == 4) {
+            tree.removeRange(next - 400, next);
+            ref.erase(ref.lower_bound(next - 400), ref.end());
+        }
+        checkTree(tree, ref);
+    }
+}
+
+void strings() {
+    // Prefix-compressed leaves take appends too
+    bptree::BasicBPTree<std::string, int> tree(8, 8);
+    std::map<std::string, int> ref;
+    for (int i = 0; i < 5000; i++) {
+        char key[32];
+        std::snprintf(key, sizeof(key), "https://example.com/%06d", i);
+        tree.insert(key, i);
+        ref[key] = i;
+    }
+    checkTree(tree, ref);
+    checkFull(tree);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(25);
+    for (int fanout : {3, 4, 5, 16, 64}) {
+        ascending(fanout);
+        mixed(fanout, rng);
+    }
+    strings();
+    std::printf("append_test passed\n");
+    return 0;
+}
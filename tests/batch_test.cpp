@@ -0,0 +1,122 @@
+// multiGet and multiInsert: a batch does exactly what the single finds and inserts in key order do
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bptree/basic_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+using Tree = bptree::BasicBPTree<long, long>;
+
+namespace {
+
+// results[i] is the very slot find(keys[i]) points to, through both overloads
+template <typename Key, typename Value>
+void checkMultiGet(bptree::BasicBPTree<Key, Value>& tree, const std::vector<Key>& keys) {
+    std::vector<Value*> results(keys.size(), reinterpret_cast<Value*>(1));
+    tree.multiGet(keys.data(), keys.size(), results.data());
+    for (std::size_t i = 0; i < keys.size(); i++) CHECK(results[i] == tree.find(keys[i]));
+
+    const bptree::BasicBPTree<Key, Value>& constTree = tree;
+    std::vector<const Value*> constResults(keys.size());
+    constTree.multiGet(keys.data(), keys.size(), constResults.data());
+    for (std::size_t i = 0; i < keys.size(); i++) CHECK(constResults[i] == constTree.find(keys[i]));
+}
+
+std::vector<long> randomKeys(std::size_t n, long range, std::mt19937_64& rng) {
+    std::vector<long> keys;
+    for (std::size_t i = 0; i < n; i++) keys.push_back(static_cast<long>(rng() % range));
+    return keys;
+}
+
+void uniqueKeys(int fanout, std::mt19937_64& rng) {
+    // Batches of new keys, unsorted, sorted and descending, against a std::map
+    Tree tree(fanout, fanout);
+    std::map<long, long> ref;
+    checkMultiGet(tree, randomKeys(50, 1000, rng));  // an empty tree has no root to descend from
+    tree.multiInsert(NULL, 0);
+    CHECK(tree.getRoot() == NULL);
+
+    for (int round = 0; round < 30; round++) {
+        std::vector<std::pair<long, long>> batch;
+        const std::size_t n = 1 + rng() % 300;
+        while (batch.size() < n) {
+            const long key = static_cast<long>(rng() % 20000);
+            if (ref.emplace(key, key + round).second) batch.push_back({key, key + round});
+        }
+        if (round % 3 == 1) std::sort(batch.begin(), batch.end());
+        if (round % 3 == 2) std::sort(batch.rbegin(), batch.rend());
+        tree.multiInsert(batch.data(), batch.size());
+        checkTree(tree, ref);
+
+        std::vector<long> keys = randomKeys(500, 20000, rng);  // mostly absent, a few twice
+        for (int i = 0; i < 100; i++) keys.push_back(std::next(ref.begin(), rng() % ref.size())->first);
+        std::shuffle(keys.begin(), keys.end(), rng);
+        checkMultiGet(tree, keys);
+        std::sort(keys.begin(), keys.end());
+        checkMultiGet(tree, keys);
+    }
+}
+
+void duplicateKeys(int fanout, std::mt19937_64& rng) {
+    // Equal keys, in the tree and within a batch, end up where n single inserts in key order put them
+    Tree batched(fanout, fanout), single(fanout, fanout);
+    for (int round = 0; round < 20; round++) {
+        std::vector<std::pair<long, long>> batch;
+        const std::size_t n = 1 + rng() % 200;
+        for (std::size_t i = 0; i < n; i++) batch.push_back({static_cast<long>(rng() % 100), round * 1000 + static_cast<long>(i)});
+        batched.multiInsert(batch.data(), batch.size());
+
+        std::stable_sort(batch.begin(), batch.end(),
+                         [](const std::pair<long, long>& a, const std::pair<long, long>& b) { return a.first < b.first; });
+        for (const auto& entry : batch) single.insert(entry.first, entry.second);
+
+        auto expected = single.begin();
+        for (auto it = batched.begin(); it != batched.end(); ++it, ++expected) {
+            CHECK(expected != single.end());
+            CHECK(it.key() == expected.key() && it.value() == expected.value());
+        }
+        CHECK(expected == single.end());
+        checkMultiGet(batched, randomKeys(150, 120, rng));
+    }
+}
+
+void stringKeys(std::mt19937_64& rng) {
+    // Prefix-compressed leaves and truncated separators take the batch paths too
+    bptree::BasicBPTree<std::string, long> tree(8, 8);
+    std::map<std::string, long> ref;
+    std::vector<std::pair<std::string, long>> batch;
+    for (long i = 0; i < 3000; i++) {
+        std::string key = "https://example.com/items/" + std::to_string(rng() % 100000);
+        if (ref.emplace(key, i).second) batch.push_back({key, i});
+    }
+    tree.multiInsert(batch.data(), batch.size());
+    checkTree(tree, ref);
+
+    std::vector<std::string> keys;
+    for (const auto& entry : batch) keys.push_back(entry.first);
+    for (int i = 0; i < 500; i++) keys.push_back("https://example.com/items/" + std::to_string(100000 + i));
+    std::shuffle(keys.begin(), keys.end(), rng);
+    checkMultiGet(tree, keys);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(14);
+    for (int fanout : {3, 4, 7, 16, 64}) {
+        uniqueKeys(fanout, rng);
+        duplicateKeys(fanout, rng);
+    }
+    stringKeys(rng);
+    std::printf("batch_test passed\n");
+    return 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+/*
+	CHECK for the unit test programs next to test_suite.sh: unlike assert it stays on in release
+	builds, and the first failure prints where it was and ends the program with exit status 1.
+*/
+#define CHECK(cond)                                                                        \
+    do {                                                                                   \
+        if (!(cond)) {                                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                                  \
+        }                                                                                  \
+    } while (0)
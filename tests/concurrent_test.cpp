@@ -0,0 +1,118 @@
+// ConcurrentBPTree: threads inserting, removing, finding and scanning at once never lose or tear a key
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bptree/concurrent_bptree.hpp"
+#include "check.hpp"
+
+using Tree = bptree::ConcurrentBPTree<long, long>;
+
+namespace {
+
+constexpr int THREADS = 8;
+constexpr long KEYS_PER_THREAD = 2000;
+constexpr long RANGE = THREADS * KEYS_PER_THREAD;
+constexpr long GENERATIONS = 1000;  // a value is key * GENERATIONS + the write that stored it
+
+bool wellFormed(long key, long value) { return value / GENERATIONS == key; }
+
+/*
+	Thread t owns the keys congruent to t modulo THREADS, so its std::map is exact for them
+	whatever the other threads do. Keys of other threads are only checked for torn values, and
+	scans for order.
+*/
+void worker(Tree& tree, int t, unsigned seed, std::map<long, long>& ref) {
+    std::mt19937_64 rng(seed);
+    long generation = 0;
+    auto ownKey = [&] { return static_cast<long>(rng() % KEYS_PER_THREAD) * THREADS + t; };
+
+    for (int op = 0; op < 20000; op++) {
+        const int kind = static_cast<int>(rng() % 100);
+        if (kind < 40) {
+            const long key = ownKey();
+            const long value = key * GENERATIONS + generation++ % GENERATIONS;
+            CHECK(tree.insert(key, value) == (ref.count(key) == 0));
+            ref[key] = value;
+        } else if (kind < 70) {
+            const long key = ownKey();
+            CHECK(tree.removeKey(key) == (ref.erase(key) == 1));
+        } else if (kind < 90) {
+            const long key = static_cast<long>(rng() % RANGE);
+            std::optional<long> value = tree.find(key);
+            if (value.has_value()) CHECK(wellFormed(key, *value));
+            if (key % THREADS == t) {
+                auto it = ref.find(key);
+                CHECK(value.has_value() == (it != ref.end()));
+                if (value.has_value()) CHECK(*value == it->second);
+            }
+        } else {
+            const long lo = static_cast<long>(rng() % RANGE);
+            const long hi = lo + static_cast<long>(rng() % 400);
+            std::vector<long> own;
+            long last = lo - 1;
+            tree.scan(lo, hi, [&](long key, long value) {
+                CHECK(key > last && key < hi);
+                CHECK(wellFormed(key, value));
+                last = key;
+                if (key % THREADS == t) {
+                    CHECK(ref.count(key) == 1 && ref.at(key) == value);
+                    own.push_back(key);
+                }
+            });
+            std::vector<long> expected;
+            for (auto it = ref.lower_bound(lo); it != ref.end() && it->first < hi; ++it) expected.push_back(it->first);
+            CHECK(own == expected);
+        }
+    }
+}
+
+void stress(int degreeInternal, int degreeLeaf, std::mt19937_64& rng) {
+    Tree tree(degreeInternal, degreeLeaf);
+    std::vector<std::map<long, long>> refs(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++)
+        threads.emplace_back(worker, std::ref(tree), t, static_cast<unsigned>(rng()), std::ref(refs[t]));
+    for (std::thread& thread : threads) thread.join();
+
+    std::map<long, long> ref;
+    for (const auto& own : refs) ref.insert(own.begin(), own.end());
+    CHECK(tree.size() == ref.size());
+    std::map<long, long> scanned;
+    long last = -1;
+    tree.scan(0, RANGE, [&](long key, long value) {
+        CHECK(key > last);
+        scanned[last = key] = value;
+    });
+    CHECK(scanned == ref);
+
+    // Drained from several threads at once, every merge up to the root collapse runs concurrently
+    threads.clear();
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&tree, &refs, t] {
+            for (const auto& entry : refs[t]) CHECK(tree.removeKey(entry.first));
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    CHECK(tree.size() == 0);
+    tree.scan(0, RANGE, [](long, long) { CHECK(false); });
+    CHECK(tree.getStats().freedNodes <= tree.getStats().retiredNodes);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(12);
+    stress(4, 3, rng);
+    stress(5, 4, rng);
+    stress(16, 16, rng);
+    stress(64, 64, rng);
+    std::printf("concurrent_test passed\n");
+    return 0;
+}
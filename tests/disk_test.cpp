@@ -0,0 +1,177 @@
+// DiskBPTree: a tree of pages behind a small buffer pool matches std::map, also after reopening the file
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "bptree/disk_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+using bptree::DiskOptions;
+using bptree::EvictionPolicy;
+using bptree::PageFile;
+using Tree = bptree::DiskBPTree<long, long>;
+
+namespace {
+
+// Every key in ref is found with its value, its neighbours are not, and scans visit ref in order
+void checkAgainst(Tree& tree, const std::map<long, long>& ref, long range, std::mt19937_64& rng) {
+    CHECK(tree.size() == ref.size());
+    checkFinds(tree, ref, range);
+
+    auto it = ref.begin();
+    tree.forEach([&](const long& key, const long& value) {
+        CHECK(it != ref.end() && key == it->first && value == it->second);
+        ++it;
+    });
+    CHECK(it == ref.end());
+    checkScans(tree, ref, range, 300, 20, rng);
+}
+
+void smallNodes(EvictionPolicy eviction, std::mt19937_64& rng) {
+    // Fanout 5/4 on 8 frames: deep trees, every descent evicts, merges free pages for reuse
+    const std::string path = "disk_test.idx";
+    std::remove(path.c_str());
+    DiskOptions options;
+    options.poolPages = 8;
+    options.eviction = eviction;
+    options.maxIntChildLimit = 5;
+    options.maxLeafNodeLimit = 4;
+    std::map<long, long> ref;
+    const long range = 3000;
+
+    {
+        Tree tree(path, options);
+        CHECK(tree.getFile().isNew());
+        for (int round = 0; round < 5; round++) {
+            randomOps(tree, ref, 0, range, 4000, rng);
+            checkAgainst(tree, ref, range, rng);
+        }
+        CHECK(tree.getPool().getStats().evictions > 0);
+        CHECK(tree.getPool().getStats().writeBacks > 0);
+    }  // the destructor flushes
+
+    // Reopened, the limits come from the file header whatever the options say
+    DiskOptions other = options;
+    other.maxIntChildLimit = 64;
+    other.maxLeafNodeLimit = 64;
+    Tree tree(path, other);
+    CHECK(!tree.getFile().isNew());
+    CHECK(tree.getMaxIntChildLimit() == 5 && tree.getMaxLeafNodeLimit() == 4);
+    checkAgainst(tree, ref, range, rng);
+
+    // Emptied and refilled, the file grows no further than it did the first time
+    const bptree::PageId pages = tree.getFile().getPageCount();
+    for (auto it = ref.begin(); it != ref.end(); it = ref.erase(it)) CHECK(tree.removeKey(it->first));
+    CHECK(tree.size() == 0 && !tree.contains(0));
+    randomOps(tree, ref, 0, range, 4000, rng);
+    checkAgainst(tree, ref, range, rng);
+    CHECK(tree.getFile().getPageCount() <= pages);
+    std::remove(path.c_str());
+}
+
+void fullPages(std::mt19937_64& rng) {
+    // Limits from the page size, flush() and reopen several times
+    const std::string path = "disk_test_full.idx";
+    std::remove(path.c_str());
+    DiskOptions options;
+    options.poolPages = 8;
+    std::map<long, long> ref;
+    const long range = 200000;
+    for (int run = 0; run < 3; run++) {
+        Tree tree(path, options);
+        CHECK(tree.getMaxLeafNodeLimit() > 100);
+        checkAgainst(tree, ref, 5000, rng);
+        randomOps(tree, ref, 0, range, 30000, rng);
+        tree.flush();
+        CHECK(tree.size() == ref.size());
+    }
+    Tree tree(path, options);
+    auto it = ref.begin();
+    tree.forEach([&](const long& key, const long& value) {
+        CHECK(it != ref.end() && key == it->first && value == it->second);
+        ++it;
+    });
+    CHECK(it == ref.end());
+    std::remove(path.c_str());
+}
+
+template <typename Call>
+bool throws(Call&& call) {
+    try {
+        call();
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+void largePages(std::mt19937_64& rng) {
+    // 1 MiB pages fit more keys than PageHeader::size counts: the limits stop at 65535 keys
+    const std::string path = "disk_test_large.idx";
+    std::remove(path.c_str());
+    DiskOptions options;
+    options.pageSize = std::size_t{1} << 20;
+    options.poolPages = 8;
+    std::map<long, long> ref;
+    const long range = 150000;
+    {
+        Tree tree(path, options);
+        CHECK(tree.getMaxLeafNodeLimit() == 65534 && tree.getMaxIntChildLimit() == 65535);
+        // Ascending keys fill a leaf to its spare slot, the 65535th key, before it splits
+        for (long key = 0; key < range; key += 2) {
+            tree.insert(key, key * 3);
+            ref[key] = key * 3;
+        }
+        checkAgainst(tree, ref, range, rng);
+        randomOps(tree, ref, 0, range, 3000, rng);
+        checkAgainst(tree, ref, range, rng);
+        tree.flush();
+    }
+    Tree reopened(path, options);
+    CHECK(reopened.getMaxLeafNodeLimit() == 65534);
+    checkAgainst(reopened, ref, range, rng);
+    std::remove(path.c_str());
+
+    // Explicit limits past what a page header counts are refused
+    options.maxLeafNodeLimit = 70000;
+    CHECK(throws([&] { Tree tree(path, options); }));
+    std::remove(path.c_str());
+    options.maxLeafNodeLimit = 0;
+    options.maxIntChildLimit = 70000;
+    CHECK(throws([&] { Tree tree(path, options); }));
+    std::remove(path.c_str());
+
+    // So are page sizes the file header cannot hold, and headers with a page size no file has
+    CHECK(throws([&] { PageFile file(path, std::size_t{1} << 32); }));
+    std::remove(path.c_str());
+    {
+        PageFile file(path, 4096);
+    }
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        const std::uint32_t bogus = 100;
+        file.seekp(8);  // past the magic
+        file.write(reinterpret_cast<const char*>(&bogus), sizeof(bogus));
+    }
+    CHECK(throws([&] { PageFile file(path); }));
+    std::remove(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(8);
+    smallNodes(EvictionPolicy::CLOCK, rng);
+    smallNodes(EvictionPolicy::LRU, rng);
+    fullPages(rng);
+    largePages(rng);
+    std::printf("disk_test passed\n");
+    return 0;
+}
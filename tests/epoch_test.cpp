@@ -0,0 +1,125 @@
+// EpochManager: nothing retired is freed while a guard that could reach it is open, all of it is after
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "bptree/epoch.hpp"
+#include "check.hpp"
+
+using bptree::EpochManager;
+
+namespace {
+
+// Freeing only marks the object, so a reader that sees the mark has read "freed" memory
+struct Object {
+    std::atomic<bool> freed{false};
+    std::uint64_t value = 0;
+};
+
+void markFreed(void* object) {
+    CHECK(!static_cast<Object*>(object)->freed.exchange(true));  // freed twice
+}
+
+int deleted = 0;
+
+void countDeleted(void* object) {
+    delete static_cast<Object*>(object);
+    deleted++;
+}
+
+void guardBlocksReclaim() {
+    // Retired under an open guard: collect() may advance past it once, but frees nothing
+    EpochManager epochs;
+    std::deque<Object> objects(10);
+    {
+        EpochManager::Guard guard(epochs);
+        for (Object& object : objects) epochs.retire(&object, markFreed);
+        for (int i = 0; i < 3; i++) CHECK(epochs.collect() == 0);
+        for (const Object& object : objects) CHECK(!object.freed);
+        CHECK(epochs.getStats().backlog == objects.size());
+    }
+    CHECK(epochs.collect() == objects.size());
+    for (const Object& object : objects) CHECK(object.freed);
+
+    bptree::EpochStats stats = epochs.getStats();
+    CHECK(stats.retired == objects.size() && stats.freed == objects.size());
+    CHECK(stats.backlog == 0);
+    CHECK(stats.collections >= 4);
+    CHECK(stats.epoch >= 3);
+
+    // With no guard open a single pass frees what was just retired
+    Object lone;
+    epochs.retire(&lone, markFreed);
+    CHECK(epochs.collect() == 1 && lone.freed);
+}
+
+void batchesAndShutdown() {
+    // Retiring collects by itself every batch, the destructor frees the rest
+    deleted = 0;
+    {
+        EpochManager epochs;
+        for (int i = 0; i < 1000; i++) epochs.retire(new Object, countDeleted);
+        bptree::EpochStats stats = epochs.getStats();
+        CHECK(stats.collections > 0);
+        CHECK(stats.freed > 0 && stats.backlog < 1000);
+        CHECK(deleted == static_cast<int>(stats.freed));
+    }
+    CHECK(deleted == 1000);
+}
+
+void concurrentReaders(std::mt19937_64& rng) {
+    // A writer swaps the shared object and retires the old one while readers keep dereferencing it
+    const int READERS = 4, SWAPS = 20000;
+    EpochManager epochs;
+    std::deque<Object> objects(SWAPS + 1);  // outlives the manager, freeing only marks
+    std::atomic<Object*> shared{&objects[0]};
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> reads{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; r++) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                EpochManager::Guard guard(epochs);
+                Object* object = shared.load();
+                for (int i = 0; i < 8; i++) CHECK(!object->freed.load());
+                CHECK(object->value <= SWAPS);
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    while (reads.load() == 0) std::this_thread::yield();
+    for (int i = 1; i <= SWAPS; i++) {
+        objects[i].value = i;
+        Object* old = shared.exchange(&objects[i]);
+        epochs.retire(old, markFreed);
+        if (rng() % 512 == 0) std::this_thread::yield();
+    }
+    done = true;
+    for (std::thread& reader : readers) reader.join();
+
+    epochs.collect();
+    epochs.collect();
+    bptree::EpochStats stats = epochs.getStats();
+    CHECK(stats.retired == SWAPS);
+    CHECK(stats.freed == SWAPS && stats.backlog == 0);
+    for (int i = 0; i < SWAPS; i++) CHECK(objects[i].freed);
+    CHECK(!objects[SWAPS].freed);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(13);
+    guardBlocksReclaim();
+    batchesAndShutdown();
+    concurrentReaders(rng);
+    std::puts("epoch_test passed");
+    return 0;
+}
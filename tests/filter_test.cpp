@@ -0,0 +1,90 @@
+// enableFilter(): the Bloom filter never hides a key the tree holds, whatever filled the tree
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "bptree/basic_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+using Tree = bptree::BasicBPTree<long, long>;
+
+namespace {
+
+std::vector<std::pair<long, long>> shuffledPairs(long first, long count, std::mt19937_64& rng) {
+    std::vector<std::pair<long, long>> pairs;
+    for (long key = first; key < first + count; key++) pairs.push_back({key, key * 3});
+    std::shuffle(pairs.begin(), pairs.end(), rng);
+    return pairs;
+}
+
+void multiInsertIntoEmptyTree(std::mt19937_64& rng) {
+    // 2000 keys overflow the smallest filter (1024 keys) halfway through the batch
+    Tree tree(16, 16);
+    tree.enableFilter(10);
+    std::vector<std::pair<long, long>> pairs = shuffledPairs(0, 2000, rng);
+    tree.multiInsert(pairs.data(), pairs.size());
+    std::map<long, long> ref(pairs.begin(), pairs.end());
+    checkFinds(tree, ref, 2500);
+    CHECK(tree.getFilterStats().keys == ref.size());
+    CHECK(tree.getFilterStats().rebuilds >= 2);
+
+    for (const auto& pair : pairs) CHECK(tree.removeKey(pair.first));
+    CHECK(!tree.contains(pairs[0].first));
+}
+
+void multiInsertPastCapacity(std::mt19937_64& rng) {
+    // A filter sized for the bulk-loaded keys, then batches several times that size
+    Tree tree(8, 8);
+    std::vector<std::pair<long, long>> loaded;
+    for (long key = 0; key < 1500; key++) loaded.push_back({key * 10, key});
+    tree.bulkLoad(loaded.begin(), loaded.end());
+    tree.enableFilter(8);
+    const std::uint64_t capacity = tree.getFilterStats().capacity;
+    std::map<long, long> ref(loaded.begin(), loaded.end());
+
+    for (long batch = 0; batch < 4; batch++) {
+        // odd keys, in between the loaded ones
+        std::vector<std::pair<long, long>> pairs = shuffledPairs(batch * 3000, 3000, rng);
+        for (auto& pair : pairs) pair.first = pair.first * 2 + 1;
+        tree.multiInsert(pairs.data(), pairs.size());
+        ref.insert(pairs.begin(), pairs.end());
+    }
+    CHECK(tree.getFilterStats().capacity > capacity);
+    checkFinds(tree, ref, 25000);
+}
+
+void mixedUpdates(std::mt19937_64& rng) {
+    // Inserts, removals and ranges, enough removals to make the filter rebuild for staleness
+    Tree tree(5, 4);
+    tree.enableFilter(10);
+    std::map<long, long> ref;
+    for (int round = 0; round < 20; round++) {
+        randomOps(tree, ref, 0, 4000, 500, rng);
+        if (round % 5 == 4) {
+            const long lo = static_cast<long>(rng() % 4000);
+            tree.removeRange(lo, lo + 300);
+            ref.erase(ref.lower_bound(lo), ref.lower_bound(lo + 300));
+        }
+        checkFinds(tree, ref, 4000);
+    }
+    CHECK(tree.getFilterStats().rebuilds > 1);
+
+    tree.disableFilter();
+    checkFinds(tree, ref, 4000);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(20);
+    multiInsertIntoEmptyTree(rng);
+    multiInsertPastCapacity(rng);
+    mixedUpdates(rng);
+    std::printf("filter_test passed\n");
+    return 0;
+}
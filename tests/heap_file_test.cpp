@@ -0,0 +1,133 @@
+// HeapFile: records read back as written through erases, slot reuse, in-page compaction and reopening
+
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bptree/heap_file.hpp"
+#include "check.hpp"
+
+using bptree::HeapFile;
+using bptree::RecordId;
+
+namespace {
+
+using Records = std::map<std::pair<bptree::PageId, std::uint32_t>, std::string>;
+
+std::string randomRecord(std::size_t length, std::mt19937_64& rng) {
+    std::string record(length, ' ');
+    for (char& c : record) c = static_cast<char>('a' + rng() % 26);
+    return record;
+}
+
+void checkAll(HeapFile& heap, const Records& ref) {
+    CHECK(heap.size() == ref.size());
+    for (const auto& entry : ref) {
+        std::optional<std::string> record = heap.read({entry.first.first, entry.first.second});
+        CHECK(record.has_value() && *record == entry.second);
+    }
+}
+
+void slotReuse() {
+    // One page with room: an erased slot is the one the next insert gets, the others keep their ids
+    const std::string path = "heap_file_test_slots.db";
+    std::remove(path.c_str());
+    HeapFile heap(path);
+    std::vector<RecordId> rids;
+    for (int i = 0; i < 10; i++) rids.push_back(heap.insert("record " + std::to_string(i)));
+    for (const RecordId& rid : rids) CHECK(rid.page == rids[0].page);
+
+    CHECK(heap.erase(rids[3]));
+    CHECK(!heap.erase(rids[3]));
+    CHECK(!heap.read(rids[3]).has_value());
+    CHECK(!heap.read({rids[0].page, 10}).has_value());  // never handed out
+    CHECK(heap.insert("the new one") == rids[3]);
+    CHECK(*heap.read(rids[3]) == "the new one");
+    for (int i = 0; i < 10; i++)
+        if (i != 3) CHECK(*heap.read(rids[i]) == "record " + std::to_string(i));
+
+    CHECK(heap.insert(std::string(heap.maxRecordSize(), 'x')).page != rids[0].page);
+    bool threw = false;
+    try {
+        heap.insert(std::string(heap.maxRecordSize() + 1, 'x'));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+    std::remove(path.c_str());
+
+    threw = false;
+    try {
+        HeapFile big("heap_file_test_big.db", 64, bptree::EvictionPolicy::CLOCK, 65536);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+    std::remove("heap_file_test_big.db");
+}
+
+void churn(std::mt19937_64& rng) {
+    /*
+		Records from empty to a third of a page, erased and inserted at random on an 8-frame pool:
+		pages evict, fragment and compact. The live data stays about the same, so the file stops
+		growing once the free-space lists have something for every size.
+	*/
+    const std::string path = "heap_file_test.db";
+    std::remove(path.c_str());
+    Records ref;
+    bptree::PageId pagesAfterWarmup = 0;
+    {
+        HeapFile heap(path, 8);
+        const std::size_t longest = heap.maxRecordSize() / 3;
+        for (int round = 0; round < 10; round++) {
+            for (int i = 0; i < 3000; i++) {
+                if (ref.size() < 1500 || rng() % 2 == 0) {
+                    std::string record = randomRecord(rng() % 8 == 0 ? rng() % longest : rng() % 64, rng);
+                    RecordId rid = heap.insert(record);
+                    CHECK(ref.emplace(std::make_pair(rid.page, rid.slot), record).second);
+                } else {
+                    auto it = std::next(ref.begin(), static_cast<long>(rng() % ref.size()));
+                    CHECK(heap.erase({it->first.first, it->first.second}));
+                    ref.erase(it);
+                }
+            }
+            checkAll(heap, ref);
+            if (round == 3) pagesAfterWarmup = heap.getFile().getPageCount();
+        }
+        CHECK(heap.getFile().getPageCount() <= pagesAfterWarmup * 3 / 2);
+        CHECK(heap.getPool().getStats().evictions > 0);
+    }  // the destructor flushes
+
+    // Reopened, every record is where it was and erases and inserts carry on
+    HeapFile heap(path, 8);
+    checkAll(heap, ref);
+    for (auto it = ref.begin(); it != ref.end();) {
+        CHECK(heap.erase({it->first.first, it->first.second}));
+        it = ref.erase(it);
+        if (it != ref.end()) ++it;
+    }
+    for (int i = 0; i < 500; i++) {
+        std::string record = randomRecord(rng() % 200, rng);
+        RecordId rid = heap.insert(record);
+        CHECK(ref.emplace(std::make_pair(rid.page, rid.slot), record).second);
+    }
+    checkAll(heap, ref);
+    std::remove(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(9);
+    slotReuse();
+    churn(rng);
+    std::printf("heap_file_test passed\n");
+    return 0;
+}
@@ -0,0 +1,148 @@
+// String keys: shortest separators, leaf prefixes, and the same answers as a tree that compresses nothing
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bptree/basic_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+namespace {
+
+using Tree = bptree::BasicBPTree<std::string, int>;
+
+// Same order as std::less, but not std::less: a tree with it keeps whole keys everywhere
+struct PlainLess {
+    bool operator()(const std::string& a, const std::string& b) const { return a < b; }
+};
+using PlainTree = bptree::BasicBPTree<std::string, int, PlainLess>;
+
+std::string randomUrl(std::mt19937_64& rng) {
+    // Few hosts and path words, so leaves share long prefixes and neighbours differ late
+    static const char* const HOSTS[] = {"https://example.com/", "https://example.org/", "http://shop.example.net/"};
+    static const char* const WORDS[] = {"alpha", "beta", "gamma", "delta", "items", "item", "list", "a", ""};
+    std::string url = HOSTS[rng() % 3];
+    for (int depth = 1 + rng() % 4; depth > 0; depth--) url += std::string(WORDS[rng() % 9]) + "/";
+    return url + std::to_string(rng() % 1000);
+}
+
+std::string sharedPrefix(const std::string& a, const std::string& b) {
+    std::size_t n = 0;
+    while (n < a.size() && n < b.size() && a[n] == b[n]) n++;
+    return a.substr(0, n);
+}
+
+// Every separator s between two subtrees has leftMax < s <= rightMin; exact: it is also the shortest
+void checkSeparators(Tree& tree, bool exact) {
+    using Node = Tree::Node;
+    std::function<void(const Node*, std::string&, std::string&)> walk = [&](const Node* node, std::string& min,
+                                                                             std::string& max) {
+        if (node->isLeaf) {
+            CHECK(node->size > 0);
+            min = node->prefix() + node->keys()[0];
+            max = node->prefix() + node->keys()[node->size - 1];
+            if (exact) CHECK(node->prefix() == sharedPrefix(min, max));
+            return;
+        }
+        std::string leftMin, leftMax;
+        walk(node->child(0), leftMin, leftMax);
+        min = leftMin;
+        for (int i = 0; i < node->size; i++) {
+            std::string rightMin, rightMax;
+            walk(node->child(i + 1), rightMin, rightMax);
+            const std::string& s = node->keys()[i];
+            CHECK(leftMax < s && s <= rightMin);
+            if (exact) CHECK(s == rightMin.substr(0, sharedPrefix(leftMax, rightMin).size() + 1));
+            leftMax = rightMax;
+        }
+        max = leftMax;
+    };
+    std::string min, max;
+    if (tree.getRoot() != NULL) walk(tree.getRoot(), min, max);
+}
+
+std::size_t storedKeyBytes(Tree& tree) {
+    std::size_t bytes = 0;
+    const Tree::Node* leaf = tree.getRoot();
+    while (!leaf->isLeaf) leaf = leaf->child(0);
+    for (; leaf != NULL; leaf = leaf->next()) {
+        bytes += leaf->prefix().size();
+        for (int i = 0; i < leaf->size; i++) bytes += leaf->keys()[i].size();
+    }
+    return bytes;
+}
+
+void bulkLoaded(std::mt19937_64& rng) {
+    // bulkLoad builds every separator and prefix from the final neighbours, so both are exact
+    std::map<std::string, int> ref;
+    while (ref.size() < 5000) ref.emplace(randomUrl(rng), static_cast<int>(ref.size()));
+    std::vector<std::pair<std::string, int>> sorted(ref.begin(), ref.end());
+
+    Tree tree(8, 8);
+    CHECK(tree.bulkLoad(sorted.begin(), sorted.end()));
+    checkTree(tree, ref);
+    checkSeparators(tree, true);
+
+    std::size_t wholeBytes = 0;
+    for (const auto& entry : ref) wholeBytes += entry.first.size();
+    CHECK(storedKeyBytes(tree) < wholeBytes / 2);
+}
+
+void churned(std::mt19937_64& rng) {
+    // Inserts and removals in any order: a compressed tree answers exactly as an uncompressed one
+    Tree tree(4, 4);
+    PlainTree plain(4, 4);
+    std::map<std::string, int> ref;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 3000; i++) keys.push_back(randomUrl(rng));
+
+    for (int step = 0; step < 30000; step++) {
+        const std::string& key = keys[rng() % keys.size()];
+        if (rng() % 3 == 0) {
+            bool present = ref.erase(key) > 0;
+            CHECK(tree.removeKey(key) == present);
+            CHECK(plain.removeKey(key) == present);
+        } else if (ref.count(key) == 0) {
+            ref.emplace(key, step);
+            tree.insert(key, step);
+            plain.insert(key, step);
+        }
+        if (step % 5000 == 4999) {
+            checkTree(tree, ref);
+            checkTree(plain, ref);
+            checkSeparators(tree, false);
+        }
+    }
+
+    // Keys that are not in the tree but sort between separators and prefixes
+    for (int i = 0; i < 2000; i++) {
+        std::string probe = keys[rng() % keys.size()];
+        probe.resize(rng() % (probe.size() + 1));
+        if (rng() % 2 == 0) probe += '~';
+        CHECK((tree.find(probe) != NULL) == (ref.count(probe) > 0));
+        CHECK((tree.lower_bound(probe) == tree.end()) == (ref.lower_bound(probe) == ref.end()));
+        if (tree.lower_bound(probe) != tree.end()) CHECK(tree.lower_bound(probe).key() == ref.lower_bound(probe)->first);
+    }
+
+    for (const auto& entry : std::map<std::string, int>(ref)) {
+        CHECK(tree.removeKey(entry.first));
+        ref.erase(entry.first);
+    }
+    checkTree(tree, ref);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(16);
+    bulkLoaded(rng);
+    churned(rng);
+    std::puts("key_compression_test passed");
+    return 0;
+}
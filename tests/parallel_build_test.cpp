@@ -0,0 +1,122 @@
+// parallelBulkLoad: any #of threads builds the tree a stable sort and bulkLoad would, equal keys in input order
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "bptree/basic_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+using Tree = bptree::BasicBPTree<long, long>;
+using Pairs = std::vector<std::pair<long, long>>;
+
+namespace {
+
+// Values are input positions, so a stable sort by key is the only right answer for duplicates
+Pairs randomPairs(std::size_t n, long range, std::mt19937_64& rng) {
+    Pairs pairs;
+    for (std::size_t i = 0; i < n; i++) pairs.push_back({static_cast<long>(rng() % range), static_cast<long>(i)});
+    return pairs;
+}
+
+Pairs stableSorted(Pairs pairs) {
+    std::stable_sort(pairs.begin(), pairs.end(),
+                     [](const std::pair<long, long>& a, const std::pair<long, long>& b) { return a.first < b.first; });
+    return pairs;
+}
+
+template <typename T>
+void checkSequence(const T& tree, const Pairs& expected) {
+    auto next = expected.begin();
+    for (auto it = tree.begin(); it != tree.end(); ++it, ++next) {
+        CHECK(next != expected.end());
+        CHECK(it.key() == next->first && it.value() == next->second);
+    }
+    CHECK(next == expected.end());
+}
+
+void uniqueKeys(int fanout, unsigned threads, double fill, std::mt19937_64& rng) {
+    // A shuffled permutation, loaded on top of an earlier tree, then updated
+    const std::size_t n = 300000;
+    Pairs pairs;
+    for (std::size_t i = 0; i < n; i++) pairs.push_back({static_cast<long>(i) * 3, static_cast<long>(i)});
+    std::shuffle(pairs.begin(), pairs.end(), rng);
+    std::map<long, long> ref(pairs.begin(), pairs.end());
+
+    Tree tree(fanout, fanout);
+    for (long key = 0; key < 1000; key++) tree.insert(key * 7 + 1, key);  // replaced by the load
+    tree.parallelBulkLoad(pairs.begin(), pairs.end(), fill, threads);
+    checkTree(tree, ref);
+
+    for (int i = 0; i < 20000; i++) {
+        const long key = static_cast<long>(rng() % (3 * n));
+        if (rng() % 2 == 0) {
+            if (ref.emplace(key, -key).second) tree.insert(key, -key);
+        } else {
+            CHECK(tree.removeKey(key) == (ref.erase(key) == 1));
+        }
+    }
+    checkTree(tree, ref);
+}
+
+void duplicateKeys(int fanout, unsigned threads, std::mt19937_64& rng) {
+    // About 8 pairs per key, runs of equal keys span leaves and partitions
+    for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{5}, std::size_t{5000}, std::size_t{280000}}) {
+        Pairs pairs = randomPairs(n, static_cast<long>(n / 8 + 1), rng);
+        const Pairs expected = stableSorted(pairs);
+        Tree tree(fanout, fanout);
+        tree.parallelBulkLoad(pairs.begin(), pairs.end(), 1.0, threads);
+        CHECK((tree.getRoot() == NULL) == (n == 0));
+        checkSequence(tree, expected);
+
+        Tree serial(fanout, fanout);
+        CHECK(serial.bulkLoad(expected.begin(), expected.end()));
+        checkSequence(serial, expected);
+    }
+}
+
+void skewedDuplicates(unsigned threads, std::mt19937_64& rng) {
+    // Three keys for 400k pairs: the splitters repeat, so some partitions get no pairs at all
+    Pairs pairs;
+    for (std::size_t i = 0; i < 400000; i++) pairs.push_back({i % 10 == 0 ? 100 : i % 10 < 3 ? 200 : 300, 0});
+    std::shuffle(pairs.begin(), pairs.end(), rng);
+    for (std::size_t i = 0; i < pairs.size(); i++) pairs[i].second = static_cast<long>(i);
+    const Pairs expected = stableSorted(pairs);
+
+    Tree tree(16, 16);
+    tree.parallelBulkLoad(pairs.begin(), pairs.end(), 1.0, threads);
+    checkSequence(tree, expected);
+    for (long key : {100L, 200L, 300L}) {
+        CHECK(tree.find(key) != NULL);
+        CHECK(tree.lower_bound(key) != tree.end() && tree.lower_bound(key).key() == key);
+    }
+    CHECK(tree.find(0) == NULL && tree.find(250) == NULL);
+}
+
+void staticFanout(std::mt19937_64& rng) {
+    bptree::BasicBPTree<long, long, std::less<long>, 16> tree;
+    Pairs pairs = randomPairs(200000, 50000, rng);
+    const Pairs expected = stableSorted(pairs);
+    tree.parallelBulkLoad(pairs.begin(), pairs.end(), 0.8, 3);
+    checkSequence(tree, expected);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(23);
+    for (int fanout : {3, 16, 64}) {
+        uniqueKeys(fanout, 1, 0.7, rng);
+        uniqueKeys(fanout, 4, 1.0, rng);
+        for (unsigned threads : {1u, 2u, 3u, 4u, 8u}) duplicateKeys(fanout, threads, rng);
+    }
+    for (unsigned threads : {2u, 4u, 8u}) skewedDuplicates(threads, rng);
+    staticFanout(rng);
+    std::printf("parallel_build_test passed\n");
+    return 0;
+}
@@ -0,0 +1,175 @@
+// removeRange: all of [lo, hi), duplicates too, and nothing else; subtrees freed whole, the log replays it
+
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bptree/basic_bptree.hpp"
+#include "bptree/bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+namespace {
+
+using Tree = bptree::BasicBPTree<int, long>;
+
+// ref's part of the work: erase [lo, hi) and hand back what went, in key order
+std::vector<int> eraseRange(std::map<int, long>& ref, int lo, int hi) {
+    std::vector<int> gone;
+    auto first = ref.lower_bound(lo), last = lo < hi ? ref.lower_bound(hi) : first;
+    for (auto it = first; it != last; ++it) gone.push_back(it->first);
+    ref.erase(first, last);
+    return gone;
+}
+
+void randomRanges(int degree, std::mt19937_64& rng) {
+    // Ranges of every width, from inside one leaf to most of the tree, between random refills
+    Tree tree(degree, degree);
+    std::map<int, long> ref;
+    for (int round = 0; round < 300; round++) {
+        for (int i = 0; i < 200; i++) {
+            int key = static_cast<int>(rng() % 10000);
+            if (ref.emplace(key, -key).second) tree.insert(key, -key);
+        }
+        int lo = static_cast<int>(rng() % 10000);
+        int hi = lo + static_cast<int>(round % 10 == 0 ? rng() % 10000 : rng() % 300) - 20;
+
+        std::vector<int> removed;
+        std::size_t count = tree.removeRange(lo, hi, [&removed](const int& key, const long& value) {
+            CHECK(value == -key);
+            removed.push_back(key);
+        });
+        std::vector<int> expected = eraseRange(ref, lo, hi);
+        CHECK(removed == expected);
+        CHECK(count == expected.size());
+        checkTree(tree, ref);
+    }
+}
+
+void duplicates(std::mt19937_64& rng) {
+    // Few distinct keys on small nodes: copies of lo sit left of a separator equal to lo, and go too
+    for (int trial = 0; trial < 2000; trial++) {
+        Tree tree(3, 3);
+        std::multimap<long, long> ref;
+        const int n = 50 + static_cast<int>(rng() % 201);
+        for (int i = 0; i < n; i++) {
+            const long key = static_cast<long>(rng() % 20);
+            tree.insert(key, i);
+            ref.emplace(key, i);
+        }
+        const long lo = static_cast<long>(rng() % 20), hi = lo + 1 + static_cast<long>(rng() % 5);
+
+        std::vector<long> removed;
+        std::size_t count = tree.removeRange(lo, hi, [&removed](const long& key, const long&) { removed.push_back(key); });
+        std::vector<long> expected;
+        for (auto it = ref.lower_bound(lo); it != ref.lower_bound(hi); ++it) expected.push_back(it->first);
+        ref.erase(ref.lower_bound(lo), ref.lower_bound(hi));
+        CHECK(removed == expected);
+        CHECK(count == expected.size());
+
+        auto next = ref.begin();
+        for (auto it = tree.begin(); it != tree.end(); ++it, ++next) {
+            CHECK(next != ref.end());
+            CHECK(it.key() == next->first && it.value() == next->second);
+        }
+        CHECK(next == ref.end());
+    }
+}
+
+void edges() {
+    Tree tree(4, 4);
+    CHECK(tree.removeRange(0, 100) == 0);  // empty tree
+
+    std::map<int, long> ref;
+    for (int i = 0; i < 1000; i++) {
+        tree.insert(2 * i, i);
+        ref[2 * i] = i;
+    }
+    CHECK(tree.removeRange(50, 50) == 0);   // empty range
+    CHECK(tree.removeRange(60, 40) == 0);   // reversed
+    CHECK(tree.removeRange(51, 52) == 0);   // between two keys
+    CHECK(tree.removeRange(-100, 0) == 0);  // before the first key
+    CHECK(tree.removeRange(2000, 3000) == 0);
+    checkTree(tree, ref);
+
+    // Bounds on keys: lo is removed, hi stays
+    CHECK(tree.removeRange(100, 200) == 50);
+    eraseRange(ref, 100, 200);
+    CHECK(tree.find(100) == NULL && tree.find(200) != NULL);
+    checkTree(tree, ref);
+
+    // Everything but the two ends, then everything: whole subtrees go back to the slabs
+    bptree::MemoryStats before = tree.getMemoryStats();
+    CHECK(tree.removeRange(2, 1998) == ref.size() - 2);
+    eraseRange(ref, 2, 1998);
+    checkTree(tree, ref);
+    bptree::MemoryStats after = tree.getMemoryStats();
+    CHECK(after.leafNodes == 1 && after.internalNodes == 0);
+    CHECK(after.bytesInUse < before.bytesInUse);
+
+    CHECK(tree.removeRange(-1, 5000) == 2);
+    CHECK(tree.getRoot() == NULL && tree.getMemoryStats().leafNodes == 0);
+    tree.insert(7, 7);
+    CHECK(tree.find(7) != NULL && *tree.find(7) == 7);
+}
+
+void table(std::mt19937_64& rng) {
+    // BPTree erases the tuples of the range too, and a restart replays the range from the log
+    const std::string tuples = "range_removal_test_tuples.db", logFile = "range_removal_test_tuples.wal";
+    std::remove(tuples.c_str());
+    std::remove(logFile.c_str());
+    std::ostringstream quiet;  // the demo tree narrates every step on cout
+    std::streambuf* out = std::cout.rdbuf(quiet.rdbuf());
+
+    std::map<int, std::string> ref;
+    {
+        bptree::BPTree tree(4, 4, tuples, logFile);
+        for (int round = 0; round < 20; round++) {
+            for (int i = 0; i < 100; i++) {
+                int key = static_cast<int>(rng() % 2000);
+                std::string tuple = "tuple " + std::to_string(key) + "/" + std::to_string(round);
+                tree.insertTuple(key, tuple);
+                ref[key] = tuple;
+            }
+            int lo = static_cast<int>(rng() % 2000);
+            int hi = lo + static_cast<int>(rng() % 200);
+            tree.removeRange(lo, hi);
+            ref.erase(ref.lower_bound(lo), ref.lower_bound(hi));
+            CHECK(tree.getTuples().size() == ref.size());
+        }
+    }
+    std::remove(tuples.c_str());
+    bptree::BPTree tree(4, 4, tuples, logFile);
+    std::cout.rdbuf(out);
+
+    CHECK(tree.getTuples().size() == ref.size());
+    for (int key = 0; key < 2000; key++) {
+        bptree::RecordId* rid = tree.find(key);
+        auto it = ref.find(key);
+        CHECK((rid != NULL) == (it != ref.end()));
+        if (rid != NULL) {
+            std::optional<std::string> tuple = tree.getTuples().read(*rid);
+            CHECK(tuple.has_value() && *tuple == it->second);
+        }
+    }
+    std::remove(tuples.c_str());
+    std::remove(logFile.c_str());
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(21);
+    for (int degree : {3, 4, 16}) randomRanges(degree, rng);
+    duplicates(rng);
+    edges();
+    table(rng);
+    std::puts("range_removal_test passed");
+    return 0;
+}
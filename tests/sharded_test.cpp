@@ -0,0 +1,156 @@
+// ShardedBPTree: routing, scans across shards, bulkLoad and rebalance() against std::map, alone and under load
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bptree/sharded_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+using Tree = bptree::ShardedBPTree<long, long>;
+
+namespace {
+
+constexpr int THREADS = 8;  // of concurrentOps, each on the keys congruent to it modulo THREADS
+constexpr long RANGE = 16000;
+
+/*
+	The tree holds exactly ref: find for every key in [0, range), a full scan, a few range scans
+	that cross fences, and every shard's key count matching the range its fences give it.
+*/
+void checkAgainst(const Tree& tree, const std::map<long, long>& ref, long range, std::mt19937_64& rng) {
+    CHECK(tree.size() == ref.size());
+    checkFinds(tree, ref, range);
+    checkScans(tree, ref, range, range / 4, 10, rng);
+
+    const std::vector<long> fences = tree.getFences();
+    CHECK(fences.size() + 1 == tree.shardCount());
+    CHECK(std::is_sorted(fences.begin(), fences.end()));
+    const bptree::ShardedStats stats = tree.getStats();
+    for (std::size_t s = 0; s < tree.shardCount(); s++) {
+        auto first = s == 0 ? ref.begin() : ref.lower_bound(fences[s - 1]);
+        auto last = s == fences.size() ? ref.end() : ref.lower_bound(fences[s]);
+        CHECK(stats.shards[s].keys == static_cast<std::uint64_t>(std::distance(first, last)));
+    }
+}
+
+void routing(std::mt19937_64& rng) {
+    // Keys below the first fence, on a fence, past the last one; shards with small nodes
+    Tree tree({1000, 2000, 3000}, 5, 4);
+    CHECK(tree.shardCount() == 4);
+    std::map<long, long> ref;
+    const long range = 4000;
+    for (int round = 0; round < 4; round++) {
+        randomOps(tree, ref, 0, range, 3000, rng);
+        for (long fence : {1000L, 2000L, 3000L}) {
+            CHECK(tree.insert(fence, -fence) == (ref.count(fence) == 0));
+            ref[fence] = -fence;
+        }
+        checkAgainst(tree, ref, range, rng);
+    }
+}
+
+void loadAndRebalance(std::mt19937_64& rng) {
+    Tree tree({0, 0, 0, 0, 0, 0, 0}, 16, 16);
+    std::vector<std::pair<long, long>> pairs;
+    for (long key = 0; key < 40000; key++) pairs.push_back({key, key * 2});
+    std::map<long, long> ref(pairs.begin(), pairs.end());
+    std::vector<std::pair<long, long>> unsorted = {{5, 1}, {3, 1}};
+    CHECK(!tree.bulkLoad(unsorted.begin(), unsorted.end()));
+    CHECK(tree.size() == 0);
+    CHECK(tree.bulkLoad(pairs.begin(), pairs.end(), 1.0, 3));
+    checkAgainst(tree, ref, 40000, rng);
+    for (const bptree::ShardStats& shard : tree.getStats().shards) CHECK(shard.keys == 5000);
+
+    // Every operation lands in the last shard, rebalance() spreads its range over the others
+    const std::uint64_t before = tree.getStats().movedKeys;
+    for (int call = 0; call < 6; call++) {
+        randomOps(tree, ref, 35000, 40000, 4000, rng);
+        tree.rebalance(1.25);
+        checkAgainst(tree, ref, 40000, rng);
+    }
+    const bptree::ShardedStats stats = tree.getStats();
+    CHECK(stats.rebalances > 0 && stats.movedKeys > before);
+    CHECK(tree.getFences().back() > 35000);
+
+    // Without operations the key counts are the load: repeated calls even them out
+    for (int call = 0; call < 20; call++) tree.rebalance(1.1);
+    checkAgainst(tree, ref, 40000, rng);
+    std::uint64_t fewest = ref.size(), most = 0;
+    for (const bptree::ShardStats& shard : tree.getStats().shards) {
+        fewest = std::min(fewest, shard.keys);
+        most = std::max(most, shard.keys);
+    }
+    CHECK(static_cast<double>(most) <= 1.5 * static_cast<double>(fewest));
+}
+
+void concurrentOps(std::mt19937_64& rng) {
+    // 8 threads on disjoint key stripes, a scanner and a thread moving the fences the whole time
+    Tree tree({2000, 4000, 6000, 8000, 10000, 12000, 14000}, 8, 8);
+    std::vector<std::map<long, long>> refs(THREADS);
+    std::atomic<int> running{THREADS};
+
+    auto worker = [&tree, &refs, &running](int t, unsigned seed) {
+        std::mt19937_64 wrng(seed);
+        std::map<long, long>& ref = refs[t];
+        for (int i = 0; i < 15000; i++) {
+            // Skewed towards the low keys, so rebalance() has work to do
+            const long key = static_cast<long>(wrng() % (wrng() % 4 == 0 ? RANGE : RANGE / 4)) / THREADS * THREADS + t;
+            const int kind = static_cast<int>(wrng() % 4);
+            if (kind < 2) {
+                CHECK(tree.insert(key, key * 100 + i % 100) == (ref.count(key) == 0));
+                ref[key] = key * 100 + i % 100;
+            } else if (kind == 2) {
+                CHECK(tree.removeKey(key) == (ref.erase(key) == 1));
+            } else {
+                std::optional<long> value = tree.find(key);
+                auto it = ref.find(key);
+                CHECK(value.has_value() == (it != ref.end()));
+                if (value.has_value()) CHECK(*value == it->second);
+            }
+        }
+        running--;
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) threads.emplace_back(worker, t, static_cast<unsigned>(rng()));
+    threads.emplace_back([&tree, &running] {
+        while (running > 0) {
+            long last = -1;
+            tree.scan(0, RANGE, [&last](const long& key, const long& value) {
+                CHECK(key > last && value / 100 == key);
+                last = key;
+            });
+        }
+    });
+    threads.emplace_back([&tree, &running] {
+        while (running > 0) {
+            tree.rebalance(1.2);
+            std::this_thread::yield();
+        }
+    });
+    for (std::thread& thread : threads) thread.join();
+
+    std::map<long, long> ref;
+    for (const auto& own : refs) ref.insert(own.begin(), own.end());
+    checkAgainst(tree, ref, RANGE, rng);
+    CHECK(tree.getStats().rebalances > 0);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(24);
+    routing(rng);
+    loadAndRebalance(rng);
+    concurrentOps(rng);
+    std::printf("sharded_test passed\n");
+    return 0;
+}
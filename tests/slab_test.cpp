@@ -0,0 +1,134 @@
+// NodeSlab: aligned blocks, free-list reuse before new memory, doubling chunks; a tree's node memory under churn
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "bptree/basic_bptree.hpp"
+#include "bptree/node_slab.hpp"
+#include "check.hpp"
+
+using bptree::CACHE_LINE_SIZE;
+using bptree::NodeSlab;
+
+namespace {
+
+bool aligned(const void* block) {
+    return reinterpret_cast<std::uintptr_t>(block) % CACHE_LINE_SIZE == 0;
+}
+
+void blocksAndChunks() {
+    // Sizes round up to whole cache lines, chunks hold 16, 32, 64... blocks
+    CHECK(NodeSlab(1).blockSize() == CACHE_LINE_SIZE);
+    CHECK(NodeSlab(CACHE_LINE_SIZE + 1).blockSize() == 2 * CACHE_LINE_SIZE);
+
+    NodeSlab slab(100);
+    const std::size_t block = slab.blockSize();
+    CHECK(block == 2 * CACHE_LINE_SIZE);
+    CHECK(slab.chunkCount() == 0 && slab.bytesReserved() == 0);
+
+    std::vector<void*> blocks;
+    std::set<void*> distinct;
+    for (int i = 0; i < 16; i++) blocks.push_back(slab.allocate());
+    CHECK(slab.chunkCount() == 1 && slab.bytesReserved() == 16 * block);
+    blocks.push_back(slab.allocate());
+    CHECK(slab.chunkCount() == 2 && slab.bytesReserved() == 48 * block);
+    while (blocks.size() < 48) blocks.push_back(slab.allocate());
+    CHECK(slab.chunkCount() == 2);
+    blocks.push_back(slab.allocate());
+    CHECK(slab.chunkCount() == 3 && slab.bytesReserved() == 112 * block);
+
+    for (void* b : blocks) {
+        CHECK(aligned(b));
+        std::memset(b, 0xAB, block);  // the whole block is ours
+        distinct.insert(b);
+    }
+    CHECK(distinct.size() == blocks.size());
+    CHECK(slab.liveCount() == blocks.size() && slab.bytesInUse() == blocks.size() * block);
+
+    // Released blocks come back last in, first out, before the bump pointer moves on
+    slab.release(blocks[5]);
+    slab.release(blocks[30]);
+    CHECK(slab.liveCount() == blocks.size() - 2);
+    CHECK(slab.allocate() == blocks[30]);
+    CHECK(slab.allocate() == blocks[5]);
+    CHECK(slab.bytesReserved() == 112 * block);
+
+    // Moving hands the chunks over, reset gives them all back
+    NodeSlab moved(std::move(slab));
+    CHECK(slab.chunkCount() == 0 && slab.liveCount() == 0);
+    CHECK(moved.chunkCount() == 3 && moved.liveCount() == blocks.size());
+    moved.reset();
+    CHECK(moved.chunkCount() == 0 && moved.bytesReserved() == 0 && moved.liveCount() == 0);
+    CHECK(aligned(moved.allocate()) && moved.chunkCount() == 1);
+}
+
+void churnRecycles(std::mt19937_64& rng) {
+    // Once the free list is warm, releasing and allocating in any order reserves nothing new
+    NodeSlab slab(64);
+    std::vector<void*> live;
+    for (int i = 0; i < 5000; i++) live.push_back(slab.allocate());
+    const std::size_t reserved = slab.bytesReserved(), chunks = slab.chunkCount();
+    for (int round = 0; round < 100000; round++) {
+        if (!live.empty() && (rng() % 2 == 0 || live.size() == 5000)) {
+            std::swap(live[rng() % live.size()], live.back());
+            slab.release(live.back());
+            live.pop_back();
+        } else {
+            live.push_back(slab.allocate());
+        }
+    }
+    CHECK(slab.bytesReserved() == reserved && slab.chunkCount() == chunks);
+    CHECK(slab.liveCount() == live.size());
+    CHECK(std::set<void*>(live.begin(), live.end()).size() == live.size());
+}
+
+void treeMemory(std::mt19937_64& rng) {
+    // Node counts follow the tree, churn at a steady size lives off the nodes it frees
+    bptree::BasicBPTree<int, int> tree(16, 16);
+    CHECK(tree.getMemoryStats().bytesReserved == 0);
+
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 1600; i++) pairs.emplace_back(i, i);
+    CHECK(tree.bulkLoad(pairs.begin(), pairs.end()));
+    bptree::MemoryStats loaded = tree.getMemoryStats();
+    CHECK(loaded.leafNodes == 100);
+    CHECK(loaded.internalNodes >= 7);
+    CHECK(loaded.bytesInUse <= loaded.bytesReserved);
+
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 20000; i++) {
+            int key = static_cast<int>(rng() % 4000);
+            if (rng() % 2 == 0) {
+                tree.removeKey(key);
+            } else if (tree.find(key) == NULL) {
+                tree.insert(key, key);
+            }
+        }
+        if (round == 0) loaded = tree.getMemoryStats();
+    }
+    bptree::MemoryStats churned = tree.getMemoryStats();
+    CHECK(churned.bytesReserved <= 2 * loaded.bytesReserved);
+    CHECK(churned.bytesInUse <= churned.bytesReserved);
+
+    for (int key = 0; key < 4000; key++) tree.removeKey(key);
+    bptree::MemoryStats empty = tree.getMemoryStats();
+    CHECK(empty.leafNodes + empty.internalNodes <= 1);  // at most an empty root leaf
+    CHECK(empty.bytesReserved == churned.bytesReserved);  // kept for the next inserts
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(15);
+    blocksAndChunks();
+    churnRecycles(rng);
+    treeMemory(rng);
+    std::puts("slab_test passed");
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Snapshot images: save()/open() round trips, copy-on-write over the mapping, rejected images
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "bptree/basic_bptree.hpp"
+#include "bptree/bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+namespace {
+
+using Tree = bptree::BasicBPTree<int, long>;
+
+std::string fileBytes(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+template <typename Call>
+bool throws(Call&& call) {
+    try {
+        call();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void roundTrip(std::mt19937_64& rng) {
+    const std::string path = "snapshot_test.img", second = "snapshot_test_2.img";
+    std::map<int, long> ref;
+    Tree tree(5, 7);
+    randomOps(tree, ref, 0, 20000, 30000, rng);
+    tree.save(path);
+    const std::string saved = fileBytes(path);
+
+    // The limits come from the image, whatever the opening tree was built with
+    Tree opened(64, 64);
+    opened.insert(-1, 1);
+    opened.open(path);
+    CHECK(opened.getMaxIntChildLimit() == 5 && opened.getMaxLeafNodeLimit() == 7);
+    CHECK(opened.getMemoryStats().bytesMapped == saved.size());
+    checkTree(opened, ref);
+
+    // Writes copy the pages they touch, the file stays as saved
+    std::map<int, long> changed = ref;
+    randomOps(opened, changed, 0, 20000, 30000, rng);
+    checkTree(opened, changed);
+    CHECK(fileBytes(path) == saved);
+
+    Tree again;
+    again.open(path);
+    checkTree(again, ref);
+
+    // A tree half in the image and half in the slabs saves like any other
+    opened.save(second);
+    Tree reopened;
+    reopened.open(second);
+    checkTree(reopened, changed);
+    std::remove(path.c_str());
+    std::remove(second.c_str());
+}
+
+void edgeCases() {
+    const std::string path = "snapshot_test_edge.img";
+
+    // An empty tree, and opening it over a full one
+    Tree empty(4, 4);
+    empty.save(path);
+    Tree full(4, 4);
+    for (int i = 0; i < 100; i++) full.insert(i, i);
+    full.open(path);
+    CHECK(full.getRoot() == NULL && full.begin() == full.end());
+    full.insert(1, 2);
+    CHECK(full.find(1) != NULL && *full.find(1) == 2);
+
+    // Other key or value types, and files that are no image at all
+    Tree small(4, 4);
+    small.insert(1, 1);
+    small.save(path);
+    bptree::BasicBPTree<long long, long> wide;
+    CHECK(throws([&] { wide.open(path); }));
+    bptree::BasicBPTree<int, int> narrow;
+    CHECK(throws([&] { narrow.open(path); }));
+
+    std::string bytes = fileBytes(path);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes.substr(0, bytes.size() - 8);  // cut short
+    }
+    Tree cut;
+    CHECK(throws([&] { cut.open(path); }));
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << std::string(bytes.size(), 'x');
+    }
+    CHECK(throws([&] { cut.open(path); }));
+    std::remove(path.c_str());
+}
+
+void table(std::mt19937_64& rng) {
+    // BPTree::save() and BPTree::open(): the index from the image, the tuples from the kept heap file
+    const std::string tuples = "snapshot_test_tuples.db", index = "snapshot_test_tuples.idx";
+    std::ostringstream quiet;  // the demo tree narrates every step on cout
+    std::streambuf* out = std::cout.rdbuf(quiet.rdbuf());
+
+    std::map<int, std::string> ref;
+    {
+        bptree::BPTree tree(4, 4, tuples);
+        for (int i = 0; i < 3000; i++) {
+            int key = static_cast<int>(rng() % 1000);
+            std::string tuple = "student " + std::to_string(key) + " v" + std::to_string(i);
+            tree.insertTuple(key, tuple);
+            ref[key] = tuple;
+        }
+        tree.save(index);
+    }
+    std::unique_ptr<bptree::BPTree> tree = bptree::BPTree::open(index, tuples);
+    std::cout.rdbuf(out);
+
+    CHECK(tree->getLog() == NULL);
+    CHECK(tree->getTuples().size() == ref.size());
+    for (const auto& entry : ref) {
+        bptree::RecordId* rid = tree->find(entry.first);
+        CHECK(rid != NULL);
+        std::optional<std::string> tuple = tree->getTuples().read(*rid);
+        CHECK(tuple.has_value() && *tuple == entry.second);
+    }
+    tree.reset();
+    std::remove(tuples.c_str());
+    std::remove(index.c_str());
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(18);
+    roundTrip(rng);
+    edgeCases();
+    table(rng);
+    std::puts("snapshot_test passed");
+    return 0;
+}
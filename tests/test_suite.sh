@@ -77,12 +77,13 @@ run_test_case() {
     local test_name="$1"
     local test_input="$2"
     local expected_patterns="$3"
+    local demo_args="${4:-}"
     
     print_status "Running test: $test_name"
     
     # Run the test and capture output
     local output
-    output=$(echo "$test_input" | ./bptree_demo 2>&1)
+    output=$(echo "$test_input" | ./bptree_demo $demo_args 2>&1)
     local exit_code=$?
     
     # Check if the program ran successfully
@@ -109,10 +110,13 @@ run_test_case() {
     fi
 }
 
-# Function to count files in DBFiles directory
-count_db_files() {
-    if [ -d "$ORIGINAL_DBFILES" ]; then
-        find "$ORIGINAL_DBFILES" -name "*.txt" -not -name "dummy*" | wc -l
+# Tuples live in one heap file of the DBFiles directory
+TUPLE_FILE="$ORIGINAL_DBFILES/tuples.db"
+
+# Function to print the size of the tuple heap file in bytes
+tuple_file_size() {
+    if [ -f "$TUPLE_FILE" ]; then
+        wc -c < "$TUPLE_FILE" | tr -d ' '
     else
         echo "0"
     fi
@@ -151,12 +155,12 @@ Key NOT FOUND"
         passed_tests=$((passed_tests + 1))
     fi
     
-    # Verify files were created
-    local file_count=$(count_db_files)
-    if [ "$file_count" -ge 2 ]; then
-        print_success "File creation verified: $file_count files created"
+    # Verify the tuples reached the heap file
+    local heap_size=$(tuple_file_size)
+    if [ "$heap_size" -gt 0 ]; then
+        print_success "Tuple storage verified: $TUPLE_FILE holds $heap_size bytes"
     else
-        print_warning "Expected at least 2 files, found $file_count"
+        print_warning "Expected tuples in $TUPLE_FILE, found none"
     fi
     
     # Test 2: Tree Splitting Operations
@@ -208,13 +212,14 @@ Test3 22 82
     local test3_expected="I AM ROOT
 Inserted successfully
 Inserted successfully
-Successfully Deleted file"
+Successfully Deleted tuple"
     
     if run_test_case "Delete Operations" "$test3_input" "$test3_expected"; then
         passed_tests=$((passed_tests + 1))
     fi
     
     # Test 4: Complex Delete with Underflow
+    # 402 goes in last: an ascending run would split 100/0 and leave no leaf to underflow
     total_tests=$((total_tests + 1))
     local test4_input="4
 3
@@ -222,14 +227,14 @@ Successfully Deleted file"
 401
 A 20 80
 1
-402
-B 21 81
-1
 403
 C 22 82
 1
 404
 D 23 83
+1
+402
+B 21 81
 4
 402
 3
@@ -237,7 +242,7 @@ D 23 83
 5"
     local test4_expected="I AM ROOT
 Created new Root
-Successfully Deleted file
+Successfully Deleted tuple
 UnderFlow"
     
     if run_test_case "Complex Delete with Underflow" "$test4_input" "$test4_expected"; then
@@ -275,7 +280,7 @@ Single 25 95
 1
 5"
     local test6_expected="I AM ROOT
-Successfully Deleted file
+Successfully Deleted tuple
 Tree is Empty Now"
     
     if run_test_case "Single Node Tree" "$test6_input" "$test6_expected"; then
@@ -346,8 +351,8 @@ TestC 22 82
 1
 5"
     local test8_expected="I AM ROOT
-Successfully Deleted file
-Successfully Deleted file"
+Successfully Deleted tuple
+Successfully Deleted tuple"
     
     if run_test_case "Use-After-Free Regression Test" "$test8_input" "$test8_expected"; then
         passed_tests=$((passed_tests + 1))
@@ -367,7 +372,7 @@ Root 30 90
 1
 5"
     local test9_expected="I AM ROOT
-Successfully Deleted file
+Successfully Deleted tuple
 Tree is Empty Now"
     
     if run_test_case "NULL Pointer Regression Test" "$test9_input" "$test9_expected"; then
@@ -399,8 +404,8 @@ BoundsD 28 88
 1
 5"
     local test10_expected="I AM ROOT
-Successfully Deleted file
-Successfully Deleted file"
+Successfully Deleted tuple
+Successfully Deleted tuple"
     
     if run_test_case "Array Bounds Regression Test" "$test10_input" "$test10_expected"; then
         passed_tests=$((passed_tests + 1))
@@ -431,6 +436,108 @@ Inserted successfully
         passed_tests=$((passed_tests + 1))
     fi
     
+    # Test 12: Write-Ahead Log Recovery
+    # The first run logs two inserts and a delete, the second one has to rebuild that state
+    total_tests=$((total_tests + 1))
+    rm -f "$ORIGINAL_DBFILES/tuples.wal"
+    local test12_write="4
+3
+1
+1201
+Logged 20 80
+1
+1202
+Kept 21 81
+4
+1201
+5"
+    local test12_input="4
+3
+2
+1202
+2
+1201
+5"
+    local test12_expected="Recovered 3 logged changes
+Kept 21 81
+Key NOT FOUND"
+    
+    if run_test_case "WAL Recovery (logging run)" "$test12_write" "Successfully Deleted tuple" "--wal" &&
+       run_test_case "WAL Recovery" "$test12_input" "$test12_expected" "--wal"; then
+        passed_tests=$((passed_tests + 1))
+    fi
+    rm -f "$ORIGINAL_DBFILES/tuples.wal"
+    
+    # Test 13: Snapshot Reopen
+    # Every run saves its index on exit, --open has to serve the keys of the previous one
+    total_tests=$((total_tests + 1))
+    rm -f "$ORIGINAL_DBFILES/tuples.idx"
+    local test13_write="4
+3
+1
+1301
+Saved 30 90
+1
+1302
+Saved 31 91
+5"
+    local test13_input="2
+1302
+2
+1303
+5"
+    local test13_expected="Opened the index saved in
+Saved 31 91
+Key NOT FOUND"
+    
+    if run_test_case "Snapshot Reopen (saving run)" "$test13_write" "Saved the index to" &&
+       run_test_case "Snapshot Reopen" "$test13_input" "$test13_expected" "--open"; then
+        passed_tests=$((passed_tests + 1))
+    fi
+    rm -f "$ORIGINAL_DBFILES/tuples.idx"
+    
+    # Test 14: Range Delete
+    # [1402, 1405) spans several leaves, the keys around it and their tuples have to stay
+    total_tests=$((total_tests + 1))
+    local test14_input="4
+3
+1
+1401
+First 20 80
+1
+1402
+Gone 21 81
+1
+1403
+Gone 22 82
+1
+1404
+Gone 23 83
+1
+1405
+Stays 24 84
+1
+1406
+Last 25 85
+6
+1402
+1405
+2
+1403
+2
+1405
+3
+2
+5"
+    local test14_expected="Deleted 3 keys in \[1402, 1405) and 3 of their tuples
+Key NOT FOUND
+Stays 24 84
+1401 1405 1406"
+    
+    if run_test_case "Range Delete" "$test14_input" "$test14_expected"; then
+        passed_tests=$((passed_tests + 1))
+    fi
+    
     # Print test summary
     echo ""
     print_status "=== TEST SUMMARY ==="
@@ -457,25 +564,15 @@ verify_file_operations() {
         return 1
     fi
     
-    # Count files created during tests
-    local file_count=$(count_db_files)
-    print_status "Total data files created: $file_count"
-    
-    # Verify some files have content
-    local files_with_content=0
-    for file in "$ORIGINAL_DBFILES"/*.txt; do
-        if [ -f "$file" ] && [ -s "$file" ]; then
-            files_with_content=$((files_with_content + 1))
-        fi
-    done
-    
-    print_status "Files with content: $files_with_content"
+    # The last run leaves its heap file behind: header page plus at least one tuple page
+    local heap_size=$(tuple_file_size)
+    print_status "Tuple heap file size: $heap_size bytes"
     
-    if [ $files_with_content -gt 0 ]; then
+    if [ "$heap_size" -gt 0 ]; then
         print_success "File operations verified successfully"
         return 0
     else
-        print_error "No files with content found"
+        print_error "No tuples found in $TUPLE_FILE"
         return 1
     fi
 }
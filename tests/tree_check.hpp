@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+#include "check.hpp"
+
+// How full checkTree() expects the non-root nodes of a BasicBPTree to be
+enum class Minimum {
+    NONE,             // any size, leaves may be empty (UnderflowPolicy::DEFERRED before compact())
+    OFF_RIGHT_EDGE,   // half full, but for the right edge that appends fill (see insertion.hpp)
+    LEAVES_ALL_HALF,  // as OFF_RIGHT_EDGE, and the rightmost leaf half full as well
+};
+
+/*
+	The tree holds exactly the (key, value) pairs of ref, a sorted map, and has a B+ tree's shape:
+	every leaf at the same depth, the leaf chain linking all of them in order, node sizes within
+	the limits, and find() reaching every key.
+*/
+template <typename Tree, typename Map>
+void checkTree(Tree& tree, const Map& ref, Minimum minimum = Minimum::OFF_RIGHT_EDGE) {
+    using Node = typename Tree::Node;
+    const int maxLeaf = tree.getMaxLeafNodeLimit();
+    const int maxInternal = tree.getMaxIntChildLimit();
+    const Node* firstLeaf = NULL;
+    const Node* lastLeaf = NULL;
+    std::size_t leaves = 0;
+    int leafDepth = -1;
+
+    std::function<void(const Node*, int, bool)> walk = [&](const Node* node, int depth, bool rightEdge) {
+        const bool isRoot = depth == 0;
+        if (node->isLeaf) {
+            CHECK(node->size <= maxLeaf);
+            if (!isRoot && minimum != Minimum::NONE && (!rightEdge || minimum == Minimum::LEAVES_ALL_HALF))
+                CHECK(node->size >= (maxLeaf + 1) / 2);
+            if (leafDepth < 0) leafDepth = depth;
+            CHECK(leafDepth == depth);
+            if (lastLeaf != NULL) CHECK(lastLeaf->next() == node);
+            if (firstLeaf == NULL) firstLeaf = node;
+            lastLeaf = node;
+            leaves++;
+            return;
+        }
+        CHECK(node->size >= 1 && node->size <= maxInternal - 1);
+        if (!isRoot && !rightEdge && minimum != Minimum::NONE) CHECK(node->size >= (maxInternal + 1) / 2 - 1);
+        for (int c = 0; c <= node->size; c++) walk(node->child(c), depth + 1, rightEdge && c == node->size);
+    };
+    if (tree.getRoot() != NULL) walk(tree.getRoot(), 0, true);
+    if (lastLeaf != NULL) CHECK(lastLeaf->next() == NULL);
+    CHECK((tree.getRoot() == NULL) == (leaves == 0));
+
+    auto expected = ref.begin();
+    for (auto it = tree.begin(); it != tree.end(); ++it, ++expected) {
+        CHECK(expected != ref.end());
+        CHECK(it.key() == expected->first);
+        CHECK(it.value() == expected->second);
+    }
+    CHECK(expected == ref.end());
+    for (const auto& entry : ref) {
+        const auto* value = tree.find(entry.first);
+        CHECK(value != NULL && *value == entry.second);
+    }
+}
+
+/*
+	find and contains agree with ref, a std::map, for every key in [0, range): the value of a key
+	ref holds, nothing for the others. find may return a pointer or a std::optional.
+*/
+template <typename Tree, typename Map>
+void checkFinds(Tree& tree, const Map& ref, typename Map::key_type range) {
+    for (typename Map::key_type key = 0; key < range; key++) {
+        const auto value = tree.find(key);
+        auto it = ref.find(key);
+        const bool present = it != ref.end();
+        CHECK(static_cast<bool>(value) == present && tree.contains(key) == present);
+        if (value) CHECK(*value == it->second);
+    }
+}
+
+/*
+	scan(lo, hi, visit) visits the pairs of ref in [lo, hi) in order: once over everything, then
+	scans - 1 times from a random lo in [0, range) over up to width keys.
+*/
+template <typename Tree, typename Map>
+void checkScans(Tree& tree, const Map& ref, typename Map::key_type range,
+                typename Map::key_type width, int scans, std::mt19937_64& rng) {
+    using Key = typename Map::key_type;
+    using Value = typename Map::mapped_type;
+    for (int i = 0; i < scans; i++) {
+        const Key lo = i == 0 ? std::numeric_limits<Key>::lowest()
+                              : static_cast<Key>(rng() % range);
+        const Key hi = i == 0 ? range : lo + static_cast<Key>(rng() % width);
+        auto next = ref.lower_bound(lo);
+        tree.scan(lo, hi, [&](const Key& key, const Value& value) {
+            CHECK(next != ref.end() && key == next->first && value == next->second);
+            ++next;
+        });
+        CHECK(next == ref.lower_bound(hi));
+    }
+}
+
+/*
+	ops random inserts (two in three) and removeKeys of keys in [lo, hi), applied to tree and ref
+	alike. A tree whose insert returns bool replaces the value of a present key and has to report
+	it; the others keep duplicates, so they only get keys ref does not hold yet.
+*/
+template <typename Tree, typename Map>
+void randomOps(Tree& tree, Map& ref, typename Map::key_type lo, typename Map::key_type hi, int ops,
+               std::mt19937_64& rng) {
+    using Key = typename Map::key_type;
+    using Value = typename Map::mapped_type;
+    for (int i = 0; i < ops; i++) {
+        const Key key = lo + static_cast<Key>(rng() % static_cast<std::uint64_t>(hi - lo));
+        const Value value = static_cast<Value>(key) * 7 + i;
+        if (rng() % 3 < 2) {
+            if constexpr (std::is_same_v<decltype(tree.insert(key, value)), bool>) {
+                CHECK(tree.insert(key, value) == (ref.count(key) == 0));
+                ref[key] = value;
+            } else if (ref.count(key) == 0) {
+                tree.insert(key, value);
+                ref[key] = value;
+            }
+        } else {
+            CHECK(tree.removeKey(key) == (ref.erase(key) == 1));
+        }
+    }
+}
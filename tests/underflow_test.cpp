@@ -0,0 +1,78 @@
+// setUnderflowPolicy(DEFERRED) and compact(): deletes leave leaves underfull, compact() repairs all of them
+
+#include <cstdio>
+#include <map>
+#include <random>
+
+#include "bptree/basic_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+using bptree::UnderflowPolicy;
+using Tree = bptree::BasicBPTree<long, long>;
+
+namespace {
+
+void randomDeletes(int fanout, std::mt19937_64& rng) {
+    Tree tree(fanout, fanout);
+    tree.setUnderflowPolicy(UnderflowPolicy::DEFERRED);
+    std::map<long, long> ref;
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 3000; i++) {
+            const long key = static_cast<long>(rng() % 5000);
+            if (rng() % 5 < 2) {
+                if (ref.count(key) == 0) {
+                    tree.insert(key, i);
+                    ref[key] = i;
+                }
+            } else {
+                CHECK(tree.removeKey(key) == (ref.erase(key) > 0));
+            }
+        }
+        checkTree(tree, ref, Minimum::NONE);
+        if (round % 2 == 0) {
+            tree.compact(10);
+            checkTree(tree, ref, Minimum::NONE);
+        } else {
+            tree.compact();
+            CHECK(tree.pendingCompaction() == 0);
+            checkTree(tree, ref);
+        }
+    }
+    tree.setUnderflowPolicy(UnderflowPolicy::STRICT);
+    CHECK(tree.pendingCompaction() == 0);
+    checkTree(tree, ref);
+}
+
+void tailDeletes(int fanout) {
+    // Appends leave the rightmost leaf below half; deleting from it further still gets it repaired
+    Tree tree(fanout, fanout);
+    std::map<long, long> ref;
+    const long n = fanout * 20 + 2;  // two keys in the rightmost leaf
+    for (long key = 0; key < n; key++) {
+        tree.insert(key, key);
+        ref[key] = key;
+    }
+    tree.setUnderflowPolicy(UnderflowPolicy::DEFERRED);
+    for (long key = n - 1; key >= n - 2 - fanout / 2; key--) {
+        CHECK(tree.removeKey(key));
+        ref.erase(key);
+        CHECK(tree.pendingCompaction() >= 1);
+    }
+    checkTree(tree, ref, Minimum::NONE);
+    tree.compact();
+    CHECK(tree.pendingCompaction() == 0);
+    checkTree(tree, ref, Minimum::LEAVES_ALL_HALF);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(22);
+    for (int fanout : {3, 4, 7, 16, 64}) {
+        randomDeletes(fanout, rng);
+        tailDeletes(fanout);
+    }
+    std::printf("underflow_test passed\n");
+    return 0;
+}
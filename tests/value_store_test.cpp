@@ -0,0 +1,158 @@
+// ValueStore: values across segment boundaries, views that outlive appends, erasing and reopening
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bptree/basic_bptree.hpp"
+#include "bptree/value_store.hpp"
+#include "check.hpp"
+
+using bptree::ValueRef;
+using bptree::ValueStore;
+
+namespace {
+
+const std::size_t SEGMENT = std::size_t{64} << 10;  // the smallest allowed, so a few MB roll over often
+
+std::string randomValue(std::size_t length, std::mt19937_64& rng) {
+    std::string value(length, ' ');
+    for (char& c : value) c = static_cast<char>(rng());
+    return value;
+}
+
+template <typename Call>
+bool throws(Call&& call) {
+    try {
+        call();
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+void segments(std::mt19937_64& rng) {
+    // Values of every size up to the largest fill many segments; views taken early still read right
+    const std::string path = "value_store_test.dat";
+    std::remove(path.c_str());
+
+    std::vector<std::pair<ValueRef, std::string>> values;
+    std::vector<std::string_view> views;
+    {
+        ValueStore store(path, SEGMENT);
+        CHECK(store.getSegmentSize() == SEGMENT && store.getSegmentCount() == 1);
+        CHECK(store.size() == 0 && store.getDeadBytes() == 0);
+
+        const std::size_t largest = store.maxValueSize();
+        CHECK(throws([&] { store.append(std::string(largest + 1, 'x')); }));
+        values.emplace_back(store.append(std::string(largest, 'L')), std::string(largest, 'L'));  // a segment of its own
+        values.emplace_back(store.append(""), "");
+        while (store.getSegmentCount() < 40) {
+            std::size_t length = rng() % 8 == 0 ? rng() % (largest / 2) : rng() % 300;
+            std::string value = randomValue(length, rng);
+            values.emplace_back(store.append(value), value);
+        }
+        for (const auto& entry : values) views.push_back(*store.get(entry.first));
+        CHECK(store.size() == values.size());
+        CHECK(store.getDataBytes() <= store.getSegmentCount() * SEGMENT);
+        CHECK(store.getDeadBytes() > 0);  // segment tails left behind by values that did not fit
+
+        for (std::size_t i = 0; i < values.size(); i++) {
+            const ValueRef ref = values[i].first;
+            CHECK(ref.offset % 8 == 0);
+            // No value straddles two segments
+            CHECK(ref.offset / SEGMENT == (ref.offset + 8 + values[i].second.size() - 1) / SEGMENT);
+            CHECK(views[i] == values[i].second);
+        }
+
+        // Erasing flags the value; the old view still reads, the bytes are dead
+        const std::uint64_t deadBefore = store.getDeadBytes();
+        for (std::size_t i = 0; i < values.size(); i += 3) CHECK(store.erase(values[i].first));
+        CHECK(!store.erase(values[0].first));
+        CHECK(views[0] == values[0].second);
+        CHECK(store.getDeadBytes() > deadBefore);
+        for (std::size_t i = 0; i < values.size(); i++) {
+            std::optional<std::string_view> got = store.get(values[i].first);
+            CHECK(got.has_value() == (i % 3 != 0));
+            if (got) CHECK(*got == values[i].second);
+        }
+
+        // Refs that do not point at a record
+        CHECK(!store.get(ValueRef{0}).has_value());
+        CHECK(!store.get(ValueRef{values[1].first.offset + 3}).has_value());
+        CHECK(!store.get(ValueRef{store.getDataBytes()}).has_value());
+        CHECK(!store.erase(ValueRef{store.getDataBytes() + 8}));
+        store.sync();
+    }
+
+    // Reopened: same values, same counters, the segment size from the file, and appends carry on
+    ValueStore store(path);
+    CHECK(store.getSegmentSize() == SEGMENT && store.getSegmentCount() == 40);
+    CHECK(store.size() == values.size() - (values.size() + 2) / 3);
+    for (std::size_t i = 0; i < values.size(); i++) {
+        std::optional<std::string_view> got = store.get(values[i].first);
+        CHECK(got.has_value() == (i % 3 != 0));
+        if (got) CHECK(*got == values[i].second);
+    }
+    const std::uint64_t end = store.getDataBytes();
+    ValueRef more = store.append("after reopen");
+    CHECK(more.offset >= end && *store.get(more) == "after reopen");
+    std::remove(path.c_str());
+}
+
+void badFiles() {
+    const std::string path = "value_store_test_bad.dat";
+    std::remove(path.c_str());
+    CHECK(throws([&] { ValueStore store(path, SEGMENT / 2); }));      // below 64 KiB
+    std::remove(path.c_str());
+    CHECK(throws([&] { ValueStore store(path, SEGMENT + 4096); }));  // not a power of two
+    std::remove(path.c_str());
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << std::string(SEGMENT, 'z');
+    }
+    CHECK(throws([&] { ValueStore store(path); }));  // not a value store
+    std::remove(path.c_str());
+}
+
+void treeOfRefs(std::mt19937_64& rng) {
+    // The intended use: a tree indexes 8 byte refs, the values stay in the store
+    const std::string path = "value_store_test_tree.dat";
+    std::remove(path.c_str());
+    ValueStore store(path, SEGMENT);
+    bptree::BasicBPTree<int, ValueRef> tree(16, 16);
+    std::map<int, std::string> ref;
+    for (int i = 0; i < 5000; i++) {
+        int key = static_cast<int>(rng() % 2000);
+        std::string value = randomValue(rng() % 100, rng);
+        if (ValueRef* old = tree.find(key)) {
+            CHECK(store.erase(*old));
+            *old = store.append(value);
+        } else {
+            tree.insert(key, store.append(value));
+        }
+        ref[key] = value;
+    }
+    CHECK(store.size() == ref.size());
+    for (const auto& entry : ref) CHECK(*store.get(*tree.find(entry.first)) == entry.second);
+    std::remove(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(17);
+    segments(rng);
+    badFiles();
+    treeOfRefs(rng);
+    std::puts("value_store_test passed");
+    return 0;
+}
@@ -0,0 +1,139 @@
+// VersionedBPTree: a snapshot keeps reading the version it was taken at while writers carry on
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bptree/versioned_bptree.hpp"
+#include "check.hpp"
+#include "tree_check.hpp"
+
+using Tree = bptree::VersionedBPTree<long, long>;
+
+namespace {
+
+// snapshot holds exactly ref: find, contains, size and scans of a few ranges
+void checkSnapshot(const Tree::Snapshot& snapshot, const std::map<long, long>& ref, long range, std::mt19937_64& rng) {
+    CHECK(snapshot.size() == ref.size());
+    checkFinds(snapshot, ref, range);
+    checkScans(snapshot, ref, range, 500, 5, rng);
+}
+
+void heldSnapshots(int fanout, std::mt19937_64& rng) {
+    // Up to 8 snapshots at once, each checked against the copy of the model taken with it
+    Tree tree(fanout, fanout);
+    std::map<long, long> ref;
+    std::vector<std::pair<Tree::Snapshot, std::map<long, long>>> held;
+    const long range = 3000;
+    std::uint64_t lastVersion = 0;
+
+    for (int round = 0; round < 40; round++) {
+        Tree::Snapshot snapshot = tree.snapshot();
+        CHECK(snapshot.getVersion() > lastVersion);
+        lastVersion = snapshot.getVersion();
+        if (held.size() == 8) held.erase(held.begin() + static_cast<long>(rng() % held.size()));
+        held.emplace_back(std::move(snapshot), ref);
+
+        randomOps(tree, ref, 0, range, 500, rng);
+        CHECK(tree.size() == ref.size());
+        if (round % 4 == 3) {
+            for (const auto& entry : held) checkSnapshot(entry.first, entry.second, range, rng);
+            CHECK(tree.getStats().openSnapshots == held.size());
+        }
+    }
+
+    // Moved-from snapshots are released, and with none open every retired node can go
+    Tree::Snapshot moved = std::move(held.front().first);
+    checkSnapshot(moved, held.front().second, range, rng);
+    held.clear();
+    CHECK(tree.getStats().openSnapshots == 1);
+    moved = tree.snapshot();
+    CHECK(tree.getStats().openSnapshots == 1);
+    checkSnapshot(moved, ref, range, rng);
+    { Tree::Snapshot gone = std::move(moved); }
+    CHECK(tree.getStats().openSnapshots == 0);
+    tree.collect();
+    const bptree::VersionedStats stats = tree.getStats();
+    CHECK(stats.retiredBacklog == 0 && stats.freedNodes == stats.retiredNodes);
+}
+
+void oldSnapshotKeepsOnlyItsNodes(std::mt19937_64& rng) {
+    // One snapshot held through many writes pins its own tree, not every version written since
+    Tree tree(8, 8);
+    std::map<long, long> ref;
+    const long range = 4000;
+    for (long key = 0; key < range; key += 2) {
+        tree.insert(key, key);
+        ref[key] = key;
+    }
+    Tree::Snapshot old = tree.snapshot();
+    const std::map<long, long> oldRef = ref;
+    for (int step = 0; step < 50000; step++) {
+        const long key = static_cast<long>(rng() % range);
+        if (rng() % 2 == 0)
+            tree.insert(key, -key);
+        else
+            tree.removeKey(key);
+    }
+    tree.collect();
+    // Leaves of fanout 8 hold at least 4 keys, so the old tree has fewer than size/4 * 2 nodes
+    CHECK(tree.getStats().retiredBacklog <= old.size() / 2 + 64);
+    checkSnapshot(old, oldRef, range, rng);
+}
+
+void concurrentReaders(std::mt19937_64& rng) {
+    // A writer keeps going while readers scan their snapshots twice: both scans must be the same
+    Tree tree(6, 6);
+    const long range = 5000;
+    std::atomic<bool> done{false};
+    std::thread writer([&tree, &done, seed = rng()] {
+        std::mt19937_64 wrng(seed);
+        for (int step = 0; step < 60000; step++) {
+            const long key = static_cast<long>(wrng() % range);
+            if (wrng() % 3 < 2)
+                tree.insert(key, key * 10 + step % 10);
+            else
+                tree.removeKey(key);
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&tree, &done, range] {
+            do {
+                Tree::Snapshot snapshot = tree.snapshot();
+                std::vector<std::pair<long, long>> first, second;
+                snapshot.scan(0, range, [&](const long& key, const long& value) { first.push_back({key, value}); });
+                std::this_thread::yield();
+                snapshot.scan(0, range, [&](const long& key, const long& value) { second.push_back({key, value}); });
+                CHECK(first == second);
+                CHECK(first.size() == snapshot.size());
+                for (std::size_t i = 0; i < first.size(); i++) {
+                    CHECK(i == 0 || first[i - 1].first < first[i].first);
+                    CHECK(first[i].second / 10 == first[i].first);
+                    CHECK(*snapshot.find(first[i].first) == first[i].second);
+                }
+            } while (!done);
+        });
+    }
+    writer.join();
+    for (std::thread& reader : readers) reader.join();
+    CHECK(tree.getStats().openSnapshots == 0);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(19);
+    for (int fanout : {3, 4, 7, 32}) heldSnapshots(fanout, rng);
+    oldSnapshotKeepsOnlyItsNodes(rng);
+    concurrentReaders(rng);
+    std::printf("versioned_test passed\n");
+    return 0;
+}
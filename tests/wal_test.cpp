@@ -0,0 +1,208 @@
+// WriteAheadLog: group commits from many threads, replay in LSN order, torn tails cut away on open
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bptree/bptree.hpp"
+#include "bptree/wal.hpp"
+#include "check.hpp"
+
+using bptree::WriteAheadLog;
+
+namespace {
+
+const std::size_t MAGIC = 8, RECORD_HEADER = 17;
+
+using Records = std::vector<std::pair<std::uint8_t, std::string>>;  // index i holds LSN i + 1
+
+Records replayAll(WriteAheadLog& log) {
+    Records seen;
+    log.replay([&seen](std::uint64_t lsn, std::uint8_t type, std::string_view payload) {
+        CHECK(lsn == seen.size() + 1);
+        seen.emplace_back(type, std::string(payload));
+    });
+    return seen;
+}
+
+std::uintmax_t recordEnd(const Records& records, std::size_t count) {
+    std::uintmax_t end = MAGIC;
+    for (std::size_t i = 0; i < count; i++) end += RECORD_HEADER + records[i].second.size();
+    return end;
+}
+
+void groupCommit(std::mt19937_64& rng) {
+    // Every committed record comes back once, and the committers shared syncs rather than one each
+    const std::string path = "wal_test.wal";
+    const int THREADS = 8, PER_THREAD = 200;
+    std::remove(path.c_str());
+
+    std::vector<std::vector<std::string>> payloads(THREADS);
+    for (auto& mine : payloads) {
+        for (int i = 0; i < PER_THREAD; i++) mine.push_back(std::string(rng() % 64, char('a' + rng() % 26)));
+    }
+    {
+        WriteAheadLog log(path);
+        CHECK(log.getDurableLsn() == 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([&log, &payloads, t] {
+                for (const std::string& payload : payloads[t]) {
+                    std::uint64_t lsn = log.commit(static_cast<std::uint8_t>(t), payload);
+                    CHECK(log.getDurableLsn() >= lsn);
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+
+        bptree::LogStats stats = log.getStats();
+        CHECK(stats.records == std::uint64_t(THREADS) * PER_THREAD);
+        CHECK(stats.syncs >= 1 && stats.syncs <= stats.records);
+        CHECK(log.getDurableLsn() == stats.records);
+    }
+
+    WriteAheadLog log(path);
+    Records seen = replayAll(log);
+    CHECK(seen.size() == std::size_t(THREADS) * PER_THREAD);
+    CHECK(log.getStats().replayed == seen.size());
+    std::vector<std::size_t> next(THREADS, 0);
+    for (const auto& record : seen) {
+        // Each thread's records keep their order, whatever the interleaving
+        CHECK(record.first < THREADS);
+        CHECK(record.second == payloads[record.first][next[record.first]++]);
+    }
+    for (int t = 0; t < THREADS; t++) CHECK(next[t] == std::size_t(PER_THREAD));
+
+    // New records continue the sequence
+    CHECK(log.commit(9, "after reopen") == seen.size() + 1);
+    std::remove(path.c_str());
+}
+
+void tornTail(std::mt19937_64& rng) {
+    // A record cut short or corrupted ends the log there: the file is truncated and LSNs resume
+    const std::string path = "wal_test_torn.wal";
+    std::remove(path.c_str());
+
+    Records written;
+    {
+        WriteAheadLog log(path);
+        for (int i = 0; i < 100; i++) {
+            written.emplace_back(static_cast<std::uint8_t>(i % 3), std::string(1 + rng() % 40, char('A' + i % 26)));
+            log.append(written.back().first, written.back().second);
+        }
+        log.waitDurable(written.size());
+    }
+    CHECK(std::filesystem::file_size(path) == recordEnd(written, written.size()));
+
+    // Half of the last record is missing, as after a crash during its write
+    std::filesystem::resize_file(path, recordEnd(written, 99) + RECORD_HEADER / 2);
+    {
+        WriteAheadLog log(path);
+        Records seen = replayAll(log);
+        CHECK(seen.size() == 99);
+        for (std::size_t i = 0; i < seen.size(); i++) CHECK(seen[i] == written[i]);
+        CHECK(std::filesystem::file_size(path) == recordEnd(written, 99));
+
+        written.resize(99);
+        written.emplace_back(7, "replacement");
+        CHECK(log.commit(7, "replacement") == 100);
+    }
+
+    // A flipped payload byte in record 60 fails its checksum: it and everything after it go
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(recordEnd(written, 59) + RECORD_HEADER));
+        char byte = written[59].second[0] ^ 0x20;
+        file.write(&byte, 1);
+    }
+    {
+        WriteAheadLog log(path);
+        Records seen = replayAll(log);
+        CHECK(seen.size() == 59);
+        for (std::size_t i = 0; i < seen.size(); i++) CHECK(seen[i] == written[i]);
+        CHECK(std::filesystem::file_size(path) == recordEnd(written, 59));
+        CHECK(log.getDurableLsn() == 59);
+        CHECK(log.commit(1, "") == 60);
+    }
+
+    // Not a log at all
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "definitely not a write-ahead log";
+    }
+    bool threw = false;
+    try {
+        WriteAheadLog log(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    std::remove(path.c_str());
+}
+
+void treeRecovery(std::mt19937_64& rng) {
+    // BPTree replays its log into a fresh heap file: the table after recovery is the one before
+    const std::string tuples = "wal_test_tuples.db", logFile = "wal_test_tuples.wal";
+    std::remove(tuples.c_str());
+    std::remove(logFile.c_str());
+
+    std::ostringstream quiet;  // the demo tree narrates every step on cout
+    std::streambuf* out = std::cout.rdbuf(quiet.rdbuf());
+
+    std::map<int, std::string> ref;
+    {
+        bptree::BPTree tree(4, 4, tuples, logFile);
+        for (int i = 0; i < 2000; i++) {
+            int key = static_cast<int>(rng() % 500);
+            if (rng() % 4 == 0) {
+                tree.removeKey(key);
+                ref.erase(key);
+            } else {
+                std::string tuple = "tuple " + std::to_string(key) + "/" + std::to_string(i);
+                tree.insertTuple(key, tuple);
+                ref[key] = tuple;
+            }
+        }
+    }
+
+    std::remove(tuples.c_str());  // recovery must not need the old heap file
+    bptree::BPTree tree(4, 4, tuples, logFile);
+    std::cout.rdbuf(out);
+
+    CHECK(tree.getLog() != NULL);
+    CHECK(tree.getTuples().size() == ref.size());
+    for (int key = 0; key < 500; key++) {
+        bptree::RecordId* rid = tree.find(key);
+        auto it = ref.find(key);
+        CHECK((rid != NULL) == (it != ref.end()));
+        if (rid != NULL) {
+            std::optional<std::string> tuple = tree.getTuples().read(*rid);
+            CHECK(tuple.has_value() && *tuple == it->second);
+        }
+    }
+    std::remove(tuples.c_str());
+    std::remove(logFile.c_str());
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937_64 rng(11);
+    groupCommit(rng);
+    tornTail(rng);
+    treeRecovery(rng);
+    std::puts("wal_test passed");
+    return 0;
+}